@@ -19,17 +19,36 @@
 //-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
 
 #include "Bridge.h"
+#ifndef _WIN32
+#include "ControlChannel.h"
+#endif
 #include "Log.h"
 #include "Plugin.h"
+#include "Resource.h"
+#include "SeenStates.h"
+#include "Trace.h"
 #include "ocstack.h"
 #include "rd_client.h"
 #include "rd_server.h"
 #include <alljoyn/Init.h>
+#include <chrono>
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 #include <inttypes.h>
+#include <map>
+#include <mutex>
 #include <signal.h>
 #include <sstream>
 #include <stdlib.h>
+#include <string.h>
 #include <thread>
+#include <time.h>
+#include <vector>
+
+#define SEEN_STATES_FILE_NAME "seen.dat"
 
 static volatile sig_atomic_t sQuitFlag = false;
 static volatile sig_atomic_t sResetSecurityFlag = false;
@@ -37,6 +56,24 @@ static const char *gPSPrefix = "AllJoynBridge_";
 static const char *sUUID = NULL;
 static const char *sSender = NULL;
 static const char *sRD = NULL;
+static size_t sEntityHandlerThreads = 0;
+static bool sPersistModels = false;
+static bool sPersistDevices = false;
+static bool sLazyLanguages = false;
+static size_t sPoolSize = 0;
+static bool sStandby = false;
+static int8_t sLogLevel = LOG_INFO;
+static bool sSyncLog = false;
+static const char *sTracePrefix = NULL;
+static unsigned sTraceSampleOneIn = 100;
+static SeenStates *sSeenStates = NULL;
+#ifndef _WIN32
+static ControlChannel *sControl = NULL;
+static const time_t HEALTH_PERIOD_SECS = 5;
+/* The uuids of the EXEC messages not acknowledged yet, by sequence number */
+static std::mutex sPendingExecsMutex;
+static std::map<uint32_t, std::string> sPendingExecs;
+#endif
 #if __WITH_DTLS__
 static bool sSecureMode = true;
 #else
@@ -111,6 +148,7 @@ private:
                 fprintf(stderr, "OCProcess - %d\n", result);
                 break;
             }
+            Bridge::ProcessResponses();
 #ifdef _WIN32
             Sleep(1);
 #else
@@ -209,39 +247,334 @@ static OCStackApplicationResult DiscoverResourceDirectoryCB(void *ctx, OCDoHandl
     }
 }
 
+#ifndef _WIN32
+/* The logging and tracing arguments passed on to the bridge processes of the devices */
+static void AppendLogArgs(std::vector<std::string> &args)
+{
+    if (sLogLevel != LOG_INFO)
+    {
+        args.push_back("--log-level");
+        args.push_back("err");
+    }
+    if (sSyncLog)
+    {
+        args.push_back("--sync-log");
+    }
+    if (sTracePrefix)
+    {
+        args.push_back("--trace");
+        args.push_back(sTracePrefix);
+        args.push_back("--trace-sample");
+        args.push_back(std::to_string(sTraceSampleOneIn));
+    }
+}
+#endif
+
 static void ExecCB(const char *uuid, const char *sender, bool secureMode, bool isVirtual)
 {
-    printf("exec --ps %s --uuid %s --sender %s --rd %s --secureMode %s %s\n", gPSPrefix, uuid,
-            sender, OCGetServerInstanceIDString(), secureMode ? "true" : "false",
-            isVirtual ? "--virtual" : "");
+    sSeenStates->Set(uuid, isVirtual ? Bridge::SEEN_VIRTUAL : Bridge::SEEN_NATIVE);
+#ifndef _WIN32
+    if (sControl)
+    {
+        std::vector<std::string> args = { "--ps", gPSPrefix, "--uuid", uuid, "--sender", sender,
+                "--rd", OCGetServerInstanceIDString(), "--secureMode",
+                secureMode ? "true" : "false", "--threads", std::to_string(sEntityHandlerThreads) };
+        if (isVirtual)
+        {
+            args.push_back("--virtual");
+        }
+        if (sLazyLanguages)
+        {
+            args.push_back("--lazy-languages");
+        }
+        AppendLogArgs(args);
+        std::lock_guard<std::mutex> lock(sPendingExecsMutex);
+        uint32_t seq = sControl->Send(ControlMessage::EXEC, args);
+        LOG(seq ? LOG_INFO : LOG_ERR, "seq=%u exec uuid=%s", seq, uuid);
+        if (seq)
+        {
+            sPendingExecs[seq] = uuid;
+        }
+        else
+        {
+            sSeenStates->Set(uuid, Bridge::NOT_SEEN);
+        }
+        return;
+    }
+#endif
+    printf("exec --ps %s --uuid %s --sender %s --rd %s --secureMode %s --threads %zu %s %s\n",
+            gPSPrefix, uuid, sender, OCGetServerInstanceIDString(), secureMode ? "true" : "false",
+            sEntityHandlerThreads, isVirtual ? "--virtual" : "",
+            sLazyLanguages ? "--lazy-languages" : "");
     fflush(stdout);
 }
 
 static void KillCB(const char *uuid)
 {
+#ifndef _WIN32
+    if (sControl)
+    {
+        uint32_t seq = sControl->Send(ControlMessage::KILL, { uuid });
+        LOG(seq ? LOG_INFO : LOG_ERR, "seq=%u kill uuid=%s", seq, uuid);
+        return;
+    }
+#endif
     printf("kill --uuid %s\n", uuid);
     fflush(stdout);
+    /* Nothing reports the exit of the process without a control channel */
+    sSeenStates->Set(uuid, Bridge::NOT_SEEN);
 }
 
 static Bridge::SeenState GetSeenStateCB(const char *uuid)
 {
-    std::string seenPath = GetFilename(uuid, "seen.state");
-    FILE *fp = fopen(seenPath.c_str(), "r");
-    if (!fp)
+    return sSeenStates->Get(uuid);
+}
+
+/* Saves the seen states at most once a second instead of on every change. */
+static void FlushSeenStates()
+{
+    static time_t flushTick = 0;
+    time_t now = time(NULL);
+    if (sSeenStates && (now != flushTick))
+    {
+        flushTick = now;
+        sSeenStates->Flush();
+    }
+}
+
+static bool IsAlive(int64_t pid)
+{
+#ifdef _WIN32
+    (void) pid;
+    return false;
+#else
+    return (kill(pid, 0) == 0) || (errno == EPERM);
+#endif
+}
+
+static void ParseArgs(int argc, char **argv, int *protocols, bool *isVirtual)
+{
+    for (int i = 0; i < argc; ++i)
+    {
+        if (!strcmp(argv[i], "--ps") && (i < (argc - 1)))
+        {
+            gPSPrefix = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--aj"))
+        {
+            *protocols |= Bridge::AJ;
+        }
+        else if (!strcmp(argv[i], "--oc"))
+        {
+            *protocols |= Bridge::OC;
+        }
+        else if (!strcmp(argv[i], "--uuid") && (i < (argc - 1)))
+        {
+            sUUID = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--sender") && (i < (argc - 1)))
+        {
+            sSender = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--rd") && (i < (argc - 1)))
+        {
+            sRD = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--threads") && (i < (argc - 1)))
+        {
+            sEntityHandlerThreads = strtoul(argv[++i], NULL, 10);
+        }
+        else if (!strcmp(argv[i], "--persist-models"))
+        {
+            sPersistModels = true;
+        }
+        else if (!strcmp(argv[i], "--persist-devices"))
+        {
+            sPersistDevices = true;
+        }
+        else if (!strcmp(argv[i], "--lazy-languages"))
+        {
+            sLazyLanguages = true;
+        }
+        else if (!strcmp(argv[i], "--pool") && (i < (argc - 1)))
+        {
+            sPoolSize = strtoul(argv[++i], NULL, 10);
+        }
+        else if (!strcmp(argv[i], "--standby"))
+        {
+            sStandby = true;
+        }
+        else if (!strcmp(argv[i], "--log-level") && (i < (argc - 1)))
+        {
+            sLogLevel = !strcmp(argv[++i], "err") ? LOG_ERR : LOG_INFO;
+        }
+        else if (!strcmp(argv[i], "--sync-log"))
+        {
+            sSyncLog = true;
+        }
+        else if (!strcmp(argv[i], "--trace") && (i < (argc - 1)))
+        {
+            sTracePrefix = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--trace-sample") && (i < (argc - 1)))
+        {
+            sTraceSampleOneIn = strtoul(argv[++i], NULL, 10);
+        }
+#ifndef _WIN32
+        else if (!strcmp(argv[i], "--control") && (i < (argc - 1)))
+        {
+            int fd = atoi(argv[++i]);
+            /* The control channel is not inherited by the processes started by the manager */
+            fcntl(fd, F_SETFD, FD_CLOEXEC);
+            sControl = new ControlChannel(fd);
+        }
+#endif
+        else if (!strcmp(argv[i], "--virtual"))
+        {
+            *isVirtual = true;
+        }
+        else if (!strcmp(argv[i], "--secureMode") && (i < (argc - 1)))
+        {
+            char *mode = argv[++i];
+            if (!strcmp(mode, "false"))
+            {
+                sSecureMode = false;
+            }
+            else if (!strcmp(mode, "true"))
+            {
+                sSecureMode = true;
+            }
+        }
+    }
+}
+
+#ifndef _WIN32
+/*
+ * A standby child has started the AllJoyn router, and waits on its control channel for the
+ * PluginManager to assign it a device with the arguments of an EXEC message.  The channel is
+ * kept afterwards to send HEALTH messages.
+ */
+static bool WaitForAssignment(int *protocols, bool *isVirtual)
+{
+    static std::vector<std::string> assignment;
+    std::vector<ControlMessage> messages;
+    while (!sQuitFlag && sControl && messages.empty())
     {
-        return Bridge::NOT_SEEN;
+        if (!sControl->Receive(messages))
+        {
+            break;
+        }
     }
-    char stateStr[16];
-    fscanf(fp, "%s", stateStr);
-    fclose(fp);
-    if (!strcmp("virtual", stateStr))
+    if (messages.empty() || (messages[0].m_type != ControlMessage::EXEC))
     {
-        return Bridge::SEEN_VIRTUAL;
+        return false;
     }
-    else
+    assignment = messages[0].m_args;
+    std::vector<char *> args;
+    for (std::string &arg : assignment)
     {
-        return Bridge::SEEN_NATIVE;
+        args.push_back(&arg[0]);
     }
+    ParseArgs(args.size(), &args[0], protocols, isVirtual);
+    return sUUID && sSender;
+}
+#else
+static bool WaitForAssignment(int *protocols, bool *isVirtual)
+{
+    (void) protocols;
+    (void) isVirtual;
+    return false;
+}
+#endif
+
+#ifndef _WIN32
+/*
+ * Handles the acknowledgements from the PluginManager and tells it that this process is
+ * still alive.  Returns false once the PluginManager has gone.
+ */
+static bool ProcessControl()
+{
+    static time_t healthTick = 0;
+    if (!sControl)
+    {
+        return true;
+    }
+    std::vector<ControlMessage> messages;
+    if (!sControl->Receive(messages))
+    {
+        LOG(LOG_ERR, "Control channel closed");
+        return false;
+    }
+    for (ControlMessage &msg : messages)
+    {
+        if ((msg.m_type == ControlMessage::SEEN_STATE) && (msg.m_args.size() == 3) &&
+                sSeenStates)
+        {
+            const std::string &uuid = msg.m_args[0];
+            int64_t pid = strtoll(msg.m_args[2].c_str(), NULL, 10);
+            if (msg.m_args[1] == "none")
+            {
+                sSeenStates->Exited(uuid, pid);
+            }
+            else
+            {
+                /* The PluginManager has restarted the bridge process of uuid */
+                sSeenStates->Set(uuid, (msg.m_args[1] == "virtual") ? Bridge::SEEN_VIRTUAL :
+                        Bridge::SEEN_NATIVE);
+                sSeenStates->SetPid(uuid, pid);
+            }
+            sControl->Ack(msg.m_seq, true);
+            continue;
+        }
+        if (msg.m_type != ControlMessage::ACK)
+        {
+            sControl->Ack(msg.m_seq, false);
+            continue;
+        }
+        bool success = !msg.m_args.empty() && (msg.m_args[0] == ControlChannel::ACK_OK);
+        std::string uuid;
+        {
+            std::lock_guard<std::mutex> lock(sPendingExecsMutex);
+            std::map<uint32_t, std::string>::iterator it = sPendingExecs.find(msg.m_seq);
+            if (it != sPendingExecs.end())
+            {
+                uuid = it->second;
+                sPendingExecs.erase(it);
+            }
+        }
+        if (!uuid.empty() && success && (msg.m_args.size() > 1))
+        {
+            sSeenStates->SetPid(uuid, strtoll(msg.m_args[1].c_str(), NULL, 10));
+        }
+        else if (!uuid.empty())
+        {
+            sSeenStates->Set(uuid, Bridge::NOT_SEEN);
+        }
+        if (!success || (msg.m_args.size() > 1))
+        {
+            LOG(success ? LOG_INFO : LOG_ERR, "seq=%u %s %s", msg.m_seq,
+                    msg.m_args.empty() ? "" : msg.m_args[0].c_str(),
+                    (msg.m_args.size() > 1) ? msg.m_args[1].c_str() : "");
+        }
+    }
+    time_t now = time(NULL);
+    if (now >= healthTick)
+    {
+        healthTick = now + HEALTH_PERIOD_SECS;
+        if (!sControl->Send(ControlMessage::HEALTH, { "pid", std::to_string(getpid()),
+                "requests", std::to_string(GetRequestCount()) }))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+#endif
+
+static long long MillisecondsSince(std::chrono::steady_clock::time_point t)
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - t).count();
 }
 
 static void SessionLostCB()
@@ -258,66 +591,31 @@ int main(int argc, char **argv)
     std::string dbFilename;
     OCStackResult result;
     OCPersistentStorage ps = { PSOpenCB, fread, fwrite, fclose, unlink };
+    /* When the process started, or when a standby child was assigned a device */
+    std::chrono::steady_clock::time_point assigned = std::chrono::steady_clock::now();
 
     int protocols = 0;
     bool isVirtual = false;
-    if (argc > 1)
-    {
-        for (int i = 1; i < argc; ++i)
-        {
-            if (!strcmp(argv[i], "--ps") && (i < (argc - 1)))
-            {
-                gPSPrefix = argv[++i];
-            }
-            else if (!strcmp(argv[i], "--aj"))
-            {
-                protocols |= Bridge::AJ;
-            }
-            else if (!strcmp(argv[i], "--oc"))
-            {
-                protocols |= Bridge::OC;
-            }
-            else if (!strcmp(argv[i], "--uuid") && (i < (argc - 1)))
-            {
-                sUUID = argv[++i];
-            }
-            else if (!strcmp(argv[i], "--sender") && (i < (argc - 1)))
-            {
-                sSender = argv[++i];
-            }
-            else if (!strcmp(argv[i], "--rd") && (i < (argc - 1)))
-            {
-                sRD = argv[++i];
-            }
-            else if (!strcmp(argv[i], "--virtual"))
-            {
-                isVirtual = true;
-            }
-            else if (!strcmp(argv[i], "--secureMode") && (i < (argc - 1)))
-            {
-                char *mode = argv[++i];
-                if (!strcmp(mode, "false"))
-                {
-                    sSecureMode = false;
-                }
-                else if (!strcmp(mode, "true"))
-                {
-                    sSecureMode = true;
-                }
-            }
-        }
-    }
+    ParseArgs(argc - 1, argv + 1, &protocols, &isVirtual);
     /* uuid, sender, and rd must be supplied together and when they are, aj and oc are ignored */
     if (protocols == 0)
     {
         protocols = Bridge::AJ | Bridge::OC;
     }
-    std::string seenPath = GetFilename(sUUID, "seen.state");
-    if (sSender)
+    LogSetLevel(sLogLevel);
+    if (!sSyncLog)
     {
-        FILE *fp = fopen(seenPath.c_str(), "w");
-        fprintf(fp, "%s", isVirtual ? "virtual" : "native");
-        fclose(fp);
+        LogStartAsync();
+    }
+    if (sTracePrefix && sTraceSampleOneIn)
+    {
+        /* Each bridge process writes its own file */
+#ifdef _WIN32
+        std::string path = std::string(sTracePrefix) + ".json";
+#else
+        std::string path = std::string(sTracePrefix) + "-" + std::to_string(getpid()) + ".json";
+#endif
+        Trace::Start(path.c_str(), sTraceSampleOneIn);
     }
 
     signal(SIGINT, SigIntCB);
@@ -337,6 +635,21 @@ int main(int argc, char **argv)
         fprintf(stderr, "AllJoynRouterInit - %s\n", QCC_StatusText(status));
         goto exit;
     }
+    if (sStandby)
+    {
+        /*
+         * The OC stack's identity and security state come from the persistent storage of the
+         * assigned device, so only the AllJoyn side is started ahead of the assignment and the
+         * OC stack is initialized once, afterwards.
+         */
+        LOG(LOG_INFO, "Standby rd=%s", sRD ? sRD : "");
+        if (sQuitFlag || !WaitForAssignment(&protocols, &isVirtual))
+        {
+            goto exit;
+        }
+        assigned = std::chrono::steady_clock::now();
+        sStandby = false;
+    }
 
     result = OCRegisterPersistentStorageHandler(&ps);
     if (result != OC_STACK_OK)
@@ -359,6 +672,8 @@ int main(int argc, char **argv)
     }
     if (sSender)
     {
+        LOG(LOG_INFO, "uuid=%s stack initialized %lld ms after assignment", sUUID,
+                MillisecondsSince(assigned));
         result = OCStopMulticastServer();
         if (result != OC_STACK_OK)
         {
@@ -386,6 +701,8 @@ int main(int argc, char **argv)
                 goto exit;
             }
         }
+        LOG(LOG_INFO, "uuid=%s found rd %lld ms after assignment", sUUID,
+                MillisecondsSince(assigned));
     }
     else
     {
@@ -395,8 +712,21 @@ int main(int argc, char **argv)
             fprintf(stderr, "OCRDStart() - %d\n", result);
             goto exit;
         }
+#ifndef _WIN32
+        if (sPoolSize && sControl)
+        {
+            std::vector<std::string> args = { std::to_string(sPoolSize), "--ps", gPSPrefix,
+                    "--rd", OCGetServerInstanceIDString(), "--threads",
+                    std::to_string(sEntityHandlerThreads) };
+            if (sLazyLanguages)
+            {
+                args.push_back("--lazy-languages");
+            }
+            AppendLogArgs(args);
+            sControl->Send(ControlMessage::POOL, args);
+        }
+#endif
     }
-
     if (sUUID && sSender)
     {
         bridge = new Bridge(gPSPrefix, sSender);
@@ -405,20 +735,37 @@ int main(int argc, char **argv)
     else
     {
         bridge = new Bridge(gPSPrefix, (Bridge::Protocol) protocols);
+        sSeenStates = new SeenStates(SEEN_STATES_FILE_NAME);
+        sSeenStates->Load(IsAlive);
         bridge->SetProcessCB(ExecCB, KillCB, GetSeenStateCB);
+        bridge->SetModelCachePersistent(sPersistModels);
+        bridge->SetDeviceSnapshotsPersistent(sPersistDevices);
     }
     bridge->SetDeviceName("AllJoyn Bridge");
     bridge->SetManufacturerName("IoTivity");
     bridge->SetSecureMode(sSecureMode);
+    bridge->SetEntityHandlerThreads(sEntityHandlerThreads);
+    bridge->SetAboutLanguagesLazy(sLazyLanguages);
     if (!bridge->Start())
     {
         goto exit;
     }
+    if (sSender)
+    {
+        LOG(LOG_INFO, "uuid=%s started %lld ms after assignment", sUUID,
+                MillisecondsSince(assigned));
+    }
     oc = new OC();
     if (!oc->Start())
     {
         goto exit;
     }
+#ifndef _WIN32
+    if (sControl)
+    {
+        fcntl(sControl->GetFd(), F_SETFL, fcntl(sControl->GetFd(), F_GETFL) | O_NONBLOCK);
+    }
+#endif
     while (!sQuitFlag)
     {
         if (sResetSecurityFlag)
@@ -430,6 +777,13 @@ int main(int argc, char **argv)
         {
             goto exit;
         }
+#ifndef _WIN32
+        if (!ProcessControl())
+        {
+            goto exit;
+        }
+#endif
+        FlushSeenStates();
 #ifdef _WIN32
         Sleep(1);
 #else
@@ -447,13 +801,19 @@ exit:
     if (oc)
     {
         oc->Stop();
-        if (sSender)
-        {
-            remove(seenPath.c_str());
-        }
         delete oc;
     }
     AllJoynRouterShutdown();
     AllJoynShutdown();
+#ifndef _WIN32
+    delete sControl;
+#endif
+    if (sSeenStates)
+    {
+        sSeenStates->Flush();
+        delete sSeenStates;
+    }
+    Trace::Stop();
+    LogStopAsync();
     return ret;
 }
@@ -20,14 +20,241 @@
 
 #include "Log.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <stdarg.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <sys/types.h>
+#include <thread>
 #ifndef _WIN32
 #include <unistd.h>
 #endif
 
+#define LOG_LINE_SIZE   512
+#define LOG_RING_SIZE   1024 /* Must be a power of 2 */
+
+int8_t gLogLevel = LOG_INFO;
+
+static FILE *sOutput = NULL;
+static const char *sLevels[] = { NULL, NULL, NULL, "ERR ", NULL, NULL, "INFO" };
+
+/*
+ * A bounded multiple-producer, single-consumer ring.  A slot is free for the producer at
+ * position pos when its sequence number is pos, and full for the consumer at position pos when
+ * it is pos + 1.
+ */
+struct Slot
+{
+    std::atomic<size_t> m_seq;
+    size_t m_len;
+    /* m_buf, or an allocated buffer for the lines too long for it */
+    char *m_line;
+    char m_buf[LOG_LINE_SIZE];
+};
+static Slot *sRing = NULL;
+static std::atomic<size_t> sTail(0);
+static size_t sHead = 0;
+static std::atomic<size_t> sDropped(0);
+static std::atomic<bool> sRunning(false);
+/* The producers that may still enqueue, having seen sRunning set */
+static std::atomic<size_t> sProducers(0);
+/* Tells the writer to exit once the ring is drained */
+static std::atomic<bool> sStopWriter(false);
+static std::thread sWriter;
+static int sPid = 0;
+
+static int GetPid()
+{
+#ifdef _WIN32
+    return GetCurrentProcessId();
+#else
+    return getpid();
+#endif
+}
+
+static const char *GetBasename(const char *file)
+{
+    const char *basename = strrchr(file, '/');
+    return basename ? basename + 1 : file;
+}
+
+void LogSetLevel(int8_t severity)
+{
+    gLogLevel = severity;
+}
+
+void LogSetOutput(FILE *fp)
+{
+    sOutput = fp;
+}
+
+/*
+ * Formats a newline terminated line into buf, or into an allocated buffer that the caller must
+ * free() when the line does not fit.  Returns the line and sets len to its length.
+ */
+static char *Format(char *buf, size_t size, size_t *len, int pid, const char *file,
+        const char *function, int32_t lineNumber, int8_t severity, const char *fmt, va_list ap)
+{
+    int n = snprintf(buf, size, "[%d] %s %s:%d::%s - ", pid, sLevels[severity],
+            GetBasename(file), lineNumber, function);
+    size_t prefixLen = (n < 0) ? 0 : std::min((size_t) n, size - 1);
+    va_list aq;
+    va_copy(aq, ap);
+    n = vsnprintf(buf + prefixLen, size - prefixLen, fmt, aq);
+    va_end(aq);
+    size_t bodyLen = (n < 0) ? 0 : n;
+    *len = prefixLen + bodyLen + 1;
+    if (*len < size)
+    {
+        buf[*len - 1] = '\n';
+        return buf;
+    }
+    char *line = (char *) malloc(*len + 1);
+    if (!line)
+    {
+        /* Truncate */
+        *len = size;
+        buf[*len - 1] = '\n';
+        return buf;
+    }
+    memcpy(line, buf, prefixLen);
+    vsnprintf(line + prefixLen, bodyLen + 1, fmt, ap);
+    line[*len - 1] = '\n';
+    return line;
+}
+
+/* Returns true if a line was written. */
+static bool WriteQueued(FILE *fp)
+{
+    Slot &slot = sRing[sHead & (LOG_RING_SIZE - 1)];
+    if (slot.m_seq.load(std::memory_order_acquire) != (sHead + 1))
+    {
+        return false;
+    }
+    fwrite(slot.m_line, 1, slot.m_len, fp);
+    if (slot.m_line != slot.m_buf)
+    {
+        free(slot.m_line);
+    }
+    slot.m_seq.store(sHead + LOG_RING_SIZE, std::memory_order_release);
+    ++sHead;
+    return true;
+}
+
+static void WriteDropped(FILE *fp)
+{
+    size_t dropped = sDropped.exchange(0);
+    if (dropped)
+    {
+        fprintf(fp, "[%d] %s %s:%d::%s - %zu lines dropped\n", sPid, sLevels[LOG_ERR],
+                GetBasename(__FILE__), __LINE__, __FUNCTION__, dropped);
+    }
+}
+
+static void Writer()
+{
+    FILE *fp = sOutput ? sOutput : stderr;
+    for (;;)
+    {
+        bool running = !sStopWriter;
+        size_t n = 0;
+        while (WriteQueued(fp))
+        {
+            ++n;
+        }
+        WriteDropped(fp);
+        if (n)
+        {
+            /* One flush per batch instead of per line */
+            fflush(fp);
+        }
+        else if (!running)
+        {
+            break;
+        }
+        else
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+    fflush(fp);
+}
+
+void LogStartAsync()
+{
+    if (sRunning)
+    {
+        return;
+    }
+    if (!sRing)
+    {
+        sRing = new Slot[LOG_RING_SIZE];
+    }
+    for (size_t pos = sHead; pos < (sHead + LOG_RING_SIZE); ++pos)
+    {
+        sRing[pos & (LOG_RING_SIZE - 1)].m_seq.store(pos, std::memory_order_relaxed);
+    }
+    sTail = sHead;
+    sPid = GetPid();
+    sRunning = true;
+    sWriter = std::thread(Writer);
+}
+
+void LogStopAsync()
+{
+    if (!sRunning)
+    {
+        return;
+    }
+    /*
+     * Producers that see sRunning cleared write synchronously.  Those that saw it set before
+     * finish enqueuing before the writer's final drain so that none of their lines are lost.
+     */
+    sRunning = false;
+    while (sProducers)
+    {
+        std::this_thread::yield();
+    }
+    sStopWriter = true;
+    sWriter.join();
+    sStopWriter = false;
+}
+
+/* Returns false if the ring is full. */
+static bool Enqueue(const char *file, const char *function, int32_t line, int8_t severity,
+        const char *fmt, va_list ap)
+{
+    size_t pos = sTail.load(std::memory_order_relaxed);
+    Slot *slot;
+    for (;;)
+    {
+        slot = &sRing[pos & (LOG_RING_SIZE - 1)];
+        size_t seq = slot->m_seq.load(std::memory_order_acquire);
+        if (seq == pos)
+        {
+            if (sTail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (seq < pos)
+        {
+            return false;
+        }
+        else
+        {
+            pos = sTail.load(std::memory_order_relaxed);
+        }
+    }
+    slot->m_line = Format(slot->m_buf, sizeof(slot->m_buf), &slot->m_len, sPid, file,
+            function, line, severity, fmt, ap);
+    slot->m_seq.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
 void LogWriteln(
     const char *file,
     const char *function,
@@ -37,30 +264,31 @@ void LogWriteln(
     ...
 )
 {
-    static FILE *fps[] = { NULL, NULL, NULL, stderr, NULL, NULL, stderr };
-    static const char *levels[] = { NULL, NULL, NULL, "ERR ", NULL, NULL, "INFO" };
-
-    const char *basename = strrchr(file, '/');
-    if (basename)
+    va_list ap;
+    va_start(ap, fmt);
+    ++sProducers;
+    if (sRunning)
     {
-        ++basename;
+        if (!Enqueue(file, function, line, severity, fmt, ap))
+        {
+            ++sDropped;
+        }
+        --sProducers;
     }
     else
     {
-        basename = file;
+        --sProducers;
+        char buf[LOG_LINE_SIZE];
+        size_t len;
+        char *str = Format(buf, sizeof(buf), &len, GetPid(), file, function, line, severity, fmt,
+                ap);
+        FILE *fp = sOutput ? sOutput : stderr;
+        fwrite(str, 1, len, fp);
+        fflush(fp);
+        if (str != buf)
+        {
+            free(str);
+        }
     }
-    va_list ap;
-    va_start(ap, fmt);
-#ifdef _WIN32
-    fprintf(fps[severity], "[%d] %s %s:%d::%s - ", GetCurrentProcessId(), levels[severity], basename,
-            line,
-            function);
-#else
-    fprintf(fps[severity], "[%d] %s %s:%d::%s - ", getpid(), levels[severity], basename, line,
-            function);
-#endif
-    vfprintf(fps[severity], fmt, ap);
-    fprintf(fps[severity], "\n");
-    fflush(fps[severity]);
     va_end(ap);
 }
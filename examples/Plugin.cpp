@@ -21,46 +21,186 @@
 #include "Plugin.h"
 
 #include "Log.h"
+#include "PublishedLinks.h"
+#include "Resource.h"
 #include "ocpayload.h"
 #include "ocrandom.h"
 #include "ocstack.h"
 #include "rd_client.h"
 #include <map>
+#include <mutex>
+#include <sstream>
 #include <string>
 
 std::string gRD;
 
+/* Links are published again well before their lifetime in the RD expires */
+static std::mutex sPublishedMutex;
+static PublishedLinks sPublished(OIC_RD_PUBLISH_TTL / 2);
+
 static OCStackApplicationResult RDPublishCB(void *ctx, OCDoHandle handle,
         OCClientResponse *response)
 {
     (void) ctx;
     (void) handle;
-    int severity = (response && (response->result <= OC_STACK_RESOURCE_CHANGED)) ? LOG_INFO : LOG_ERR;
-    LOG(severity, "response=%p,response->result=%d", response, response ? response->result : 0);
+    bool success = response && (response->result <= OC_STACK_RESOURCE_CHANGED);
+    LOG(success ? LOG_INFO : LOG_ERR, "response=%p,response->result=%d", response,
+            response ? response->result : 0);
+    if (!success)
+    {
+        /* The state of the RD is unknown, so replace all the links next time */
+        std::lock_guard<std::mutex> lock(sPublishedMutex);
+        sPublished.Reset();
+    }
     return OC_STACK_DELETE_TRANSACTION;
 }
 
-OCStackResult RDPublish()
+static void GetDiscoverableResources(std::map<std::string, OCResourceHandle> &handles,
+        PublishedLinks::Links &links)
 {
-    uint8_t nr;
-    OCStackResult result = OCGetNumberOfResources(&nr);
-    if (result != OC_STACK_OK)
+    for (OCResourceHandle h : GetResourceHandles())
     {
-        return result;
+        int64_t ins;
+        if ((OCGetResourceProperties(h) & OC_DISCOVERABLE) &&
+                (OCGetResourceIns(h, &ins) == OC_STACK_OK))
+        {
+            handles[OCGetResourceUri(h)] = h;
+            links[OCGetResourceUri(h)] = ins;
+        }
     }
-    std::vector<OCResourceHandle> hs;
-    for (uint8_t i = 0; i < nr; ++i)
+}
+
+/*
+ * The links are published one device at a time, so the size of each request is bounded by the
+ * size of a device rather than of the whole bridge.
+ */
+static OCStackResult Publish(std::vector<OCResourceHandle> &hs)
+{
+    std::map<std::string, std::vector<OCResourceHandle>> devices;
+    for (OCResourceHandle h : hs)
+    {
+        devices[GetResourceDevice(h)].push_back(h);
+    }
+    for (auto &device : devices)
     {
-        OCResourceHandle h = OCGetResourceHandle(i);
-        if (OCGetResourceProperties(h) & OC_DISCOVERABLE)
+        std::vector<OCResourceHandle> &dhs = device.second;
+        OCCallbackData cbData;
+        cbData.cb = RDPublishCB;
+        cbData.context = NULL;
+        cbData.cd = NULL;
+        LOG(LOG_INFO, "Publishing %zu links of %s", dhs.size(), device.first.c_str());
+        OCStackResult result = OCRDPublish(NULL, gRD.c_str(), CT_DEFAULT, &dhs[0], dhs.size(),
+                OIC_RD_PUBLISH_TTL, &cbData, OC_HIGH_QOS);
+        if (result != OC_STACK_OK)
         {
-            hs.push_back(h);
+            return result;
         }
     }
+    return OC_STACK_OK;
+}
+
+static OCStackResult PublishAll()
+{
+    std::map<std::string, OCResourceHandle> handles;
+    PublishedLinks::Links links;
+    GetDiscoverableResources(handles, links);
+    std::vector<OCResourceHandle> hs;
+    for (auto &handle : handles)
+    {
+        hs.push_back(handle.second);
+    }
+    return Publish(hs);
+}
+
+/*
+ * The deleted resources no longer have handles to pass to OCRDDelete(), so the request is made
+ * here from their instance IDs in the same form.
+ */
+static OCStackResult Delete(const std::vector<int64_t> &removed)
+{
+    if (removed.empty())
+    {
+        return OC_STACK_OK;
+    }
+    std::ostringstream uri;
+    uri << gRD << OC_RSRVD_RD_URI << "?di=" << OCGetServerInstanceIDString();
+    for (int64_t ins : removed)
+    {
+        uri << "&ins=" << ins;
+    }
     OCCallbackData cbData;
     cbData.cb = RDPublishCB;
     cbData.context = NULL;
     cbData.cd = NULL;
-    return OCRDPublish(NULL, gRD.c_str(), CT_DEFAULT, &hs[0], hs.size(), OIC_RD_PUBLISH_TTL,
-            &cbData, OC_HIGH_QOS);
+    LOG(LOG_INFO, "Deleting %zu links", removed.size());
+    return OCDoResource(NULL, OC_REST_DELETE, uri.str().c_str(), NULL, NULL, CT_DEFAULT,
+            OC_HIGH_QOS, &cbData, NULL, 0);
+}
+
+static OCStackApplicationResult RDDeleteAllCB(void *ctx, OCDoHandle handle,
+        OCClientResponse *response)
+{
+    (void) ctx;
+    (void) handle;
+    LOG(LOG_INFO, "response=%p,response->result=%d", response, response ? response->result : 0);
+    /* An RD without any of our links may fail the delete, so publish regardless */
+    OCStackResult result = PublishAll();
+    if (result != OC_STACK_OK)
+    {
+        LOG(LOG_ERR, "Publish - %d", result);
+        std::lock_guard<std::mutex> lock(sPublishedMutex);
+        sPublished.Reset();
+    }
+    return OC_STACK_DELETE_TRANSACTION;
+}
+
+OCStackResult RDPublish()
+{
+    std::map<std::string, OCResourceHandle> handles;
+    PublishedLinks::Links links;
+    GetDiscoverableResources(handles, links);
+    std::vector<std::string> added;
+    std::vector<int64_t> removed;
+    PublishedLinks::Publication publication;
+    {
+        std::lock_guard<std::mutex> lock(sPublishedMutex);
+        publication = sPublished.Update(links, time(NULL), added, removed);
+    }
+    OCStackResult result = OC_STACK_OK;
+    switch (publication)
+    {
+        case PublishedLinks::REPLACE:
+            {
+                /* Remove the links of a previous run first so that restarts leave no stale links */
+                OCCallbackData cbData;
+                cbData.cb = RDDeleteAllCB;
+                cbData.context = NULL;
+                cbData.cd = NULL;
+                result = OCRDDelete(NULL, gRD.c_str(), CT_DEFAULT, NULL, 0, &cbData, OC_HIGH_QOS);
+                break;
+            }
+        case PublishedLinks::REFRESH:
+            result = PublishAll();
+            break;
+        case PublishedLinks::DELTA:
+            {
+                std::vector<OCResourceHandle> hs;
+                for (const std::string &uri : added)
+                {
+                    hs.push_back(handles[uri]);
+                }
+                result = Delete(removed);
+                if (result == OC_STACK_OK)
+                {
+                    result = Publish(hs);
+                }
+                break;
+            }
+    }
+    if (result != OC_STACK_OK)
+    {
+        std::lock_guard<std::mutex> lock(sPublishedMutex);
+        sPublished.Reset();
+    }
+    return result;
 }
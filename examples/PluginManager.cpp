@@ -19,19 +19,35 @@
 //-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
 
 #include <sys/types.h>
+#include <sys/socket.h>
 #include <sys/stat.h>
 #include <fcntl.h>
 
+#include "ControlChannel.h"
+#include "Supervisor.h"
 #include <errno.h>
+#include <list>
 #include <map>
+#include <poll.h>
+#include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <string>
 #include <sys/wait.h>
+#include <time.h>
 #include <unistd.h>
-#include "ocrandom.h"
+#include <vector>
+
+static const time_t SAMPLE_PERIOD_SECS = 5;
+/* The bridge processes send a HEALTH message every 5 seconds once started */
+static const time_t HEARTBEAT_TIMEOUT_SECS = 30;
+static const time_t STARTUP_GRACE_SECS = 120;
 
 static volatile sig_atomic_t sQuitFlag = false;
+static volatile sig_atomic_t sChildExitedFlag = false;
+static volatile sig_atomic_t sDumpFlag = false;
+static Supervisor::Limits sLimits;
 
 static void SigIntCB(int sig)
 {
@@ -42,132 +58,436 @@ static void SigIntCB(int sig)
 static void SigChldCB(int sig)
 {
     (void) sig;
-    while (waitpid(-1, NULL, WNOHANG) > 0)
-        ;
+    sChildExitedFlag = true;
 }
 
-int main(int argc, char **argv)
+static void SigUsr1CB(int sig)
+{
+    (void) sig;
+    sDumpFlag = true;
+}
+
+/*
+ * Starts path with args followed by a control channel argument.  Returns the pid of the child,
+ * or -1 on failure, and sets control to this end of the channel.  limits are applied to the
+ * child when not NULL.
+ */
+static pid_t Spawn(char *path, char *name, const std::vector<std::string> &args,
+        ControlChannel **control, const Supervisor::Limits *limits)
 {
-    if (argc < 2)
+    int fds[2] = { -1, -1 };
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) < 0)
     {
-        return EXIT_FAILURE;
+        perror("socketpair");
+        return -1;
+    }
+    /* Later children must not hold this end open, or this child never sees it close */
+    fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    pid_t pid = fork();
+    if (pid < 0)
+    {
+        perror("fork");
+        close(fds[0]);
+        close(fds[1]);
+        return -1;
+    }
+    if (pid == 0)
+    {
+        std::string fd = std::to_string(fds[1]);
+        std::vector<char *> argv;
+        argv.push_back(path);
+        argv.push_back(name);
+        for (const std::string &arg : args)
+        {
+            argv.push_back((char *) arg.c_str());
+        }
+        argv.push_back((char *) "--control");
+        argv.push_back((char *) fd.c_str());
+        argv.push_back(NULL);
+        if (limits && !Supervisor::ApplyLimits(*limits))
+        {
+            perror("setrlimit");
+        }
+        execv(path, &argv[0]);
+        perror("execv");
+        _exit(EXIT_FAILURE);
     }
-    char *path = argv[1];
-    char *name = basename(strdup(argv[1]));
+    close(fds[1]);
+    *control = new ControlChannel(fds[0]);
+    return pid;
+}
 
-    signal(SIGINT, SigIntCB);
-    signal(SIGCHLD, SigChldCB);
+/*
+ * Standby children have started the AllJoyn router, and wait for an EXEC message on their
+ * control channel before initializing the OC stack under the assigned device's identity.
+ */
+struct Standby
+{
+    pid_t m_pid;
+    ControlChannel *m_control;
+};
+static std::list<Standby> sStandby;
+static std::vector<std::string> sStandbyArgs;
 
-    int pipefd[2];
-    if (pipe(pipefd) < 0)
+static bool StartStandby(char *path, char *name)
+{
+    Standby standby;
+    standby.m_pid = Spawn(path, name, sStandbyArgs, &standby.m_control, &sLimits);
+    if (standby.m_pid < 0)
     {
-        perror("pipe");
-        return EXIT_FAILURE;
+        return false;
     }
+    sStandby.push_back(standby);
+    return true;
+}
 
-    pid_t pid = fork();
+/*
+ * Returns the pid of the standby child assigned the exec arguments and sets control to its
+ * channel, or returns -1 if there is none.
+ */
+static pid_t AssignStandby(char *path, char *name, const std::vector<std::string> &args,
+        ControlChannel **control)
+{
+    pid_t pid = -1;
+    while ((pid < 0) && !sStandby.empty())
+    {
+        Standby standby = sStandby.front();
+        sStandby.pop_front();
+        if (standby.m_control->Send(ControlMessage::EXEC, args))
+        {
+            pid = standby.m_pid;
+            *control = standby.m_control;
+        }
+        else
+        {
+            delete standby.m_control;
+        }
+        StartStandby(path, name);
+    }
+    return pid;
+}
+
+static std::string GetArg(const std::vector<std::string> &args, const char *name)
+{
+    for (size_t i = 0; (i + 1) < args.size(); ++i)
+    {
+        if (args[i] == name)
+        {
+            return args[i + 1];
+        }
+    }
+    return "";
+}
+
+static const char *GetSeenState(const std::vector<std::string> &args)
+{
+    for (const std::string &arg : args)
+    {
+        if (arg == "--virtual")
+        {
+            return "virtual";
+        }
+    }
+    return "native";
+}
+
+/* The bridge processes of the devices, and their control channels */
+static std::map<std::string, pid_t> sPids;
+static std::map<pid_t, ControlChannel *> sChannels;
+
+static pid_t StartDevice(char *path, char *name, const std::vector<std::string> &args,
+        Supervisor &supervisor)
+{
+    ControlChannel *control = NULL;
+    pid_t pid = AssignStandby(path, name, args, &control);
     if (pid < 0)
     {
-        perror("fork");
-        return EXIT_FAILURE;
+        pid = Spawn(path, name, args, &control, &sLimits);
     }
-    if (pid == 0)
+    if (pid > 0)
+    {
+        std::string uuid = GetArg(args, "--uuid");
+        sPids[uuid] = pid;
+        sChannels[pid] = control;
+        supervisor.Add(pid, uuid, args, time(NULL));
+    }
+    return pid;
+}
+
+static void CloseChannel(pid_t pid)
+{
+    std::map<pid_t, ControlChannel *>::iterator it = sChannels.find(pid);
+    if (it != sChannels.end())
+    {
+        delete it->second;
+        sChannels.erase(it);
+    }
+}
+
+/*
+ * Reaps the exited children and tells the bridge which devices are no longer bridged, so that
+ * it does not need to check for itself.  The devices whose children crashed are not reported
+ * until they have failed to restart.
+ */
+static void Reap(Supervisor &supervisor, ControlChannel *control)
+{
+    pid_t pid;
+    int status;
+    while ((pid = waitpid(-1, &status, WNOHANG)) > 0)
     {
-        if (dup2(pipefd[1], fileno(stdout)) < 0)
+        std::string uuid;
+        bool restart = false;
+        supervisor.Exited(pid, status, time(NULL), &uuid, &restart);
+        CloseChannel(pid);
+        for (std::map<std::string, pid_t>::iterator it = sPids.begin(); it != sPids.end(); ++it)
         {
-            perror("dup2");
-            return EXIT_FAILURE;
+            if (it->second == pid)
+            {
+                if (!restart)
+                {
+                    control->Send(ControlMessage::SEEN_STATE,
+                            { it->first, "none", std::to_string(pid) });
+                }
+                sPids.erase(it);
+                break;
+            }
+        }
+    }
+}
+
+static void RestartCrashed(char *path, char *name, Supervisor &supervisor, ControlChannel *control)
+{
+    for (Supervisor::Restart &restart : supervisor.GetRestarts(time(NULL)))
+    {
+        pid_t pid = StartDevice(path, name, restart.m_args, supervisor);
+        if (pid > 0)
+        {
+            control->Send(ControlMessage::SEEN_STATE,
+                    { restart.m_uuid, GetSeenState(restart.m_args), std::to_string(pid) });
         }
-        close(pipefd[1]);
-        close(pipefd[0]);
-        char *args[argc + 1];
-        args[0] = path;
-        args[1] = name;
-        for (int i = 2; i < argc; ++i)
+        else
         {
-            args[i] = argv[i];
+            supervisor.Remove(restart.m_uuid);
+            control->Send(ControlMessage::SEEN_STATE,
+                    { restart.m_uuid, "none", std::to_string(restart.m_pid) });
         }
-        args[argc] = NULL;
-        execv(path, args);
-        perror("execl");
+    }
+}
+
+/* Reads the HEALTH messages of the device bridge processes. */
+static void ProcessChannel(pid_t pid, Supervisor &supervisor)
+{
+    ControlChannel *control = sChannels[pid];
+    std::vector<ControlMessage> messages;
+    if (!control->Receive(messages))
+    {
+        /* The child is exiting and will be reaped */
+        CloseChannel(pid);
+        return;
+    }
+    for (ControlMessage &msg : messages)
+    {
+        if (msg.m_type == ControlMessage::HEALTH)
+        {
+            supervisor.Heartbeat(pid, strtoull(GetArg(msg.m_args, "requests").c_str(), NULL, 10),
+                    time(NULL));
+            control->Ack(msg.m_seq, true);
+        }
+        else if (msg.m_type != ControlMessage::ACK)
+        {
+            control->Ack(msg.m_seq, false);
+        }
+    }
+}
+
+static void Usage(const char *name)
+{
+    fprintf(stderr, "Usage: %s [--max-cpu SECS] [--max-as MB] [--max-files N] [--max-rss MB] "
+            "path [args...]\n", name);
+    fprintf(stderr, "  --max-cpu SECS  CPU time limit of each device bridge process\n");
+    fprintf(stderr, "  --max-as MB     address space limit of each device bridge process\n");
+    fprintf(stderr, "  --max-files N   open file limit of each device bridge process\n");
+    fprintf(stderr, "  --max-rss MB    restart the device bridge processes whose RSS exceeds MB\n");
+    fprintf(stderr, "Send SIGUSR1 to print the accounting of the bridge processes.\n");
+}
+
+int main(int argc, char **argv)
+{
+    int argi;
+    for (argi = 1; (argi < (argc - 1)) && !strncmp(argv[argi], "--max-", 6); argi += 2)
+    {
+        unsigned long long value = strtoull(argv[argi + 1], NULL, 10);
+        if (!strcmp(argv[argi], "--max-cpu"))
+        {
+            sLimits.m_cpuSecs = value;
+        }
+        else if (!strcmp(argv[argi], "--max-as"))
+        {
+            sLimits.m_addressSpaceBytes = value * 1024 * 1024;
+        }
+        else if (!strcmp(argv[argi], "--max-files"))
+        {
+            sLimits.m_files = value;
+        }
+        else if (!strcmp(argv[argi], "--max-rss"))
+        {
+            sLimits.m_rssBytes = value * 1024 * 1024;
+        }
+        else
+        {
+            Usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (argi >= argc)
+    {
+        Usage(argv[0]);
         return EXIT_FAILURE;
     }
-    close(pipefd[1]);
+    char *path = argv[argi];
+    char *name = basename(strdup(argv[argi]));
 
-    std::map<std::string, pid_t> pids;
-    char line[512];
-    char *lp = line;
-    char c;
+    signal(SIGINT, SigIntCB);
+    signal(SIGUSR1, SigUsr1CB);
+    /* Interrupt poll() to reap children promptly */
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = SigChldCB;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGCHLD, &sa, NULL);
+
+    Supervisor supervisor(sLimits, HEARTBEAT_TIMEOUT_SECS, STARTUP_GRACE_SECS);
+    std::vector<std::string> args(argv + argi + 1, argv + argc);
+    ControlChannel *control = NULL;
+    pid_t bridgePid = Spawn(path, name, args, &control, NULL);
+    if (bridgePid < 0)
+    {
+        return EXIT_FAILURE;
+    }
+    /* The bridge itself is only accounted for */
+    supervisor.Add(bridgePid, "", std::vector<std::string>(), time(NULL));
+
+    time_t sampleTick = 0;
+    std::vector<ControlMessage> messages;
+    std::vector<struct pollfd> fds;
+    std::vector<pid_t> fdPids;
     while (!sQuitFlag)
     {
-        ssize_t n = read(pipefd[0], &c, 1);
-        if (n < 0)
+        fds.clear();
+        fdPids.clear();
+        fds.push_back({ control->GetFd(), POLLIN, 0 });
+        fdPids.push_back(bridgePid);
+        for (auto &kv : sChannels)
         {
-            perror("read");
-            return EXIT_FAILURE;
+            fds.push_back({ kv.second->GetFd(), POLLIN, 0 });
+            fdPids.push_back(kv.first);
         }
-        if (n == 0)
+        if ((poll(&fds[0], fds.size(), 1000) < 0) && (errno != EINTR))
         {
+            perror("poll");
             break;
         }
-        *lp++ = c;
-        if (c == '\n')
+        if (fds[0].revents && !control->Receive(messages))
         {
-            *lp = '\0';
-            printf("%s", line);
-            lp = line;
-
-            if (!strncmp(line, "exec", strlen("exec")))
+            break;
+        }
+        for (ControlMessage &msg : messages)
+        {
+            switch (msg.m_type)
             {
-                char *args[13] = { 0 };
-                args[0] = path;
-                args[1] = name;
-                sscanf(line, "exec %ms %ms %ms %ms %ms %ms %ms %ms %ms %ms", &args[2], &args[3],
-                        &args[4], &args[5], &args[6], &args[7], &args[8], &args[9], &args[10],
-                        &args[11]);
-                args[12] = NULL;
-                pid_t pid = fork();
-                if (pid < 0)
-                {
-                    perror("fork");
-                    return EXIT_FAILURE;
-                }
-                if (pid == 0)
-                {
-                    execv(path, args);
-                    perror("execv");
-                    return EXIT_FAILURE;
-                }
-                else
-                {
-                    char *uuid = args[5];
-                    pids[uuid] = pid;
-                }
-                for (int i = 2; i < 11; ++i)
-                {
-                    if (args[i])
+                case ControlMessage::POOL:
                     {
-                        free(args[i]);
+                        size_t poolSize = msg.m_args.empty() ? 0 :
+                                strtoul(msg.m_args[0].c_str(), NULL, 10);
+                        sStandbyArgs.assign(msg.m_args.begin() + (msg.m_args.empty() ? 0 : 1),
+                                msg.m_args.end());
+                        sStandbyArgs.insert(sStandbyArgs.begin(), "--standby");
+                        for (size_t i = sStandby.size(); i < poolSize; ++i)
+                        {
+                            StartStandby(path, name);
+                        }
+                        control->Ack(msg.m_seq, true);
+                        break;
                     }
-                }
-            }
-            else if (!strncmp(line, "kill", strlen("kill")))
-            {
-                char uuid[UUID_STRING_SIZE];
-                sscanf(line, "kill --uuid %s", uuid);
-                std::map<std::string, pid_t>::iterator it = pids.find(uuid);
-                if (it != pids.end())
-                {
-                    if (kill(it->second, SIGINT) < 0)
+                case ControlMessage::EXEC:
                     {
-                        perror("kill");
+                        pid_t pid = StartDevice(path, name, msg.m_args, supervisor);
+                        control->Ack(msg.m_seq, pid > 0, { std::to_string(pid) });
+                        break;
                     }
-                }
+                case ControlMessage::KILL:
+                    {
+                        bool killed = false;
+                        std::map<std::string, pid_t>::iterator it = sPids.end();
+                        if (!msg.m_args.empty())
+                        {
+                            it = sPids.find(msg.m_args[0]);
+                            /* Also cancels a pending restart */
+                            killed = supervisor.Remove(msg.m_args[0]);
+                        }
+                        if (it != sPids.end())
+                        {
+                            killed = (kill(it->second, SIGINT) == 0);
+                            if (!killed)
+                            {
+                                perror("kill");
+                            }
+                        }
+                        control->Ack(msg.m_seq, killed);
+                        break;
+                    }
+                case ControlMessage::HEALTH:
+                    supervisor.Heartbeat(bridgePid,
+                            strtoull(GetArg(msg.m_args, "requests").c_str(), NULL, 10),
+                            time(NULL));
+                    control->Ack(msg.m_seq, true);
+                    break;
+                default:
+                    control->Ack(msg.m_seq, false);
+                    break;
             }
-
         }
+        messages.clear();
+        for (size_t i = 1; i < fds.size(); ++i)
+        {
+            if (fds[i].revents && sChannels.count(fdPids[i]))
+            {
+                ProcessChannel(fdPids[i], supervisor);
+            }
+        }
+        if (sChildExitedFlag)
+        {
+            sChildExitedFlag = false;
+            Reap(supervisor, control);
+        }
+        time_t now = time(NULL);
+        if (now >= sampleTick)
+        {
+            sampleTick = now + SAMPLE_PERIOD_SECS;
+            std::vector<pid_t> pids = supervisor.Sample();
+            std::vector<pid_t> wedged = supervisor.GetWedged(now);
+            pids.insert(pids.end(), wedged.begin(), wedged.end());
+            for (pid_t pid : pids)
+            {
+                kill(pid, SIGKILL);
+            }
+        }
+        RestartCrashed(path, name, supervisor, control);
+        if (sDumpFlag)
+        {
+            sDumpFlag = false;
+            supervisor.Dump(stdout, now);
+        }
+    }
+    delete control;
+    for (Standby &standby : sStandby)
+    {
+        delete standby.m_control;
+    }
+    for (auto &kv : sChannels)
+    {
+        delete kv.second;
     }
-    close(pipefd[0]);
 
     while (waitpid(-1, NULL, 0))
     {
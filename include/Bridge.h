@@ -27,20 +27,30 @@
 #include <alljoyn/BusAttachment.h>
 #include <alljoyn/SessionListener.h>
 #include <inttypes.h>
+#include <chrono>
 #include <list>
 #include <condition_variable>
 #include <mutex>
 #include <vector>
 #include <set>
 
+class AllJoynPresenceManager;
 class AllJoynSecurity;
+class DeviceSnapshots;
+class DiscoveryScheduler;
+class IntrospectionCache;
+class MetricsBusObject;
+class MetricsResource;
+class ModelCache;
 class OCSecurity;
+class PendingCreates;
 class Presence;
 class SecureModeResource;
 class VirtualBusAttachment;
 class VirtualBusObject;
 class VirtualDevice;
 class VirtualResource;
+class WorkerPool;
 
 class Bridge : private ajn::AboutListener
     , private ajn::ApplicationStateListener
@@ -73,6 +83,34 @@ class Bridge : private ajn::AboutListener
         void SetManufacturerName(const char *manufacturerName) { m_manufacturerName = manufacturerName; }
         void SetSecureMode(bool secureMode);
 
+        /*
+         * Handle requests to virtual OC resources on numThreads threads instead of the thread
+         * calling OCProcess().  Must be called before Start().  The thread calling OCProcess()
+         * must then also call ProcessResponses().
+         */
+        void SetEntityHandlerThreads(size_t numThreads);
+        static void ProcessResponses();
+
+        /*
+         * Keep the introspection data of the OC device models seen in persistent storage so that
+         * it is reused across restarts.  Must be called before Start().
+         */
+        void SetModelCachePersistent(bool persistent) { m_isModelCachePersistent = persistent; }
+
+        /*
+         * Keep a snapshot of each bridged OC device in persistent storage so that its virtual AJ
+         * device is recreated by Start() and only revalidated once the OC device is discovered
+         * again.  Must be called before Start().
+         */
+        void SetDeviceSnapshotsPersistent(bool persistent) { m_isSnapshotPersistent = persistent; }
+
+        /*
+         * Create the virtual OC resources of an AJ device from its default language About data,
+         * and load the other supported languages after.  Until then, localized values fall back
+         * to the default language.
+         */
+        void SetAboutLanguagesLazy(bool lazy) { m_isAboutLanguageLazy = lazy; }
+
         bool Start();
         bool Stop();
         void ResetSecurity();
@@ -102,17 +140,27 @@ class Bridge : private ajn::AboutListener
             std::string m_piid;
             OCRepPayload *m_payload;
             DiscoverContext *m_context;
+            /* Takes ownership of payload. */
             DiscoverTask(time_t tick, const char *piid, OCRepPayload *payload,
                     DiscoverContext *context) : Task(tick), m_piid(piid),
-                    m_payload(OCRepPayloadClone(payload)), m_context(context) { }
+                    m_payload(payload), m_context(context) { }
             virtual ~DiscoverTask() { OCRepPayloadDestroy(m_payload); }
             virtual void Run(Bridge *thiz);
         };
         struct RDPublishTask : public Task {
-            RDPublishTask(time_t tick) : Task(tick) { }
+            time_t m_deadline;
+            RDPublishTask(time_t tick)
+                : Task(tick), m_deadline(tick + RD_PUBLISH_MAX_DELAY_SECS) { }
             virtual ~RDPublishTask() { }
             virtual void Run(Bridge *thiz);
         };
+        struct SecureConnectionTask : public Task {
+            AnnouncedContext *m_context;
+            SecureConnectionTask(time_t tick, AnnouncedContext *context)
+                : Task(tick), m_context(context) { }
+            virtual ~SecureConnectionTask() { }
+            virtual void Run(Bridge *thiz);
+        };
         class InsecureLeaveSessionCB: public ajn::BusAttachment::LeaveSessionAsyncCB {
         public:
             virtual ~InsecureLeaveSessionCB() { }
@@ -120,6 +168,12 @@ class Bridge : private ajn::AboutListener
         };
 
         static const time_t DISCOVER_PERIOD_SECS = 5;
+        static const time_t DISCOVER_MAX_PERIOD_SECS = 300;
+        static const time_t RD_PUBLISH_MAX_DELAY_SECS = 5;
+        static const time_t PRESENCE_PERIOD_SECS = 15;
+        static const size_t SECURE_CONNECTION_THREADS = 4;
+        static const size_t SECURE_CONNECTION_QUEUE_DEPTH = 64;
+        static const size_t ENTITY_HANDLER_QUEUE_DEPTH = 256;
 
         ExecCB m_execCb;
         GetSeenStateCB m_seenStateCb;
@@ -127,6 +181,11 @@ class Bridge : private ajn::AboutListener
         SessionLostCB m_sessionLostCb;
 
         std::mutex m_mutex;
+        /*
+         * Held while the introspection data is regenerated from the OC resources, and while a
+         * virtual resource and its OC resources are deleted.  Taken after m_mutex.
+         */
+        std::mutex m_introspectionMutex;
         std::condition_variable m_cond;
         Protocol m_protocols;
         enum { CREATED, STARTED, CONNECTED, CLAIMABLE, RUNNING } m_ajState;
@@ -135,27 +194,53 @@ class Bridge : private ajn::AboutListener
         AllJoynSecurity *m_ajSecurity;
         OCSecurity *m_ocSecurity;
         OCDoHandle m_discoverHandle;
-        time_t m_discoverNextTick;
+        DiscoveryScheduler *m_discoveryScheduler;
+        std::map<OCDoHandle, std::string> m_probing;
         std::vector<Presence *> m_presence;
+        AllJoynPresenceManager *m_ajPresence;
         std::vector<VirtualDevice *> m_virtualDevices;
         std::vector<VirtualResource *> m_virtualResources;
         std::vector<VirtualBusAttachment *> m_virtualBusAttachments;
         std::map<OCDoHandle, DiscoverContext *> m_discovered;
+        std::set<DiscoverContext *> m_parsing;
         SecureModeResource *m_secureMode;
+        MetricsResource *m_metrics;
+        MetricsBusObject *m_metricsObj;
+        time_t m_metricsTick;
         std::list<Task*> m_tasks;
         RDPublishTask *m_rdPublishTask;
+        bool m_isRDPublishDue;
+        /* Virtual resources created but not yet reported by ResourceCreatedCB() */
+        PendingCreates *m_pendingCreates;
         size_t m_pending;
         std::string m_ajSoftwareVersion;
         std::string m_deviceName;
         std::string m_manufacturerName;
         std::set<AnnouncedContext *> m_insecureAnnounced;
+        WorkerPool *m_secureConnections;
+        std::set<std::string> m_securePiids;
+        WorkerPool *m_entityHandlers;
+        IntrospectionCache *m_introspectionCache;
+        ModelCache *m_modelCache;
+        bool m_isModelCachePersistent;
+        std::list<DiscoverContext *> m_modelHits;
+        DeviceSnapshots *m_snapshots;
+        bool m_isSnapshotPersistent;
+        std::set<std::string> m_unverified;
+        std::chrono::steady_clock::time_point m_startTime;
+        bool m_isDeviceAvailable;
+        bool m_isAboutLanguageLazy;
         InsecureLeaveSessionCB m_insecureLeaveSessionCB;
 
-        static void RDPublish(void *context);
+        static void ResourceCreatedCB(void *context, VirtualResource *resource,
+                OCStackResult result);
+        void UpdateMetrics();
+        void ScheduleRDPublish(time_t delaySecs);
         void SetIntrospectionData(ajn::BusAttachment *bus, const char *ajSoftwareVersion,
                 const char *title, const char *version);
         void WhoImplements();
         void Destroy(const char *id);
+        void Restore();
         virtual void BusDisconnected();
         virtual void Announced(const char *name, uint16_t version, ajn::SessionPort port,
                 const ajn::MsgArg &objectDescriptionArg, const ajn::MsgArg &aboutDataArg);
@@ -163,11 +248,15 @@ class Bridge : private ajn::AboutListener
                 const ajn::SessionOpts &opts, void *context);
         virtual void LeaveSessionCB(QStatus status, void *ctx);
         void GetAboutDataCB(ajn::Message &msg, void *ctx);
+        void GetLocalizedAboutDataCB(ajn::Message &msg, void *ctx);
+        void CreateVirtualObjects(AnnouncedContext *context);
+        void UpdateAboutData(AnnouncedContext *context);
         virtual void SessionLost(ajn::SessionId sessionId,
                 ajn::SessionListener::SessionLostReason reason);
         VirtualResource *CreateVirtualResource(ajn::BusAttachment *bus, const char *name,
                 ajn::SessionId sessionId, const char *path, const char *ajSoftwareVersion,
                 ajn::AboutData *aboutData);
+        void DeleteVirtualResource(VirtualResource *resource);
         virtual void State(const char* busName, const qcc::KeyInfoNISTP256& publicKeyInfo,
                 ajn::PermissionConfigurator::ApplicationState state);
         virtual void AddMatchCB(QStatus status, void *ctx);
@@ -178,6 +267,8 @@ class Bridge : private ajn::AboutListener
                 OCEntityHandlerRequest *request, void *context);
         static OCStackApplicationResult DiscoverCB(void *context, OCDoHandle handle,
                 OCClientResponse *response);
+        static OCStackApplicationResult DiscoverDeviceCB(void *context, OCDoHandle handle,
+                OCClientResponse *response);
         static OCStackApplicationResult GetCollectionCB(void *context, OCDoHandle handle,
                 OCClientResponse *response);
         static OCStackApplicationResult GetPlatformCB(void *context, OCDoHandle handle,
@@ -199,6 +290,7 @@ class Bridge : private ajn::AboutListener
 
         SeenState GetSeenState(const char *piid);
         void DestroyPiid(const char *piid);
+        void QueueSecureConnection(AnnouncedContext *context);
         static void SecureConnection(Bridge *thiz, const char *name, void *ctx);
         void SecureConnectionCB(QStatus status, void *ctx);
 
@@ -209,7 +301,8 @@ class Bridge : private ajn::AboutListener
         void UpdatePresenceStatus(const OCDiscoveryPayload *payload);
         void GetContextAndRepPayload(OCDoHandle handle, OCClientResponse *response,
                 DiscoverContext **context, OCRepPayload **payload);
-        bool ParseIntrospectionPayload(DiscoverContext *context, OCRepPayload *payload);
+        bool ParseIntrospectionPayload(DiscoverContext *context, OCRepPayload *payload,
+                std::unique_lock<std::mutex> &lock);
         OCStackResult GetIntrospection(DiscoverContext *context);
         OCStackResult GetCollection(DiscoverContext *context);
         OCStackResult GetPlatformConfiguration(DiscoverContext *context);
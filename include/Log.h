@@ -22,10 +22,37 @@
 #define _LOG_H
 
 #include "cacommon.h"
+#include <stdio.h>
 
 #define LOG_ERR         3
 #define LOG_INFO        6
 
+/*
+ * The most verbose severity compiled in.  LOG() statements above it, including the evaluation
+ * of their arguments, are removed by the compiler.
+ */
+#ifndef LOG_LEVEL
+#define LOG_LEVEL       LOG_INFO
+#endif
+
+/* The most verbose severity written, set with LogSetLevel(). */
+extern int8_t gLogLevel;
+
+void LogSetLevel(int8_t severity);
+
+/* Where to write the log, stderr by default.  Must be called before LogStartAsync(). */
+void LogSetOutput(FILE *fp);
+
+/*
+ * Queues the formatted lines on a lock-free ring buffer written out by a background thread
+ * instead of writing and flushing each line from the logging thread.  Lines are dropped and
+ * counted, rather than blocking the caller, when the ring is full.
+ */
+void LogStartAsync();
+
+/* Writes out the queued lines and stops the background thread. */
+void LogStopAsync();
+
 void LogWriteln(
     const char *file,
     const char *function,
@@ -36,6 +63,13 @@ void LogWriteln(
 );
 
 #define LOG(severity, fmt, ...)                                         \
-    LogWriteln(__FILE__, __FUNCTION__, __LINE__, severity, fmt, ##__VA_ARGS__)
+    do                                                                  \
+    {                                                                   \
+        if (((severity) <= LOG_LEVEL) && ((severity) <= gLogLevel))     \
+        {                                                               \
+            LogWriteln(__FILE__, __FUNCTION__, __LINE__, severity, fmt, \
+                    ##__VA_ARGS__);                                     \
+        }                                                               \
+    } while (0)
 
 #endif // _LOG_H
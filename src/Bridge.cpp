@@ -21,16 +21,25 @@
 #include "Bridge.h"
 
 #include "DeviceConfigurationResource.h"
+#include "DeviceSnapshots.h"
+#include "DiscoveryScheduler.h"
 #include "Hash.h"
 #include "Interfaces.h"
 #include "Introspection.h"
 #include "Log.h"
+#include "Metrics.h"
+#include "MetricsBusObject.h"
+#include "MetricsResource.h"
+#include "ModelCache.h"
 #include "Name.h"
 #include "Payload.h"
+#include "PendingCreates.h"
 #include "PlatformConfigurationResource.h"
 #include "Plugin.h"
 #include "Presence.h"
+#include "Probes.h"
 #include "Resource.h"
+#include "ResponseQueue.h"
 #include "SecureModeResource.h"
 #include "Security.h"
 #include "VirtualBusAttachment.h"
@@ -39,6 +48,7 @@
 #include "VirtualConfigurationResource.h"
 #include "VirtualDevice.h"
 #include "VirtualResource.h"
+#include "WorkerPool.h"
 #include "ocpayload.h"
 #include "ocrandom.h"
 #include "ocstack.h"
@@ -49,8 +59,9 @@
 #include <assert.h>
 #include <deque>
 #include <iterator>
+#include <math.h>
+#include <memory>
 #include <sstream>
-#include <thread>
 
 #if __WITH_DTLS__
 #define SECURE_MODE_DEFAULT true
@@ -58,19 +69,76 @@
 #define SECURE_MODE_DEFAULT false
 #endif
 
+#define MODEL_CACHE_FILE_NAME "models.dat"
+#define DEVICE_SNAPSHOTS_FILE_NAME "devices.dat"
+
+static Gauge sPending("bridge.pending");
+static Counter sAnnounced("discovery.aj.announced");
+static Counter sSessionsJoined("discovery.aj.sessions_joined");
+static Counter sDiscovered("discovery.oc.discovered");
+static Counter sProbed("discovery.oc.probed");
+static Counter sIntrospected("discovery.oc.introspected");
+static Gauge sPingRate("presence.aj.pings_per_min");
+/* How long the callbacks wait for m_mutex when another thread holds it */
+static Histogram sLockWait("bridge.lock_wait_ns");
+
+/* Sampled from the worker pools by UpdateMetrics() */
+struct WorkerPoolGauges
+{
+    Gauge m_threads;
+    Gauge m_queueDepth;
+    Gauge m_maxQueueDepth;
+    Gauge m_rejected;
+    WorkerPoolGauges(const char *threads, const char *queueDepth, const char *maxQueueDepth,
+            const char *rejected)
+        : m_threads(threads), m_queueDepth(queueDepth), m_maxQueueDepth(maxQueueDepth),
+          m_rejected(rejected) { }
+    void Set(WorkerPool *pool)
+    {
+        m_threads.Set(pool->GetNumThreads());
+        m_queueDepth.Set(pool->GetQueueDepth());
+        m_maxQueueDepth.Set(pool->GetMaxQueueDepth());
+        m_rejected.Set(pool->GetNumRejected());
+    }
+};
+static WorkerPoolGauges sSecureConnectionGauges("workers.secure_connections.threads",
+        "workers.secure_connections.queue_depth", "workers.secure_connections.max_queue_depth",
+        "workers.secure_connections.rejected");
+static WorkerPoolGauges sEntityHandlerGauges("workers.entity_handlers.threads",
+        "workers.entity_handlers.queue_depth", "workers.entity_handlers.max_queue_depth",
+        "workers.entity_handlers.rejected");
+
 struct Bridge::DiscoverContext
 {
     Bridge *m_bridge;
     Device m_device;
+    std::string m_piid;
+    std::string m_dmv;
+    std::string m_fingerprint;
+    ModelCache::Model m_model;
+    bool m_isModelRejected;
+    std::vector<OCRepPayload *> m_aboutData;
+    bool m_isRestored;
+    bool m_isRevalidating;
     VirtualBusAttachment *m_bus;
     OCRepPayload *m_paths;
     OCRepPayload *m_definitions;
     std::vector<Resource>::iterator m_rit;
+    bool m_isDestroyed;
     DiscoverContext(Bridge *bridge, OCDevAddr origin, OCDiscoveryPayload *payload)
-        : m_bridge(bridge), m_device(origin, payload), m_bus(NULL), m_paths(NULL),
-          m_definitions(NULL) { }
+        : m_bridge(bridge), m_device(origin, payload), m_isModelRejected(false),
+          m_isRestored(false), m_isRevalidating(false), m_bus(NULL), m_paths(NULL),
+          m_definitions(NULL), m_isDestroyed(false) { }
+    DiscoverContext(Bridge *bridge, const Device &device)
+        : m_bridge(bridge), m_device(device), m_isModelRejected(false), m_isRestored(false),
+          m_isRevalidating(false), m_bus(NULL), m_paths(NULL), m_definitions(NULL),
+          m_isDestroyed(false) { }
     ~DiscoverContext()
     {
+        for (OCRepPayload *payload : m_aboutData)
+        {
+            OCRepPayloadDestroy(payload);
+        }
         OCRepPayloadDestroy(m_paths);
         OCRepPayloadDestroy(m_definitions);
         if (m_bus)
@@ -79,14 +147,30 @@ struct Bridge::DiscoverContext
             delete m_bus;
         }
     }
-    std::vector<OCDevAddr> GetDevAddrs(const char *uri)
+    SharedVector<OCDevAddr> GetDevAddrs(const char *uri)
     {
         Resource *resource = m_device.GetResourceUri(uri);
         if (resource)
         {
             return resource->m_addrs;
         }
-        return std::vector<OCDevAddr>();
+        return SharedVector<OCDevAddr>();
+    }
+    /* m_bus is NULL while revalidating a restored device. */
+    void SetAboutData(OCRepPayload *payload)
+    {
+        if (m_bus)
+        {
+            m_bus->SetAboutData(payload);
+        }
+        if (payload && m_bridge->m_isSnapshotPersistent)
+        {
+            OCRepPayload *clone = OCRepPayloadClone(payload);
+            if (clone)
+            {
+                m_aboutData.push_back(clone);
+            }
+        }
     }
 
     /* Each iteration returns a translatable resource and resource type pair. */
@@ -94,7 +178,7 @@ struct Bridge::DiscoverContext
     {
         DiscoverContext *m_context;
         std::vector<Resource>::iterator m_r;
-        std::vector<std::string>::iterator m_rt;
+        std::vector<std::string>::const_iterator m_rt;
         Iterator() { }
         Iterator(DiscoverContext *context, bool isBegin = true)
             : m_context(context)
@@ -143,7 +227,7 @@ struct Bridge::DiscoverContext
             }
             return uri;
         }
-        std::vector<OCDevAddr> GetDevAddrs()
+        SharedVector<OCDevAddr> GetDevAddrs()
         {
             return m_r->m_addrs;
         }
@@ -172,26 +256,56 @@ struct Bridge::DiscoverContext
 
 Bridge::Bridge(const char *name, Protocol protocols)
     : m_execCb(NULL), m_sessionLostCb(NULL), m_protocols(protocols), m_sender(NULL),
-      m_discoverHandle(NULL), m_discoverNextTick(0), m_secureMode(NULL),
-      m_rdPublishTask(NULL), m_pending(0)
+      m_discoverHandle(NULL), m_discoveryScheduler(NULL), m_secureMode(NULL),
+      m_metrics(NULL), m_metricsObj(NULL), m_metricsTick(0),
+      m_rdPublishTask(NULL), m_isRDPublishDue(false), m_pendingCreates(NULL),
+      m_pending(0), m_entityHandlers(NULL),
+      m_introspectionCache(NULL), m_modelCache(NULL), m_isModelCachePersistent(false),
+      m_snapshots(NULL), m_isSnapshotPersistent(false), m_isDeviceAvailable(false),
+      m_isAboutLanguageLazy(false)
 {
     m_bus = new ajn::BusAttachment(name, true);
+    m_ajPresence = new AllJoynPresenceManager(m_bus);
     m_ajState = CREATED;
     m_ajSecurity = new AllJoynSecurity(m_bus, AllJoynSecurity::CONSUMER, this);
     m_ocSecurity = new OCSecurity();
     m_secureMode = new SecureModeResource(m_mutex, SECURE_MODE_DEFAULT);
+    m_metrics = new MetricsResource();
+    m_metricsObj = new MetricsBusObject(m_bus);
+    m_secureConnections = new WorkerPool(SECURE_CONNECTION_THREADS,
+            SECURE_CONNECTION_QUEUE_DEPTH);
+    m_introspectionCache = new IntrospectionCache();
+    m_modelCache = new ModelCache();
+    m_snapshots = new DeviceSnapshots();
+    m_discoveryScheduler = new DiscoveryScheduler(DISCOVER_PERIOD_SECS, DISCOVER_MAX_PERIOD_SECS);
+    m_pendingCreates = new PendingCreates();
 }
 
 Bridge::Bridge(const char *name, const char *sender)
     : m_execCb(NULL), m_sessionLostCb(NULL), m_protocols(AJ), m_sender(sender),
-      m_discoverHandle(NULL), m_discoverNextTick(0), m_secureMode(NULL),
-      m_rdPublishTask(NULL), m_pending(0)
+      m_discoverHandle(NULL), m_discoveryScheduler(NULL), m_secureMode(NULL),
+      m_metrics(NULL), m_metricsObj(NULL), m_metricsTick(0),
+      m_rdPublishTask(NULL), m_isRDPublishDue(false), m_pendingCreates(NULL),
+      m_pending(0), m_entityHandlers(NULL),
+      m_introspectionCache(NULL), m_modelCache(NULL), m_isModelCachePersistent(false),
+      m_snapshots(NULL), m_isSnapshotPersistent(false), m_isDeviceAvailable(false),
+      m_isAboutLanguageLazy(false)
 {
     m_bus = new ajn::BusAttachment(name, true);
+    m_ajPresence = new AllJoynPresenceManager(m_bus);
     m_ajState = CREATED;
     m_ajSecurity = new AllJoynSecurity(m_bus, AllJoynSecurity::CONSUMER, this);
     m_ocSecurity = new OCSecurity();
     m_secureMode = new SecureModeResource(m_mutex, SECURE_MODE_DEFAULT);
+    m_metrics = new MetricsResource();
+    m_metricsObj = new MetricsBusObject(m_bus);
+    m_secureConnections = new WorkerPool(SECURE_CONNECTION_THREADS,
+            SECURE_CONNECTION_QUEUE_DEPTH);
+    m_introspectionCache = new IntrospectionCache();
+    m_modelCache = new ModelCache();
+    m_snapshots = new DeviceSnapshots();
+    m_discoveryScheduler = new DiscoveryScheduler(DISCOVER_PERIOD_SECS, DISCOVER_MAX_PERIOD_SECS);
+    m_pendingCreates = new PendingCreates();
 }
 
 Bridge::~Bridge()
@@ -199,7 +313,7 @@ Bridge::~Bridge()
     LOG(LOG_INFO, "[%p]", this);
 
     {
-        std::unique_lock<std::mutex> lock(m_mutex);
+        MeteredLock lock(m_mutex, sLockWait);
         while (m_pending > 0)
         {
             m_cond.wait(lock);
@@ -215,6 +329,11 @@ Bridge::~Bridge()
             delete discoverContext;
         }
         m_discovered.clear();
+        for (DiscoverContext *discoverContext : m_modelHits)
+        {
+            delete discoverContext;
+        }
+        m_modelHits.clear();
         for (VirtualBusAttachment *busAttachment : m_virtualBusAttachments)
         {
             delete busAttachment;
@@ -231,9 +350,20 @@ Bridge::~Bridge()
         }
         m_virtualDevices.clear();
     }
+    delete m_secureConnections;
+    delete m_entityHandlers;
+    delete m_introspectionCache;
+    delete m_modelCache;
+    delete m_snapshots;
+    delete m_discoveryScheduler;
+    delete m_pendingCreates;
     delete m_ocSecurity;
     delete m_ajSecurity;
+    m_bus->UnregisterBusObject(*m_metricsObj);
+    delete m_metricsObj;
+    delete m_metrics;
     delete m_bus;
+    delete m_ajPresence;
 }
 
 void Bridge::SetSecureMode(bool secureMode)
@@ -241,6 +371,19 @@ void Bridge::SetSecureMode(bool secureMode)
     m_secureMode->SetSecureMode(secureMode);
 }
 
+void Bridge::SetEntityHandlerThreads(size_t numThreads)
+{
+    LOG(LOG_INFO, "[%p] numThreads=%zu", this, numThreads);
+
+    delete m_entityHandlers;
+    m_entityHandlers = numThreads ? new WorkerPool(numThreads, ENTITY_HANDLER_QUEUE_DEPTH) : NULL;
+}
+
+void Bridge::ProcessResponses()
+{
+    ::ProcessResponses();
+}
+
 /* Called with m_mutex held. */
 void Bridge::Destroy(const char *id)
 {
@@ -258,6 +401,15 @@ void Bridge::Destroy(const char *id)
             ++dc;
         }
     }
+    for (DiscoverContext *context : m_parsing)
+    {
+        if (context->m_device.m_di == id)
+        {
+            /* Deleted by the parsing thread when it reacquires m_mutex */
+            context->m_isDestroyed = true;
+        }
+    }
+    m_unverified.erase(id);
     std::vector<VirtualBusAttachment *>::iterator vba = m_virtualBusAttachments.begin();
     while (vba != m_virtualBusAttachments.end())
     {
@@ -273,13 +425,18 @@ void Bridge::Destroy(const char *id)
             ++vba;
         }
     }
+    if (!GetResourceHandles(id).empty())
+    {
+        /* Remove the links of the device's resources from the RD */
+        ScheduleRDPublish(1);
+    }
     std::vector<VirtualResource *>::iterator vr = m_virtualResources.begin();
     while (vr != m_virtualResources.end())
     {
         VirtualResource *resource = *vr;
         if (resource->GetUniqueName() == id)
         {
-            delete resource;
+            DeleteVirtualResource(resource);
             vr = m_virtualResources.erase(vr);
         }
         else
@@ -319,12 +476,13 @@ void Bridge::Destroy(const char *id)
 
 bool Bridge::Start()
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    MeteredLock lock(m_mutex, sLockWait);
 
     if (!m_ocSecurity->Init())
     {
         return false;
     }
+    IndexStackResources();
     if (!m_sender)
     {
         OCStackResult result;
@@ -389,8 +547,25 @@ bool Bridge::Start()
             LOG(LOG_ERR, "SecureModeResource::Create() - %d", result);
             return false;
         }
+        result = m_metrics->Create();
+        if (result != OC_STACK_OK)
+        {
+            LOG(LOG_ERR, "MetricsResource::Create() - %d", result);
+            return false;
+        }
+        std::lock_guard<std::mutex> introspectionLock(m_introspectionMutex);
         SetIntrospectionData(NULL, NULL, "TITLE", "VERSION");
     }
+    if ((m_protocols & OC) && m_isModelCachePersistent)
+    {
+        m_modelCache->Load(MODEL_CACHE_FILE_NAME);
+    }
+    m_startTime = std::chrono::steady_clock::now();
+    if ((m_protocols & OC) && m_isSnapshotPersistent)
+    {
+        m_snapshots->Load(DEVICE_SNAPSHOTS_FILE_NAME);
+        Restore();
+    }
     LOG(LOG_INFO, "di=%s", OCGetServerInstanceIDString());
 
     if (m_protocols & AJ)
@@ -403,6 +578,12 @@ bool Bridge::Start()
             LOG(LOG_ERR, "Start - %s", QCC_StatusText(status));
             return false;
         }
+        status = m_bus->RegisterBusObject(*m_metricsObj);
+        if (status != ER_OK)
+        {
+            LOG(LOG_ERR, "RegisterBusObject - %s", QCC_StatusText(status));
+            return false;
+        }
         m_ajState = STARTED;
     }
     return true;
@@ -412,7 +593,7 @@ bool Bridge::Stop()
 {
     LOG(LOG_INFO, "[%p]", this);
 
-    std::lock_guard<std::mutex> lock(m_mutex);
+    MeteredLock lock(m_mutex, sLockWait);
     for (VirtualBusAttachment *busAttachment : m_virtualBusAttachments)
     {
         busAttachment->Stop();
@@ -441,7 +622,8 @@ void Bridge::ResetSecurity()
 
 bool Bridge::Process()
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    PROBE1(bridge_process_begin, this);
+    MeteredLock lock(m_mutex, sLockWait);
     if (m_protocols & AJ)
     {
         QStatus status;
@@ -476,10 +658,12 @@ bool Bridge::Process()
             case RUNNING:
                 break;
         }
+        m_ajPresence->Process();
     }
     if (m_protocols & OC)
     {
-        if (time(NULL) >= m_discoverNextTick)
+        time_t now = time(NULL);
+        if (m_discoveryScheduler->IsDue(now))
         {
             if (m_discoverHandle)
             {
@@ -498,11 +682,25 @@ bool Bridge::Process()
             size_t numOptions = 0;
             uint16_t format = COAP_MEDIATYPE_APPLICATION_VND_OCF_CBOR; // TODO retry with CBOR
             OCSetHeaderOption(options, &numOptions, CA_OPTION_ACCEPT, &format, sizeof(format));
-            ::DoResource(&m_discoverHandle, OC_REST_DISCOVER, OC_RSRVD_WELL_KNOWN_URI, NULL, 0,
-                    &cbData, options, numOptions);
-            m_discoverNextTick = time(NULL) + DISCOVER_PERIOD_SECS;
+            /*
+             * Only the device resources are requested from everyone; the full resource list is
+             * requested with a unicast from new devices only.
+             */
+            ::DoResource(&m_discoverHandle, OC_REST_DISCOVER,
+                    OC_RSRVD_WELL_KNOWN_URI "?rt=" OC_RSRVD_RESOURCE_TYPE_DEVICE, NULL, 0, &cbData,
+                    options, numOptions);
+            m_discoveryScheduler->Sent(now);
+            LOG(LOG_INFO, "[%p] period=%ld,requests=%zu,responses=%zu,changes=%zu,probes=%zu",
+                    this, (long) m_discoveryScheduler->GetPeriod(),
+                    m_discoveryScheduler->GetNumRequests(), m_discoveryScheduler->GetNumResponses(),
+                    m_discoveryScheduler->GetNumChanges(), OCPresence::GetNumProbes());
         }
     }
+    for (VirtualBusAttachment *busAttachment : m_virtualBusAttachments)
+    {
+        busAttachment->Process();
+    }
+    UpdateMetrics();
     std::vector<std::string> absent;
     for (Presence *presence : m_presence)
     {
@@ -514,7 +712,14 @@ bool Bridge::Process()
     for (std::string &id : absent)
     {
         LOG(LOG_INFO, "[%p] %s absent", this, id.c_str());
+        PROBE1(presence_absent, id.c_str());
         Destroy(id.c_str());
+        m_discoveryScheduler->Changed(time(NULL));
+        if (m_isSnapshotPersistent && m_snapshots->Get(id))
+        {
+            m_snapshots->Erase(id);
+            m_snapshots->Save(DEVICE_SNAPSHOTS_FILE_NAME);
+        }
     }
     std::list<Task *>::iterator task = m_tasks.begin();
     while (task != m_tasks.end())
@@ -530,13 +735,84 @@ bool Bridge::Process()
             ++task;
         }
     }
+    while (!m_modelHits.empty())
+    {
+        DiscoverContext *context = m_modelHits.front();
+        m_modelHits.pop_front();
+        m_parsing.erase(context);
+        if (!context->m_isDestroyed &&
+                !ParseIntrospectionPayload(context, context->m_model.get(), lock) &&
+                !context->m_isDestroyed)
+        {
+            if (context->m_isRestored)
+            {
+                /* The device is created from scratch when it is rediscovered */
+                LOG(LOG_INFO, "[%p] Snapshot of %s rejected", this,
+                        context->m_device.m_di.c_str());
+                m_unverified.erase(context->m_device.m_di);
+                m_snapshots->Erase(context->m_device.m_di);
+            }
+            else
+            {
+                LOG(LOG_INFO, "[%p] Cached model rejected by %s", this,
+                        context->m_device.m_di.c_str());
+                m_modelCache->Erase(context->m_fingerprint);
+                context->m_model.reset();
+                context->m_isModelRejected = true;
+                if (GetIntrospection(context) == OC_STACK_OK)
+                {
+                    context = NULL;
+                }
+            }
+        }
+        delete context;
+    }
+    if (m_isRDPublishDue)
+    {
+        /*
+         * Regenerating the introspection data walks every virtual resource, so do it without
+         * m_mutex to avoid stalling the callbacks of unrelated devices.
+         */
+        m_isRDPublishDue = false;
+        for (const PendingCreates::Batch &batch : m_pendingCreates->GetCompleted())
+        {
+            std::chrono::milliseconds elapsed =
+                    std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::steady_clock::now() - batch.m_announced);
+            LOG(LOG_INFO, "[%p] %zu paths of %s published %lld ms after announce", this,
+                    batch.m_numPaths, batch.m_device.c_str(), (long long) elapsed.count());
+        }
+        std::string ajSoftwareVersion = m_ajSoftwareVersion;
+        lock.unlock();
+        std::lock_guard<std::mutex> introspectionLock(m_introspectionMutex);
+        SetIntrospectionData(m_bus, ajSoftwareVersion.c_str(), "TITLE", "VERSION");
+        ::RDPublish();
+    }
+    PROBE1(bridge_process_end, this);
     return true;
 }
 
+/* Called with m_mutex held. */
+void Bridge::UpdateMetrics()
+{
+    time_t now = time(NULL);
+    if (now == m_metricsTick)
+    {
+        return;
+    }
+    m_metricsTick = now;
+    sSecureConnectionGauges.Set(m_secureConnections);
+    sPingRate.Set(llround(m_ajPresence->GetPingRate() * 60));
+    if (m_entityHandlers)
+    {
+        sEntityHandlerGauges.Set(m_entityHandlers);
+    }
+}
+
 void Bridge::BusDisconnected()
 {
     LOG(LOG_INFO, "[%p]", this);
-    std::lock_guard<std::mutex> lock(m_mutex);
+    MeteredLock lock(m_mutex, sLockWait);
     std::set<std::string> ids;
     for (VirtualResource *resource : m_virtualResources)
     {
@@ -549,6 +825,7 @@ void Bridge::BusDisconnected()
     for (const std::string &id : ids)
     {
         LOG(LOG_INFO, "[%p] %s absent", this, id.c_str());
+        PROBE1(presence_absent, id.c_str());
         Destroy(id.c_str());
     }
     m_ajState = STARTED;
@@ -584,8 +861,9 @@ public:
     AnnouncedContext(Bridge *bridge, VirtualDevice *device, const char *name, ajn::SessionPort port,
             const ajn::MsgArg &objectDescriptionArg, const ajn::MsgArg &aboutDataArg)
         : m_bridge(bridge), m_device(device), m_name(name), m_port(port),
-          m_objectDescriptionArg(objectDescriptionArg), m_aboutData(aboutDataArg), m_sessionId(0),
-          m_isSecure(false), m_aboutObj(NULL) { }
+          m_objectDescriptionArg(objectDescriptionArg), m_aboutData(aboutDataArg),
+          m_pendingLangs(0), m_sessionId(0), m_isSecure(false), m_aboutObj(NULL),
+          m_announced(std::chrono::steady_clock::now()) { }
     ~AnnouncedContext() { delete m_aboutObj; }
     Bridge *m_bridge;
     ajn::BusAttachment *m_bus;
@@ -593,12 +871,26 @@ public:
     std::string m_name;
     ajn::SessionPort m_port;
     ajn::MsgArg m_objectDescriptionArg;
+    /*
+     * Guards m_aboutData while the replies for the other languages are merged into it, so that
+     * merging does not need Bridge::m_mutex.
+     */
+    std::mutex m_mutex;
     ajn::AboutData m_aboutData;
-    std::vector<std::string> m_langs;
-    std::vector<std::string>::iterator m_lang;
+    /* The context of each outstanding GetAboutData call for a non-default language */
+    struct LocalizedRequest
+    {
+        AnnouncedContext *m_context;
+        std::string m_lang;
+        LocalizedRequest(AnnouncedContext *context, const char *lang)
+            : m_context(context), m_lang(lang) { }
+    };
+    std::vector<LocalizedRequest> m_langs;
+    size_t m_pendingLangs;
     ajn::SessionId m_sessionId;
     bool m_isSecure;
     ajn::ProxyBusObject *m_aboutObj;
+    std::chrono::steady_clock::time_point m_announced;
 };
 
 void Bridge::Announced(const char *name, uint16_t version, ajn::SessionPort port,
@@ -612,17 +904,32 @@ void Bridge::Announced(const char *name, uint16_t version, ajn::SessionPort port
             name, version, port, objectDescriptionArg.ToString().c_str(),
             aboutDataArg.ToString().c_str());
 
-    m_mutex.lock();
+    /* Parsing the About data only touches the new context, so is done before taking m_mutex */
+    context = new AnnouncedContext(this, NULL, name, port, objectDescriptionArg, aboutDataArg);
+
+    MeteredLock lock(m_mutex, sLockWait);
     /* Ignore Announce from self */
     for (VirtualBusAttachment *busAttachment : m_virtualBusAttachments)
     {
         if (busAttachment->GetUniqueName() == name)
         {
-            m_mutex.unlock();
+            lock.unlock();
+            delete context;
             return;
         }
     }
 
+    sAnnounced.Increment();
+
+    /* An Announce is as good as a ping */
+    for (Presence *presence : m_presence)
+    {
+        if (presence->GetId() == name)
+        {
+            presence->Seen();
+        }
+    }
+
     /* Check if we've seen this Announce before */
     VirtualDevice *device = NULL;
     for (std::vector<VirtualDevice *>::iterator it = m_virtualDevices.begin();
@@ -635,11 +942,11 @@ void Bridge::Announced(const char *name, uint16_t version, ajn::SessionPort port
         }
     }
 
-    context = new AnnouncedContext(this, device, name, port, objectDescriptionArg, aboutDataArg);
+    context->m_device = device;
     if (device)
     {
         LOG(LOG_INFO, "[%p] Received updated Announce", this);
-        m_mutex.unlock();
+        lock.unlock();
         JoinSessionCB(ER_OK, device->GetSessionId(), opts, context);
     }
     else
@@ -650,7 +957,6 @@ void Bridge::Announced(const char *name, uint16_t version, ajn::SessionPort port
             LOG(LOG_ERR, "JoinSessionAsync - %s", QCC_StatusText(status));
             delete context;
         }
-        m_mutex.unlock();
     }
 }
 
@@ -661,7 +967,7 @@ void Bridge::JoinSessionCB(QStatus status, ajn::SessionId sessionId, const ajn::
     LOG(LOG_INFO, "[%p] status=%s,sessionId=%d,ctx=%p", this, QCC_StatusText(status), sessionId,
             ctx);
 
-    std::lock_guard<std::mutex> lock(m_mutex);
+    MeteredLock lock(m_mutex, sLockWait);
     AnnouncedContext *context = reinterpret_cast<AnnouncedContext *>(ctx);
     if (status != ER_OK)
     {
@@ -670,21 +976,51 @@ void Bridge::JoinSessionCB(QStatus status, ajn::SessionId sessionId, const ajn::
     }
     else
     {
+        sSessionsJoined.Increment();
         context->m_sessionId = sessionId;
+        QueueSecureConnection(context);
+    }
+}
 
-        /* BusAttachment::SecureConnectionAsync is not really usable (no means to pass context). */
-        ++m_pending;
-        std::thread(Bridge::SecureConnection, this, context->m_name.c_str(), ctx).detach();
+/* Called with m_mutex held. */
+void Bridge::QueueSecureConnection(AnnouncedContext *context)
+{
+    /*
+     * BusAttachment::SecureConnectionAsync is not really usable (no means to pass context), so
+     * the blocking call is made from a bounded pool of threads.  Devices that have connected
+     * securely before are handled first.
+     */
+    char piid[UUID_STRING_SIZE];
+    GetProtocolIndependentId(piid, &context->m_aboutData, NULL);
+    WorkerPool::Priority priority = (m_securePiids.find(piid) != m_securePiids.end()) ?
+            WorkerPool::HIGH : WorkerPool::LOW;
+    ++m_pending;
+    sPending.Increment();
+    if (!m_secureConnections->Post(std::bind(Bridge::SecureConnection, this,
+            context->m_name.c_str(), context), priority))
+    {
+        --m_pending;
+        sPending.Decrement();
+        LOG(LOG_INFO, "[%p] Secure connection queue full (depth=%zu), retrying %s", this,
+                m_secureConnections->GetQueueDepth(), context->m_name.c_str());
+        m_tasks.push_back(new SecureConnectionTask(time(NULL) + 1, context));
     }
 }
 
+/* Called with m_mutex held. */
+void Bridge::SecureConnectionTask::Run(Bridge *thiz)
+{
+    thiz->QueueSecureConnection(m_context);
+}
+
 void Bridge::SecureConnection(Bridge *thiz, const char *name, void *ctx)
 {
     QStatus status = thiz->m_bus->SecureConnection(name);
     thiz->SecureConnectionCB(status, ctx);
     {
-        std::lock_guard<std::mutex> lock(thiz->m_mutex);
+        MeteredLock lock(thiz->m_mutex, sLockWait);
         --thiz->m_pending;
+        sPending.Decrement();
         thiz->m_cond.notify_one();
     }
 }
@@ -693,9 +1029,15 @@ void Bridge::SecureConnectionCB(QStatus status, void *ctx)
 {
     LOG(LOG_INFO, "[%p] status=%s,ctx=%p", this, QCC_StatusText(status), ctx);
 
-    std::lock_guard<std::mutex> lock(m_mutex);
+    MeteredLock lock(m_mutex, sLockWait);
     AnnouncedContext *context = reinterpret_cast<AnnouncedContext *>(ctx);
     context->m_isSecure = (status == ER_OK);
+    if (context->m_isSecure)
+    {
+        char piid[UUID_STRING_SIZE];
+        GetProtocolIndependentId(piid, &context->m_aboutData, NULL);
+        m_securePiids.insert(piid);
+    }
 
     if (m_secureMode->GetSecureMode() && (status != ER_OK))
     {
@@ -797,128 +1139,93 @@ VirtualResource *Bridge::CreateVirtualResource(ajn::BusAttachment *bus, const ch
     if (!strcmp(path, "/Config"))
     {
         VirtualConfigurationResource *resource = VirtualConfigurationResource::Create(bus, name,
-                sessionId, ajSoftwareVersion, RDPublish, this);
+                sessionId, ajSoftwareVersion, ResourceCreatedCB, this);
         resource->SetAboutData(aboutData);
         return resource;
     }
     else
     {
-        return VirtualResource::Create(bus, name, sessionId, path, ajSoftwareVersion, RDPublish,
-                this);
+        return VirtualResource::Create(bus, name, sessionId, path, ajSoftwareVersion,
+                ResourceCreatedCB, this, m_entityHandlers);
     }
 }
 
+/*
+ * Called with m_mutex held.  Process() encodes the introspection data from the OC resources
+ * without m_mutex, so the OC resources are deleted under m_introspectionMutex.
+ */
+void Bridge::DeleteVirtualResource(VirtualResource *resource)
+{
+    m_pendingCreates->Removed(resource);
+    std::lock_guard<std::mutex> introspectionLock(m_introspectionMutex);
+    delete resource;
+}
+
 void Bridge::GetAboutDataCB(ajn::Message &msg, void *ctx)
 {
     LOG(LOG_INFO, "[%p]", this);
 
-    std::lock_guard<std::mutex> lock(m_mutex);
     AnnouncedContext *context = reinterpret_cast<AnnouncedContext *>(ctx);
+    ajn::AboutData aboutData;
     if (msg->GetType() == ajn::MESSAGE_METHOD_RET)
     {
-        ajn::AboutData aboutData(*msg->GetArg(0));
-        if (context->m_langs.empty())
-        {
-            context->m_aboutData = aboutData;
+        aboutData.CreatefromMsgArg(*msg->GetArg(0));
+    }
 
-            char *lang = NULL;
-            aboutData.GetDefaultLanguage(&lang);
-            context->m_langs.push_back(lang);
-            size_t numLangs = aboutData.GetSupportedLanguages();
-            const char **langs = new const char *[numLangs];
-            aboutData.GetSupportedLanguages(langs, numLangs);
-            for (size_t i = 0; i < numLangs; ++i)
-            {
-                if (strcmp(lang, langs[i]))
-                {
-                    context->m_langs.push_back(langs[i]);
-                }
-            }
-            delete[] langs;
-            context->m_lang = context->m_langs.begin();
+    MeteredLock lock(m_mutex, sLockWait);
+    if (msg->GetType() == ajn::MESSAGE_METHOD_RET)
+    {
+        context->m_aboutData = aboutData;
 
-            char *ajSoftwareVersion = NULL;
-            QStatus status = aboutData.GetAJSoftwareVersion(&ajSoftwareVersion);
-            LOG(LOG_INFO, "[%p] %s AJSoftwareVersion=%s", this, QCC_StatusText(status),
-                    ajSoftwareVersion ? ajSoftwareVersion : "unknown");
-            m_ajSoftwareVersion = ajSoftwareVersion;
-        }
-        else
+        char *lang = NULL;
+        aboutData.GetDefaultLanguage(&lang);
+        context->m_langs.clear();
+        size_t numLangs = aboutData.GetSupportedLanguages();
+        const char **langs = new const char *[numLangs];
+        aboutData.GetSupportedLanguages(langs, numLangs);
+        for (size_t i = 0; i < numLangs; ++i)
         {
-            const char *lang = context->m_lang->c_str();
-            context->m_aboutData.CreatefromMsgArg(*msg->GetArg(0), lang);
-        }
-        if (++context->m_lang != context->m_langs.end())
-        {
-            ajn::MsgArg arg("s", context->m_lang->c_str());
-            QStatus status = context->m_aboutObj->MethodCallAsync(
-                ::ajn::org::alljoyn::About::InterfaceName, "GetAboutData",
-                this, static_cast<ajn::MessageReceiver::ReplyHandler>(&Bridge::GetAboutDataCB),
-                &arg, 1, context);
-            if (status != ER_OK)
+            if (strcmp(lang, langs[i]))
             {
-                LOG(LOG_ERR, "MethodCallAsync - %s", QCC_StatusText(status));
-                delete context;
+                context->m_langs.push_back(AnnouncedContext::LocalizedRequest(context, langs[i]));
             }
         }
-        else
-        {
-            if (!context->m_device)
-            {
-                context->m_device = new VirtualDevice(m_bus, msg->GetSender(), msg->GetSessionId());
-                m_virtualDevices.push_back(context->m_device);
-                Presence *presence = new AllJoynPresence(m_bus, context->m_name);
-                m_presence.push_back(presence);
-            }
+        delete[] langs;
 
-            ajn::AboutObjectDescription objectDescription(context->m_objectDescriptionArg);
-            context->m_device->SetProperties(&objectDescription, &context->m_aboutData,
-                    context->m_isSecure);
+        char *ajSoftwareVersion = NULL;
+        QStatus status = aboutData.GetAJSoftwareVersion(&ajSoftwareVersion);
+        LOG(LOG_INFO, "[%p] %s AJSoftwareVersion=%s", this, QCC_StatusText(status),
+                ajSoftwareVersion ? ajSoftwareVersion : "unknown");
+        m_ajSoftwareVersion = ajSoftwareVersion;
 
-            size_t n = objectDescription.GetPaths(NULL, 0);
-            const char **pa = new const char *[n];
-            objectDescription.GetPaths(pa, n);
-            std::vector<const char *> pb;
-            for (VirtualResource *resource : m_virtualResources)
-            {
-                if (resource->GetUniqueName() == context->m_name.c_str())
-                {
-                    pb.push_back(resource->GetPath().c_str());
-                }
-            }
-            std::sort(pb.begin(), pb.end(), ComparePath);
-            std::vector<const char *> remove;
-            std::set_difference(pb.begin(), pb.end(), pa, pa + n,
-                    std::inserter(remove, remove.begin()), ComparePath);
-            for (size_t i = 0; i < remove.size(); ++i)
+        /*
+         * The other languages are requested concurrently; m_langs is not modified again until
+         * all the replies have been received.  A language that fails is left out.
+         */
+        context->m_pendingLangs = 0;
+        for (AnnouncedContext::LocalizedRequest &request : context->m_langs)
+        {
+            ajn::MsgArg arg("s", request.m_lang.c_str());
+            status = context->m_aboutObj->MethodCallAsync(
+                ::ajn::org::alljoyn::About::InterfaceName, "GetAboutData",
+                this, static_cast<ajn::MessageReceiver::ReplyHandler>(
+                    &Bridge::GetLocalizedAboutDataCB), &arg, 1, &request);
+            if (status == ER_OK)
             {
-                for (std::vector<VirtualResource *>::iterator vr = m_virtualResources.begin();
-                     vr != m_virtualResources.end(); ++vr)
-                {
-                    VirtualResource *resource = *vr;
-                    if (resource->GetUniqueName() == context->m_name.c_str() &&
-                            resource->GetPath() == remove[i])
-                    {
-                        delete resource;
-                        m_virtualResources.erase(vr);
-                        break;
-                    }
-                }
+                ++context->m_pendingLangs;
             }
-            std::vector<const char *> add;
-            std::set_difference(pa, pa + n, pb.begin(), pb.end(),
-                    std::inserter(add, add.begin()), ComparePath);
-            for (size_t i = 0; i < add.size(); ++i)
+            else
             {
-                VirtualResource *resource = CreateVirtualResource(m_bus, context->m_name.c_str(),
-                        msg->GetSessionId(), add[i], m_ajSoftwareVersion.c_str(),
-                        &context->m_aboutData);
-                if (resource)
-                {
-                    m_virtualResources.push_back(resource);
-                }
+                LOG(LOG_ERR, "MethodCallAsync - %s", QCC_StatusText(status));
             }
-            delete[] pa;
+        }
+        if (!context->m_pendingLangs || m_isAboutLanguageLazy)
+        {
+            std::lock_guard<std::mutex> contextLock(context->m_mutex);
+            CreateVirtualObjects(context);
+        }
+        if (!context->m_pendingLangs)
+        {
             delete context;
         }
     }
@@ -935,6 +1242,133 @@ void Bridge::GetAboutDataCB(ajn::Message &msg, void *ctx)
     }
 }
 
+void Bridge::GetLocalizedAboutDataCB(ajn::Message &msg, void *ctx)
+{
+    LOG(LOG_INFO, "[%p]", this);
+
+    AnnouncedContext::LocalizedRequest *request =
+            reinterpret_cast<AnnouncedContext::LocalizedRequest *>(ctx);
+    AnnouncedContext *context = request->m_context;
+    if (msg->GetType() == ajn::MESSAGE_METHOD_RET)
+    {
+        std::lock_guard<std::mutex> contextLock(context->m_mutex);
+        context->m_aboutData.CreatefromMsgArg(*msg->GetArg(0), request->m_lang.c_str());
+    }
+
+    MeteredLock lock(m_mutex, sLockWait);
+    else if (msg->GetType() == ajn::MESSAGE_ERROR)
+    {
+        qcc::String message;
+        const char *name = msg->GetErrorName(&message);
+        LOG(LOG_ERR, "%s: %s lang=%s", name, message.c_str(), request->m_lang.c_str());
+    }
+    if (--context->m_pendingLangs)
+    {
+        return;
+    }
+    if (m_isAboutLanguageLazy)
+    {
+        UpdateAboutData(context);
+    }
+    else
+    {
+        CreateVirtualObjects(context);
+    }
+    delete context;
+}
+
+/* Called with m_mutex held. */
+void Bridge::CreateVirtualObjects(AnnouncedContext *context)
+{
+    if (!context->m_device)
+    {
+        context->m_device = new VirtualDevice(m_bus, context->m_name.c_str(),
+                context->m_sessionId);
+        m_virtualDevices.push_back(context->m_device);
+        Presence *presence = new AllJoynPresence(m_ajPresence, context->m_name);
+        m_presence.push_back(presence);
+        PROBE1(presence_added, context->m_name.c_str());
+    }
+
+    ajn::AboutObjectDescription objectDescription(context->m_objectDescriptionArg);
+    context->m_device->SetProperties(&objectDescription, &context->m_aboutData,
+            context->m_isSecure);
+
+    size_t n = objectDescription.GetPaths(NULL, 0);
+    const char **pa = new const char *[n];
+    objectDescription.GetPaths(pa, n);
+    std::vector<const char *> pb;
+    for (VirtualResource *resource : m_virtualResources)
+    {
+        if (resource->GetUniqueName() == context->m_name.c_str())
+        {
+            pb.push_back(resource->GetPath().c_str());
+        }
+    }
+    std::sort(pb.begin(), pb.end(), ComparePath);
+    std::vector<const char *> remove;
+    std::set_difference(pb.begin(), pb.end(), pa, pa + n,
+            std::inserter(remove, remove.begin()), ComparePath);
+    for (size_t i = 0; i < remove.size(); ++i)
+    {
+        for (std::vector<VirtualResource *>::iterator vr = m_virtualResources.begin();
+             vr != m_virtualResources.end(); ++vr)
+        {
+            VirtualResource *resource = *vr;
+            if (resource->GetUniqueName() == context->m_name.c_str() &&
+                    resource->GetPath() == remove[i])
+            {
+                DeleteVirtualResource(resource);
+                m_virtualResources.erase(vr);
+                ScheduleRDPublish(1);
+                break;
+            }
+        }
+    }
+    std::vector<const char *> add;
+    std::set_difference(pa, pa + n, pb.begin(), pb.end(),
+            std::inserter(add, add.begin()), ComparePath);
+    for (size_t i = 0; i < add.size(); ++i)
+    {
+        VirtualResource *resource = CreateVirtualResource(m_bus, context->m_name.c_str(),
+                context->m_sessionId, add[i], m_ajSoftwareVersion.c_str(),
+                &context->m_aboutData);
+        if (resource)
+        {
+            m_virtualResources.push_back(resource);
+            m_pendingCreates->Add(context->m_name, resource, context->m_announced);
+        }
+    }
+    delete[] pa;
+}
+
+/*
+ * Called with m_mutex held.  The virtual objects created from the default language About data
+ * are updated with the other languages.  The device may have gone away in the meantime, so it is
+ * looked up again by name.
+ */
+void Bridge::UpdateAboutData(AnnouncedContext *context)
+{
+    ajn::AboutObjectDescription objectDescription(context->m_objectDescriptionArg);
+    for (VirtualDevice *device : m_virtualDevices)
+    {
+        if (device->GetName() == context->m_name)
+        {
+            device->SetProperties(&objectDescription, &context->m_aboutData, context->m_isSecure);
+        }
+    }
+    for (VirtualResource *resource : m_virtualResources)
+    {
+        if (resource->GetUniqueName() == context->m_name.c_str() &&
+                resource->GetPath() == "/Config")
+        {
+            VirtualConfigurationResource *config =
+                    static_cast<VirtualConfigurationResource *>(resource);
+            config->SetAboutData(&context->m_aboutData);
+        }
+    }
+}
+
 void Bridge::InsecureLeaveSessionCB::LeaveSessionCB(QStatus status, void *ctx)
 {
     LOG(LOG_INFO, "[%p] status=%s,ctx=%p", this, QCC_StatusText(status), ctx);
@@ -950,7 +1384,7 @@ void Bridge::State(const char* busName, const qcc::KeyInfoNISTP256& publicKeyInf
     (void) publicKeyInfo;
     LOG(LOG_INFO, "[%p] busName=%s,state=%d", this, busName, state);
 
-    std::lock_guard<std::mutex> lock(m_mutex);
+    MeteredLock lock(m_mutex, sLockWait);
     if (state != ajn::PermissionConfigurator::CLAIMED)
     {
         return;
@@ -990,7 +1424,7 @@ void Bridge::SessionLost(ajn::SessionId sessionId, ajn::SessionListener::Session
 {
     LOG(LOG_INFO, "[%p] sessionId=%d,reason=%d", this, sessionId, reason);
 
-    std::lock_guard<std::mutex> lock(m_mutex);
+    MeteredLock lock(m_mutex, sLockWait);
     for (VirtualDevice *device : m_virtualDevices)
     {
         if (device->GetSessionId() == sessionId)
@@ -1026,7 +1460,8 @@ bool Bridge::HasSeenBefore(const OCDiscoveryPayload *payload)
 {
     for (VirtualBusAttachment *b : m_virtualBusAttachments)
     {
-        if (b->GetDi() == payload->sid)
+        /* Restored devices are rediscovered to revalidate them */
+        if ((b->GetDi() == payload->sid) && !m_unverified.count(b->GetDi()))
         {
             return true;
         }
@@ -1038,6 +1473,13 @@ bool Bridge::HasSeenBefore(const OCDiscoveryPayload *payload)
             return true;
         }
     }
+    for (DiscoverContext *context : m_parsing)
+    {
+        if (context->m_device.m_di == payload->sid)
+        {
+            return true;
+        }
+    }
     return false;
 }
 
@@ -1152,7 +1594,47 @@ OCStackApplicationResult Bridge::DiscoverCB(void *ctx, OCDoHandle handle,
     (void) handle;
     Bridge *thiz = reinterpret_cast<Bridge *>(ctx);
 
-    std::lock_guard<std::mutex> lock(thiz->m_mutex);
+    MeteredLock lock(thiz->m_mutex, sLockWait);
+    if (!response || response->result != OC_STACK_OK)
+    {
+        goto exit;
+    }
+    OCDiscoveryPayload *payload;
+    for (payload = (OCDiscoveryPayload *) response->payload; payload; payload = payload->next)
+    {
+        OCDoHandle deviceHandle;
+        OCStackResult result;
+        bool isProbing = false;
+        thiz->m_discoveryScheduler->Responded();
+        thiz->UpdatePresenceStatus(payload);
+        sDiscovered.Increment();
+        for (auto &p : thiz->m_probing)
+        {
+            isProbing = isProbing || (p.second == payload->sid);
+        }
+        if (thiz->IsSelf(payload) || thiz->HasSeenBefore(payload) || isProbing)
+        {
+            continue;
+        }
+        result = thiz->DoResource(&deviceHandle, OC_REST_DISCOVER, OC_RSRVD_WELL_KNOWN_URI,
+                &response->devAddr, Bridge::DiscoverDeviceCB);
+        if (result == OC_STACK_OK)
+        {
+            thiz->m_probing[deviceHandle] = payload->sid;
+        }
+    }
+
+exit:
+    return OC_STACK_KEEP_TRANSACTION;
+}
+
+OCStackApplicationResult Bridge::DiscoverDeviceCB(void *ctx, OCDoHandle handle,
+        OCClientResponse *response)
+{
+    Bridge *thiz = reinterpret_cast<Bridge *>(ctx);
+
+    MeteredLock lock(thiz->m_mutex, sLockWait);
+    thiz->m_probing.erase(handle);
     if (!response || response->result != OC_STACK_OK)
     {
         goto exit;
@@ -1178,6 +1660,8 @@ OCStackApplicationResult Bridge::DiscoverCB(void *ctx, OCDoHandle handle,
                 context->GetDevAddrs(OC_RSRVD_DEVICE_URI), Bridge::GetDeviceCB);
         if (result == OC_STACK_OK)
         {
+            sProbed.Increment();
+            thiz->m_discoveryScheduler->Changed(time(NULL));
             context = NULL;
         }
     next:
@@ -1185,7 +1669,7 @@ OCStackApplicationResult Bridge::DiscoverCB(void *ctx, OCDoHandle handle,
     }
 
 exit:
-    return OC_STACK_KEEP_TRANSACTION;
+    return OC_STACK_DELETE_TRANSACTION;
 }
 
 OCStackApplicationResult Bridge::GetDeviceCB(void *ctx, OCDoHandle handle,
@@ -1194,10 +1678,11 @@ OCStackApplicationResult Bridge::GetDeviceCB(void *ctx, OCDoHandle handle,
     Bridge *thiz = reinterpret_cast<Bridge *>(ctx);
     LOG(LOG_INFO, "[%p]", thiz);
 
-    std::lock_guard<std::mutex> lock(thiz->m_mutex);
+    MeteredLock lock(thiz->m_mutex, sLockWait);
     OCStackResult result;
     bool isVirtual;
     char *piid = NULL;
+    char *dmv = NULL;
     DiscoverContext *context;
     OCRepPayload *payload;
     thiz->GetContextAndRepPayload(handle, response, &context, &payload);
@@ -1206,7 +1691,23 @@ OCStackApplicationResult Bridge::GetDeviceCB(void *ctx, OCDoHandle handle,
         goto exit;
     }
     OCRepPayloadGetPropString(payload, OC_RSRVD_PROTOCOL_INDEPENDENT_ID, &piid);
+    OCRepPayloadGetPropString(payload, OC_RSRVD_DATA_MODEL_VERSION, &dmv);
+    if (piid)
+    {
+        context->m_piid = piid;
+    }
+    if (dmv)
+    {
+        context->m_dmv = dmv;
+    }
     isVirtual = context->m_device.IsVirtual();
+    if (thiz->m_unverified.count(context->m_device.m_di))
+    {
+        /* The restored virtual objects are kept unless the device has changed */
+        LOG(LOG_INFO, "[%p] Revalidating %s", thiz, context->m_device.m_di.c_str());
+        context->m_isRevalidating = true;
+        goto revalidate;
+    }
     switch (thiz->GetSeenState(piid))
     {
         case NOT_SEEN:
@@ -1215,6 +1716,8 @@ OCStackApplicationResult Bridge::GetDeviceCB(void *ctx, OCDoHandle handle,
                 /* Delay creating virtual objects from a virtual device */
                 LOG(LOG_INFO, "[%p] Delaying creation of virtual objects from a virtual device",
                         thiz);
+                /* The task takes the payload from the response instead of cloning it */
+                response->payload = NULL;
                 thiz->m_tasks.push_back(new DiscoverTask(time(NULL) + 10, piid, payload, context));
                 context = NULL;
                 goto exit;
@@ -1245,7 +1748,8 @@ OCStackApplicationResult Bridge::GetDeviceCB(void *ctx, OCDoHandle handle,
     {
         goto exit;
     }
-    context->m_bus->SetAboutData(payload);
+revalidate:
+    context->SetAboutData(payload);
     result = thiz->ContinueDiscovery(context, OC_RSRVD_PLATFORM_URI,
             context->GetDevAddrs(OC_RSRVD_PLATFORM_URI), Bridge::GetPlatformCB);
     if (result == OC_STACK_OK)
@@ -1254,6 +1758,7 @@ OCStackApplicationResult Bridge::GetDeviceCB(void *ctx, OCDoHandle handle,
     }
 
 exit:
+    OICFree(dmv);
     OICFree(piid);
     delete context;
     thiz->m_discovered.erase(handle);
@@ -1266,7 +1771,7 @@ OCStackApplicationResult Bridge::GetPlatformCB(void *ctx, OCDoHandle handle,
     Bridge *thiz = reinterpret_cast<Bridge *>(ctx);
     LOG(LOG_INFO, "[%p]", thiz);
 
-    std::lock_guard<std::mutex> lock(thiz->m_mutex);
+    MeteredLock lock(thiz->m_mutex, sLockWait);
     OCStackResult result = OC_STACK_OK;
     DiscoverContext *context;
     OCRepPayload *payload;
@@ -1276,7 +1781,7 @@ OCStackApplicationResult Bridge::GetPlatformCB(void *ctx, OCDoHandle handle,
     {
         goto exit;
     }
-    context->m_bus->SetAboutData(payload);
+    context->SetAboutData(payload);
 
     resource = context->m_device.GetResourceType(OC_RSRVD_RESOURCE_TYPE_DEVICE_CONFIGURATION);
     if (resource)
@@ -1305,7 +1810,7 @@ OCStackApplicationResult Bridge::GetDeviceConfigurationCB(void *ctx, OCDoHandle
     Bridge *thiz = reinterpret_cast<Bridge *>(ctx);
     LOG(LOG_INFO, "[%p]", thiz);
 
-    std::lock_guard<std::mutex> lock(thiz->m_mutex);
+    MeteredLock lock(thiz->m_mutex, sLockWait);
     OCStackResult result = OC_STACK_OK;
     DiscoverContext *context;
     OCRepPayload *payload;
@@ -1314,7 +1819,7 @@ OCStackApplicationResult Bridge::GetDeviceConfigurationCB(void *ctx, OCDoHandle
     {
         goto exit;
     }
-    context->m_bus->SetAboutData(payload);
+    context->SetAboutData(payload);
 
     result = thiz->GetPlatformConfiguration(context);
     if (result == OC_STACK_OK)
@@ -1351,7 +1856,7 @@ OCStackApplicationResult Bridge::GetPlatformConfigurationCB(void *ctx, OCDoHandl
     Bridge *thiz = reinterpret_cast<Bridge *>(ctx);
     LOG(LOG_INFO, "[%p]", thiz);
 
-    std::lock_guard<std::mutex> lock(thiz->m_mutex);
+    MeteredLock lock(thiz->m_mutex, sLockWait);
     OCStackResult result = OC_STACK_OK;
     DiscoverContext *context;
     OCRepPayload *payload;
@@ -1360,7 +1865,7 @@ OCStackApplicationResult Bridge::GetPlatformConfigurationCB(void *ctx, OCDoHandl
     {
         goto exit;
     }
-    context->m_bus->SetAboutData(payload);
+    context->SetAboutData(payload);
 
     result = thiz->GetCollection(context);
     if (result == OC_STACK_OK)
@@ -1407,7 +1912,7 @@ OCStackApplicationResult Bridge::GetCollectionCB(void *ctx, OCDoHandle handle,
     Bridge *thiz = reinterpret_cast<Bridge *>(ctx);
     LOG(LOG_INFO, "[%p]", thiz);
 
-    std::lock_guard<std::mutex> lock(thiz->m_mutex);
+    MeteredLock lock(thiz->m_mutex, sLockWait);
     OCStackResult result = OC_STACK_OK;
     DiscoverContext *context;
     OCRepPayload *payload;
@@ -1450,6 +1955,28 @@ OCStackResult Bridge::GetIntrospection(DiscoverContext *context)
 {
     OCStackResult result = OC_STACK_OK;
     Resource *resource;
+    ModelCache::Model model;
+    context->m_fingerprint = ModelCache::GetFingerprint(context->m_dmv.c_str(),
+            context->m_device.m_resources);
+    if (!context->m_isModelRejected)
+    {
+        model = m_modelCache->Get(context->m_fingerprint);
+    }
+    if (model && ModelCache::Matches(model.get(), context->m_device.m_resources))
+    {
+        /* Parsed by Process() since m_mutex is released while parsing */
+        LOG(LOG_INFO, "[%p] Using cached model for %s", this, context->m_device.m_di.c_str());
+        context->m_model = model;
+        m_parsing.insert(context);
+        m_modelHits.push_back(context);
+        return result;
+    }
+    else if (model)
+    {
+        LOG(LOG_INFO, "[%p] Cached model does not match %s", this,
+                context->m_device.m_di.c_str());
+        m_modelCache->Erase(context->m_fingerprint);
+    }
     resource = context->m_device.GetResourceType(OC_RSRVD_RESOURCE_TYPE_INTROSPECTION);
     if (resource)
     {
@@ -1479,7 +2006,7 @@ OCStackApplicationResult Bridge::GetIntrospectionCB(void *ctx, OCDoHandle handle
     Bridge *thiz = reinterpret_cast<Bridge *>(ctx);
     LOG(LOG_INFO, "[%p]", thiz);
 
-    std::lock_guard<std::mutex> lock(thiz->m_mutex);
+    MeteredLock lock(thiz->m_mutex, sLockWait);
     OCStackResult result = OC_STACK_ERROR;
     char *url = NULL;
     char *protocol = NULL;
@@ -1567,7 +2094,7 @@ OCStackApplicationResult Bridge::GetIntrospectionDataCB(void *ctx, OCDoHandle ha
     Bridge *thiz = reinterpret_cast<Bridge *>(ctx);
     LOG(LOG_INFO, "[%p]", thiz);
 
-    std::lock_guard<std::mutex> lock(thiz->m_mutex);
+    MeteredLock lock(thiz->m_mutex, sLockWait);
     OCStackResult result = OC_STACK_ERROR;
     DiscoverContext *context;
     OCRepPayload *payload;
@@ -1577,13 +2104,15 @@ OCStackApplicationResult Bridge::GetIntrospectionDataCB(void *ctx, OCDoHandle ha
     {
         goto exit;
     }
-    if (thiz->ParseIntrospectionPayload(context, payload))
+    thiz->m_discovered.erase(handle);
+    if (thiz->ParseIntrospectionPayload(context, payload, lock))
     {
+        sIntrospected.Increment();
         result = OC_STACK_OK;
     }
 
 exit:
-    if (context && (result != OC_STACK_OK))
+    if (context && !context->m_isDestroyed && (result != OC_STACK_OK))
     {
         context->m_paths = OCRepPayloadCreate();
         context->m_definitions = OCRepPayloadCreate();
@@ -1611,7 +2140,7 @@ OCStackApplicationResult Bridge::GetCB(void *ctx, OCDoHandle handle,
     Bridge *thiz = reinterpret_cast<Bridge *>(ctx);
     LOG(LOG_INFO, "[%p]", thiz);
 
-    std::lock_guard<std::mutex> lock(thiz->m_mutex);
+    MeteredLock lock(thiz->m_mutex, sLockWait);
     DiscoverContext *context;
     OCRepPayload *payload;
     bool found;
@@ -1703,7 +2232,8 @@ OCStackApplicationResult Bridge::GetCB(void *ctx, OCDoHandle handle,
             goto exit;
         }
         context->m_definitions = NULL;
-        thiz->ParseIntrospectionPayload(context, outPayload);
+        thiz->m_discovered.erase(handle);
+        thiz->ParseIntrospectionPayload(context, outPayload, lock);
     }
 
 exit:
@@ -1715,20 +2245,94 @@ exit:
     return OC_STACK_DELETE_TRANSACTION;
 }
 
-bool Bridge::ParseIntrospectionPayload(DiscoverContext *context, OCRepPayload *payload)
+/*
+ * Called with m_mutex held and context removed from m_discovered.  Creating the AJ interfaces and
+ * objects only touches context, so m_mutex is released while doing so.  Returns with m_mutex
+ * held; the caller must delete context if it was destroyed in the meantime.
+ */
+bool Bridge::ParseIntrospectionPayload(DiscoverContext *context, OCRepPayload *payload,
+        std::unique_lock<std::mutex> &lock)
 {
     OCPresence *presence = NULL;
-    bool success = ::ParseIntrospectionPayload(&context->m_device, context->m_bus, payload);
+    OCRepPayload *snapshot = NULL;
+    bool success;
+    if (context->m_isRevalidating)
+    {
+        std::string di = context->m_device.m_di;
+        context->m_isRevalidating = false;
+        m_unverified.erase(di);
+        snapshot = DeviceSnapshots::Create(context->m_device, context->m_piid.c_str(),
+                context->m_dmv.c_str(), context->m_aboutData, payload);
+        if (m_snapshots->Matches(di, snapshot))
+        {
+            LOG(LOG_INFO, "[%p] Restored %s is current", this, di.c_str());
+            OCRepPayloadDestroy(snapshot);
+            return true;
+        }
+        LOG(LOG_INFO, "[%p] Restored %s has changed, recreating", this, di.c_str());
+        Destroy(di.c_str());
+        context->m_bus = VirtualBusAttachment::Create(di.c_str(), context->m_piid.c_str(),
+                context->m_device.IsVirtual());
+        if (!context->m_bus)
+        {
+            /* Keeps the caller from retrying without a bus attachment */
+            context->m_isDestroyed = true;
+            OCRepPayloadDestroy(snapshot);
+            return false;
+        }
+        for (OCRepPayload *aboutData : context->m_aboutData)
+        {
+            context->m_bus->SetAboutData(aboutData);
+        }
+    }
+    m_parsing.insert(context);
+    ++m_pending;
+    sPending.Increment();
+    lock.unlock();
+    success = ::ParseIntrospectionPayload(&context->m_device, context->m_bus, payload);
+    if (success && !context->m_model)
+    {
+        m_modelCache->Put(context->m_fingerprint, payload);
+        if (m_isModelCachePersistent)
+        {
+            m_modelCache->Save(MODEL_CACHE_FILE_NAME);
+        }
+    }
+    if (success && m_isSnapshotPersistent && !context->m_isRestored)
+    {
+        if (!snapshot)
+        {
+            snapshot = DeviceSnapshots::Create(context->m_device, context->m_piid.c_str(),
+                    context->m_dmv.c_str(), context->m_aboutData, payload);
+        }
+        if (snapshot)
+        {
+            m_snapshots->Put(context->m_device.m_di, snapshot);
+            m_snapshots->Save(DEVICE_SNAPSHOTS_FILE_NAME);
+        }
+    }
+    lock.lock();
+    --m_pending;
+    sPending.Decrement();
+    m_cond.notify_one();
+    m_parsing.erase(context);
+    if (context->m_isDestroyed)
+    {
+        LOG(LOG_INFO, "[%p] %s destroyed while parsing", this, context->m_device.m_di.c_str());
+        success = false;
+    }
     if (success)
     {
         QStatus status;
-        presence = new OCPresence(context->m_device.m_di.c_str(), DISCOVER_PERIOD_SECS);
+        presence = new OCPresence(context->m_device.m_di.c_str(),
+                context->GetDevAddrs(OC_RSRVD_DEVICE_URI), PRESENCE_PERIOD_SECS);
         if (!presence)
         {
             LOG(LOG_ERR, "new OCPresence() failed");
             goto exit;
         }
         m_presence.push_back(presence);
+        PROBE1(presence_added, context->m_device.m_di.c_str());
         presence = NULL; /* presence now belongs to this */
         status = context->m_bus->Announce();
         if (status != ER_OK)
@@ -1738,12 +2342,66 @@ bool Bridge::ParseIntrospectionPayload(DiscoverContext *context, OCRepPayload *p
         }
         m_virtualBusAttachments.push_back(context->m_bus);
         context->m_bus = NULL; /* context->m_bus now belongs to this */
+        if (!m_isDeviceAvailable)
+        {
+            m_isDeviceAvailable = true;
+            LOG(LOG_INFO, "[%p] First device available %lld ms after start", this,
+                    (long long) std::chrono::duration_cast<std::chrono::milliseconds>(
+                            std::chrono::steady_clock::now() - m_startTime).count());
+        }
     }
 exit:
+    OCRepPayloadDestroy(snapshot);
     delete presence;
     return success;
 }
 
+/*
+ * Called with m_mutex held.  The restored devices are queued for Process() the same as a cached
+ * model, and remain unverified until the OC device is discovered again.
+ */
+void Bridge::Restore()
+{
+    for (auto &entry : m_snapshots->GetAll())
+    {
+        DeviceSnapshots::Snapshot snapshot = entry.second;
+        Device device;
+        std::string piid;
+        std::string dmv;
+        std::vector<const OCRepPayload *> aboutData;
+        const OCRepPayload *introspection = NULL;
+        DiscoverContext *context;
+        if (!DeviceSnapshots::Parse(snapshot.get(), device, piid, dmv, aboutData,
+                &introspection))
+        {
+            LOG(LOG_ERR, "[%p] Malformed snapshot of %s", this, entry.first.c_str());
+            m_snapshots->Erase(entry.first);
+            continue;
+        }
+        context = new DiscoverContext(this, device);
+        context->m_piid = piid;
+        context->m_dmv = dmv;
+        context->m_isRestored = true;
+        context->m_bus = VirtualBusAttachment::Create(device.m_di.c_str(), piid.c_str(),
+                device.IsVirtual());
+        if (!context->m_bus)
+        {
+            delete context;
+            continue;
+        }
+        for (const OCRepPayload *payload : aboutData)
+        {
+            context->m_bus->SetAboutData(const_cast<OCRepPayload *>(payload));
+        }
+        /* The introspection data is owned by snapshot */
+        context->m_model = ModelCache::Model(snapshot, const_cast<OCRepPayload *>(introspection));
+        LOG(LOG_INFO, "[%p] Restoring %s", this, device.m_di.c_str());
+        m_unverified.insert(device.m_di);
+        m_parsing.insert(context);
+        m_modelHits.push_back(context);
+    }
+}
+
 static const char *SeenStateText[] = { "NOT_SEEN", "SEEN_NATIVE", "SEEN_VIRTUAL" };
 
 /* Called with m_mutex held. */
@@ -1771,6 +2429,14 @@ Bridge::SeenState Bridge::GetSeenState(const char *piid)
                 break;
             }
         }
+        for (DiscoverContext *discoverContext : m_parsing)
+        {
+            if (!bus && discoverContext->m_bus &&
+                    (discoverContext->m_bus->GetProtocolIndependentId() == piid))
+            {
+                bus = discoverContext->m_bus;
+            }
+        }
         if (!bus)
         {
             for (VirtualBusAttachment *busAttachment : m_virtualBusAttachments)
@@ -1863,7 +2529,7 @@ void Bridge::DiscoverTask::Run(Bridge *thiz)
     {
         goto exit;
     }
-    context->m_bus->SetAboutData(m_payload);
+    context->SetAboutData(m_payload);
     result = thiz->ContinueDiscovery(context, OC_RSRVD_PLATFORM_URI,
             context->GetDevAddrs(OC_RSRVD_PLATFORM_URI), Bridge::GetPlatformCB);
     if (result == OC_STACK_OK)
@@ -1892,6 +2558,14 @@ void Bridge::DestroyPiid(const char *piid)
             break;
         }
     }
+    for (DiscoverContext *discoverContext : m_parsing)
+    {
+        if (di.empty() && discoverContext->m_bus &&
+                (discoverContext->m_bus->GetProtocolIndependentId() == piid))
+        {
+            di = discoverContext->m_bus->GetDi();
+        }
+    }
     if (di.empty())
     {
         for (VirtualBusAttachment *busAttachment : m_virtualBusAttachments)
@@ -1909,23 +2583,41 @@ void Bridge::DestroyPiid(const char *piid)
     }
 }
 
-void Bridge::RDPublish(void *ctx)
+/*
+ * The paths of a device are introspected concurrently and published together once the last one
+ * is reported.  A resource deleted before its report is dropped from the pending set by
+ * whoever deletes it, so the remaining paths of the device are still published promptly.
+ */
+void Bridge::ResourceCreatedCB(void *ctx, VirtualResource *resource, OCStackResult result)
 {
     Bridge *thiz = reinterpret_cast<Bridge *>(ctx);
-    std::lock_guard<std::mutex> lock(thiz->m_mutex);
-    if (thiz->m_rdPublishTask)
+    LOG(LOG_INFO, "[%p] resource=%p result=%d", thiz, resource, result);
+
+    MeteredLock lock(thiz->m_mutex, sLockWait);
+    /* Delay the pending publication to give time for multiple resources to be created. */
+    thiz->ScheduleRDPublish(thiz->m_pendingCreates->Created(resource) ? 0 : 1);
+}
+
+/*
+ * Called with m_mutex held.  Each call delays the publication by delaySecs, but never beyond
+ * RD_PUBLISH_MAX_DELAY_SECS from the first call so that a steady stream of changes is still
+ * published in batches.
+ */
+void Bridge::ScheduleRDPublish(time_t delaySecs)
+{
+    time_t tick = time(NULL) + delaySecs;
+    if (m_rdPublishTask)
     {
-        /* Delay the pending publication to give time for multiple resources to be created. */
-        thiz->m_rdPublishTask->m_tick = time(NULL) + 1;
+        m_rdPublishTask->m_tick = std::min(tick, m_rdPublishTask->m_deadline);
     }
     else
     {
-        thiz->m_rdPublishTask = new RDPublishTask(time(NULL) + 1);
-        thiz->m_tasks.push_back(thiz->m_rdPublishTask);
+        m_rdPublishTask = new RDPublishTask(tick);
+        m_tasks.push_back(m_rdPublishTask);
     }
 }
 
-/* Called with m_mutex held. */
+/* Called with m_introspectionMutex held. */
 void Bridge::SetIntrospectionData(ajn::BusAttachment *bus, const char *ajSoftwareVersion,
         const char *title, const char *version)
 {
@@ -1933,7 +2625,8 @@ void Bridge::SetIntrospectionData(ajn::BusAttachment *bus, const char *ajSoftwar
 
     OCPersistentStorage *ps = OCGetPersistentStorageHandler();
     assert(ps);
-    size_t curSize = 1024;
+    /* Only the fragments of new or changed resources and interfaces are encoded here */
+    size_t curSize = m_introspectionCache->Update(bus, ajSoftwareVersion, title, version);
     uint8_t *out = NULL;
     CborError err;
     FILE *fp = NULL;
@@ -1946,7 +2639,7 @@ void Bridge::SetIntrospectionData(ajn::BusAttachment *bus, const char *ajSoftwar
             LOG(LOG_ERR, "Failed to allocate introspection data buffer");
             goto exit;
         }
-        err = Introspect(bus, ajSoftwareVersion, title, version, out, &curSize);
+        err = m_introspectionCache->Introspect(out, &curSize);
         if (err != CborErrorOutOfMemory)
         {
             break;
@@ -1978,7 +2671,7 @@ void Bridge::RDPublishTask::Run(Bridge *thiz)
 {
     LOG(LOG_INFO, "[%p] thiz=%p", this, thiz);
 
-    thiz->SetIntrospectionData(thiz->m_bus, thiz->m_ajSoftwareVersion.c_str(), "TITLE", "VERSION");
-    ::RDPublish();
+    /* The publication itself is done by Process() after releasing m_mutex */
+    thiz->m_isRDPublishDue = true;
     thiz->m_rdPublishTask = NULL;
 }
@@ -0,0 +1,242 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "ControlChannel.h"
+
+#include "Log.h"
+#include <errno.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+const char *ControlChannel::ACK_OK = "ok";
+const char *ControlChannel::ACK_ERROR = "error";
+
+static const size_t HEADER_SIZE = 4 + 1 + 4 + 2;
+
+static void Put(std::vector<uint8_t> &frame, uint64_t value, size_t size)
+{
+    for (size_t i = size; i > 0; --i)
+    {
+        frame.push_back((value >> (8 * (i - 1))) & 0xff);
+    }
+}
+
+static uint32_t Get(const uint8_t *p, size_t size)
+{
+    uint32_t value = 0;
+    for (size_t i = 0; i < size; ++i)
+    {
+        value = (value << 8) | p[i];
+    }
+    return value;
+}
+
+ControlChannel::ControlChannel(int fd)
+    : m_fd(fd), m_seq(0)
+{
+}
+
+ControlChannel::~ControlChannel()
+{
+    close(m_fd);
+}
+
+bool ControlChannel::Encode(std::vector<uint8_t> &frame, const ControlMessage &msg)
+{
+    if (msg.m_args.size() > 0xffff)
+    {
+        return false;
+    }
+    size_t frameLen = HEADER_SIZE;
+    for (const std::string &arg : msg.m_args)
+    {
+        if (arg.size() > 0xffff)
+        {
+            return false;
+        }
+        frameLen += 2 + arg.size();
+    }
+    if (frameLen > MAX_FRAME_SIZE)
+    {
+        return false;
+    }
+    size_t begin = frame.size();
+    frame.reserve(begin + frameLen);
+    Put(frame, 0, 4);
+    Put(frame, msg.m_type, 1);
+    Put(frame, msg.m_seq, 4);
+    Put(frame, msg.m_args.size(), 2);
+    for (const std::string &arg : msg.m_args)
+    {
+        Put(frame, arg.size(), 2);
+        frame.insert(frame.end(), arg.begin(), arg.end());
+    }
+    size_t len = frame.size() - begin - 4;
+    for (size_t i = 0; i < 4; ++i)
+    {
+        frame[begin + i] = (len >> (8 * (3 - i))) & 0xff;
+    }
+    return true;
+}
+
+bool ControlChannel::Decode(const uint8_t *buf, size_t len, ControlMessage &msg,
+        size_t *consumed)
+{
+    *consumed = 0;
+    if (len < 4)
+    {
+        return true;
+    }
+    size_t frameLen = 4 + Get(buf, 4);
+    if ((frameLen < HEADER_SIZE) || (frameLen > MAX_FRAME_SIZE))
+    {
+        return false;
+    }
+    if (len < frameLen)
+    {
+        return true;
+    }
+    msg.m_type = (ControlMessage::Type) buf[4];
+    msg.m_seq = Get(buf + 5, 4);
+    size_t numArgs = Get(buf + 9, 2);
+    msg.m_args.clear();
+    const uint8_t *p = buf + HEADER_SIZE;
+    const uint8_t *end = buf + frameLen;
+    for (size_t i = 0; i < numArgs; ++i)
+    {
+        if ((end - p) < 2)
+        {
+            return false;
+        }
+        size_t argLen = Get(p, 2);
+        p += 2;
+        if ((size_t) (end - p) < argLen)
+        {
+            return false;
+        }
+        msg.m_args.push_back(std::string((const char *) p, argLen));
+        p += argLen;
+    }
+    if (p != end)
+    {
+        return false;
+    }
+    *consumed = frameLen;
+    return true;
+}
+
+/* Called with m_mutex held. */
+bool ControlChannel::Write(const std::vector<uint8_t> &frame)
+{
+    size_t written = 0;
+    while (written < frame.size())
+    {
+        /* The peer may have exited, which must not raise SIGPIPE here */
+        ssize_t n = send(m_fd, &frame[written], frame.size() - written, MSG_NOSIGNAL);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+            {
+                struct pollfd pfd = { m_fd, POLLOUT, 0 };
+                poll(&pfd, 1, -1);
+                continue;
+            }
+            LOG(LOG_ERR, "[%p] send - %s", this, strerror(errno));
+            return false;
+        }
+        written += n;
+    }
+    return true;
+}
+
+uint32_t ControlChannel::Send(ControlMessage::Type type, const std::vector<std::string> &args)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (++m_seq == 0)
+    {
+        ++m_seq;
+    }
+    std::vector<uint8_t> frame;
+    if (!Encode(frame, ControlMessage(type, m_seq, args)))
+    {
+        LOG(LOG_ERR, "[%p] Message too large", this);
+        return 0;
+    }
+    return Write(frame) ? m_seq : 0;
+}
+
+bool ControlChannel::Ack(uint32_t seq, bool success, const std::vector<std::string> &details)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ControlMessage msg(ControlMessage::ACK, seq, details);
+    msg.m_args.insert(msg.m_args.begin(), success ? ACK_OK : ACK_ERROR);
+    std::vector<uint8_t> frame;
+    if (!Encode(frame, msg))
+    {
+        LOG(LOG_ERR, "[%p] Message too large", this);
+        return false;
+    }
+    return Write(frame);
+}
+
+bool ControlChannel::Receive(std::vector<ControlMessage> &messages)
+{
+    uint8_t buf[4096];
+    ssize_t n = read(m_fd, buf, sizeof(buf));
+    if (n < 0)
+    {
+        if ((errno == EINTR) || (errno == EAGAIN) || (errno == EWOULDBLOCK))
+        {
+            return true;
+        }
+        LOG(LOG_ERR, "[%p] read - %s", this, strerror(errno));
+        return false;
+    }
+    if (n == 0)
+    {
+        return false;
+    }
+    m_buf.insert(m_buf.end(), buf, buf + n);
+    size_t offset = 0;
+    while (offset < m_buf.size())
+    {
+        ControlMessage msg;
+        size_t consumed;
+        if (!Decode(&m_buf[offset], m_buf.size() - offset, msg, &consumed))
+        {
+            LOG(LOG_ERR, "[%p] Malformed frame", this);
+            return false;
+        }
+        if (!consumed)
+        {
+            break;
+        }
+        messages.push_back(msg);
+        offset += consumed;
+    }
+    m_buf.erase(m_buf.begin(), m_buf.begin() + offset);
+    return true;
+}
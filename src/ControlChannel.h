@@ -0,0 +1,114 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#ifndef _CONTROLCHANNEL_H
+#define _CONTROLCHANNEL_H
+
+#include <inttypes.h>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/*
+ * A message between a bridge process and the PluginManager.
+ */
+struct ControlMessage
+{
+    enum Type
+    {
+        /* The arguments of the bridge process to start for a device */
+        EXEC = 1,
+        /* The uuid of the device whose bridge process to stop */
+        KILL,
+        /*
+         * The uuid of a device, its seen state ("none", "native" or "virtual") and the pid of
+         * the bridge process for it
+         */
+        SEEN_STATE,
+        /* Name and value pairs describing the state of the sender */
+        HEALTH,
+        /* The number of standby bridge processes to keep, followed by their arguments */
+        POOL,
+        /* m_seq is that of the message acknowledged, followed by the result and any details */
+        ACK,
+    };
+    Type m_type;
+    uint32_t m_seq;
+    std::vector<std::string> m_args;
+
+    ControlMessage() : m_type(ACK), m_seq(0) { }
+    ControlMessage(Type type, uint32_t seq, const std::vector<std::string> &args)
+        : m_type(type), m_seq(seq), m_args(args) { }
+};
+
+/*
+ * Exchanges length-prefixed messages over one end of a socketpair, so that control messages
+ * are not mixed with log output and are read in batches instead of a byte at a time.
+ *
+ * A frame is the 32-bit length of the rest of the frame, an 8-bit type, a 32-bit sequence
+ * number and a 16-bit argument count, followed by each argument as a 16-bit length and its
+ * bytes.  Integers are in network byte order.
+ */
+class ControlChannel
+{
+    public:
+        static const size_t MAX_FRAME_SIZE = 64 * 1024;
+        static const char *ACK_OK;
+        static const char *ACK_ERROR;
+
+        /* Takes ownership of fd. */
+        ControlChannel(int fd);
+        ~ControlChannel();
+        int GetFd() const { return m_fd; }
+
+        /* Returns the sequence number of the message sent, or 0 if it could not be sent. */
+        uint32_t Send(ControlMessage::Type type, const std::vector<std::string> &args);
+        bool Ack(uint32_t seq, bool success,
+                const std::vector<std::string> &details = std::vector<std::string>());
+
+        /*
+         * Reads what is available with a single read() and appends the complete messages
+         * received to messages.  Returns false once the peer has closed the channel, or on an
+         * error or malformed frame.
+         */
+        bool Receive(std::vector<ControlMessage> &messages);
+
+        /*
+         * Appends the frame of msg to frame.  Returns false, leaving frame unchanged, if msg has
+         * more than 0xffff arguments, an argument longer than 0xffff bytes, or would not fit in
+         * MAX_FRAME_SIZE.
+         */
+        static bool Encode(std::vector<uint8_t> &frame, const ControlMessage &msg);
+        /*
+         * Sets consumed to the size of the frame at the start of buf, or to 0 if buf does not
+         * hold a complete frame yet.  Returns false if the frame is malformed.
+         */
+        static bool Decode(const uint8_t *buf, size_t len, ControlMessage &msg, size_t *consumed);
+
+    private:
+        std::mutex m_mutex;
+        int m_fd;
+        uint32_t m_seq;
+        std::vector<uint8_t> m_buf;
+
+        bool Write(const std::vector<uint8_t> &frame);
+};
+
+#endif
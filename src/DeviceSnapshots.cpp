@@ -0,0 +1,326 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "DeviceSnapshots.h"
+
+#include "Log.h"
+#include "ocpayload.h"
+#include "ocpayloadcbor.h"
+#include "oic_malloc.h"
+#include "oic_string.h"
+#include <string.h>
+
+static bool SetStringArray(OCRepPayload *payload, const char *name,
+        const std::vector<std::string> &strs)
+{
+    std::vector<const char *> values;
+    for (const std::string &str : strs)
+    {
+        values.push_back(str.c_str());
+    }
+    if (values.empty())
+    {
+        return true;
+    }
+    size_t dim[MAX_REP_ARRAY_DEPTH] = { values.size(), 0, 0 };
+    return OCRepPayloadSetStringArray(payload, name, &values[0], dim);
+}
+
+static bool SetObjectArray(OCRepPayload *payload, const char *name,
+        std::vector<const OCRepPayload *> &objs)
+{
+    if (objs.empty())
+    {
+        return true;
+    }
+    size_t dim[MAX_REP_ARRAY_DEPTH] = { objs.size(), 0, 0 };
+    return OCRepPayloadSetPropObjectArray(payload, name, &objs[0], dim);
+}
+
+static OCRepPayload *CreateEndpoint(const OCDevAddr &addr)
+{
+    OCRepPayload *payload = OCRepPayloadCreate();
+    if (!payload ||
+            !OCRepPayloadSetPropInt(payload, "adapter", addr.adapter) ||
+            !OCRepPayloadSetPropInt(payload, "flags", addr.flags) ||
+            !OCRepPayloadSetPropInt(payload, "port", addr.port) ||
+            !OCRepPayloadSetPropString(payload, "addr", addr.addr) ||
+            !OCRepPayloadSetPropInt(payload, "ifindex", addr.ifindex) ||
+            !OCRepPayloadSetPropString(payload, "ri", addr.remoteId))
+    {
+        OCRepPayloadDestroy(payload);
+        payload = NULL;
+    }
+    return payload;
+}
+
+static OCRepPayload *CreateResource(const Resource &resource)
+{
+    std::vector<const OCRepPayload *> eps;
+    std::vector<const OCRepPayload *> links;
+    OCRepPayload *payload = OCRepPayloadCreate();
+    bool success = false;
+    if (!payload ||
+            !OCRepPayloadSetPropString(payload, OC_RSRVD_HREF, resource.m_uri.c_str()) ||
+            !SetStringArray(payload, OC_RSRVD_RESOURCE_TYPE, resource.m_rts) ||
+            !SetStringArray(payload, OC_RSRVD_INTERFACE, resource.m_ifs) ||
+            !OCRepPayloadSetPropBool(payload, "obs", resource.m_isObservable))
+    {
+        goto exit;
+    }
+    for (const OCDevAddr &addr : resource.m_addrs)
+    {
+        OCRepPayload *ep = CreateEndpoint(addr);
+        if (!ep)
+        {
+            goto exit;
+        }
+        eps.push_back(ep);
+    }
+    for (const Resource &r : resource.m_resources)
+    {
+        OCRepPayload *link = CreateResource(r);
+        if (!link)
+        {
+            goto exit;
+        }
+        links.push_back(link);
+    }
+    success = SetObjectArray(payload, OC_RSRVD_ENDPOINTS, eps) &&
+            SetObjectArray(payload, OC_RSRVD_LINKS, links);
+
+exit:
+    for (const OCRepPayload *ep : eps)
+    {
+        OCRepPayloadDestroy((OCRepPayload *) ep);
+    }
+    for (const OCRepPayload *link : links)
+    {
+        OCRepPayloadDestroy((OCRepPayload *) link);
+    }
+    if (!success)
+    {
+        OCRepPayloadDestroy(payload);
+        payload = NULL;
+    }
+    return payload;
+}
+
+OCRepPayload *DeviceSnapshots::Create(const Device &device, const char *piid, const char *dmv,
+        const std::vector<OCRepPayload *> &aboutData, const OCRepPayload *introspection)
+{
+    std::vector<const OCRepPayload *> resources;
+    std::vector<const OCRepPayload *> about(aboutData.begin(), aboutData.end());
+    OCRepPayload *payload = OCRepPayloadCreate();
+    bool success = false;
+    if (!payload ||
+            !OCRepPayloadSetPropString(payload, OC_RSRVD_DEVICE_ID, device.m_di.c_str()) ||
+            !OCRepPayloadSetPropString(payload, OC_RSRVD_PROTOCOL_INDEPENDENT_ID,
+                    piid ? piid : "") ||
+            !OCRepPayloadSetPropString(payload, OC_RSRVD_DATA_MODEL_VERSION, dmv ? dmv : "") ||
+            !OCRepPayloadSetPropObject(payload, "introspection", introspection) ||
+            !SetObjectArray(payload, "about", about))
+    {
+        LOG(LOG_ERR, "Failed to create snapshot");
+        goto exit;
+    }
+    for (const Resource &r : device.m_resources)
+    {
+        OCRepPayload *resource = CreateResource(r);
+        if (!resource)
+        {
+            LOG(LOG_ERR, "Failed to create snapshot of %s", r.m_uri.c_str());
+            goto exit;
+        }
+        resources.push_back(resource);
+    }
+    success = SetObjectArray(payload, "resources", resources);
+
+exit:
+    for (const OCRepPayload *resource : resources)
+    {
+        OCRepPayloadDestroy((OCRepPayload *) resource);
+    }
+    if (!success)
+    {
+        OCRepPayloadDestroy(payload);
+        payload = NULL;
+    }
+    return payload;
+}
+
+static const OCRepPayloadValue *GetValue(const OCRepPayload *payload, const char *name,
+        OCRepPayloadPropType type)
+{
+    for (OCRepPayloadValue *value = payload->values; value; value = value->next)
+    {
+        if (!strcmp(value->name, name))
+        {
+            return (value->type == type) ? value : NULL;
+        }
+    }
+    return NULL;
+}
+
+static const char *GetString(const OCRepPayload *payload, const char *name)
+{
+    const OCRepPayloadValue *value = GetValue(payload, name, OCREP_PROP_STRING);
+    return value ? value->str : NULL;
+}
+
+static int64_t GetInt(const OCRepPayload *payload, const char *name)
+{
+    const OCRepPayloadValue *value = GetValue(payload, name, OCREP_PROP_INT);
+    return value ? value->i : 0;
+}
+
+/* Returns the number of elements, or 0 if name is missing or not of type arrType. */
+static size_t GetArray(const OCRepPayload *payload, const char *name,
+        OCRepPayloadPropType arrType, const OCRepPayloadValueArray **arr)
+{
+    const OCRepPayloadValue *value = GetValue(payload, name, OCREP_PROP_ARRAY);
+    if (!value || (value->arr.type != arrType))
+    {
+        return 0;
+    }
+    *arr = &value->arr;
+    return calcDimTotal(value->arr.dimensions);
+}
+
+static SharedVector<std::string> GetStrings(const OCRepPayload *payload, const char *name)
+{
+    std::vector<std::string> strs;
+    const OCRepPayloadValueArray *arr;
+    size_t n = GetArray(payload, name, OCREP_PROP_STRING, &arr);
+    for (size_t i = 0; i < n; ++i)
+    {
+        strs.push_back(arr->strArray[i]);
+    }
+    return Intern(std::move(strs));
+}
+
+static bool ParseEndpoint(const OCRepPayload *payload, OCDevAddr &addr)
+{
+    const char *host = GetString(payload, "addr");
+    const char *remoteId = GetString(payload, "ri");
+    if (!host || !remoteId)
+    {
+        return false;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.adapter = (OCTransportAdapter) GetInt(payload, "adapter");
+    addr.flags = (OCTransportFlags) GetInt(payload, "flags");
+    addr.port = (uint16_t) GetInt(payload, "port");
+    OICStrcpy(addr.addr, sizeof(addr.addr), host);
+    addr.ifindex = (uint32_t) GetInt(payload, "ifindex");
+    OICStrcpy(addr.remoteId, sizeof(addr.remoteId), remoteId);
+    return true;
+}
+
+static bool ParseResource(const OCRepPayload *payload, Resource &resource)
+{
+    const char *uri = GetString(payload, OC_RSRVD_HREF);
+    const OCRepPayloadValue *obs = GetValue(payload, "obs", OCREP_PROP_BOOL);
+    const OCRepPayloadValueArray *arr;
+    size_t n;
+    if (!uri)
+    {
+        return false;
+    }
+    resource.m_uri = uri;
+    resource.m_rts = GetStrings(payload, OC_RSRVD_RESOURCE_TYPE);
+    resource.m_ifs = GetStrings(payload, OC_RSRVD_INTERFACE);
+    resource.m_isObservable = obs && obs->b;
+    n = GetArray(payload, OC_RSRVD_ENDPOINTS, OCREP_PROP_OBJECT, &arr);
+    for (size_t i = 0; i < n; ++i)
+    {
+        OCDevAddr addr;
+        if (!ParseEndpoint(arr->objArray[i], addr))
+        {
+            return false;
+        }
+        resource.m_addrs.push_back(addr);
+    }
+    n = GetArray(payload, OC_RSRVD_LINKS, OCREP_PROP_OBJECT, &arr);
+    for (size_t i = 0; i < n; ++i)
+    {
+        Resource link;
+        if (!ParseResource(arr->objArray[i], link))
+        {
+            return false;
+        }
+        resource.m_resources.push_back(link);
+    }
+    return true;
+}
+
+bool DeviceSnapshots::Parse(const OCRepPayload *snapshot, Device &device, std::string &piid,
+        std::string &dmv, std::vector<const OCRepPayload *> &aboutData,
+        const OCRepPayload **introspection)
+{
+    const char *di = GetString(snapshot, OC_RSRVD_DEVICE_ID);
+    const char *s = GetString(snapshot, OC_RSRVD_PROTOCOL_INDEPENDENT_ID);
+    const char *v = GetString(snapshot, OC_RSRVD_DATA_MODEL_VERSION);
+    const OCRepPayloadValue *value = GetValue(snapshot, "introspection", OCREP_PROP_OBJECT);
+    const OCRepPayloadValueArray *arr;
+    size_t n;
+    if (!di || !s || !v || !value)
+    {
+        return false;
+    }
+    device.m_di = di;
+    piid = s;
+    dmv = v;
+    *introspection = value->obj;
+    n = GetArray(snapshot, "about", OCREP_PROP_OBJECT, &arr);
+    for (size_t i = 0; i < n; ++i)
+    {
+        aboutData.push_back(arr->objArray[i]);
+    }
+    n = GetArray(snapshot, "resources", OCREP_PROP_OBJECT, &arr);
+    for (size_t i = 0; i < n; ++i)
+    {
+        Resource resource;
+        if (!ParseResource(arr->objArray[i], resource))
+        {
+            return false;
+        }
+        device.m_resources.push_back(resource);
+    }
+    return !device.m_resources.empty();
+}
+
+bool DeviceSnapshots::Matches(const std::string &di, const OCRepPayload *snapshot)
+{
+    Snapshot stored = Get(di);
+    uint8_t *a = NULL;
+    size_t aSize = 0;
+    uint8_t *b = NULL;
+    size_t bSize = 0;
+    bool matches = stored && snapshot &&
+            (OCConvertPayload((OCPayload *) stored.get(), OC_FORMAT_CBOR, &a, &aSize) ==
+                    OC_STACK_OK) &&
+            (OCConvertPayload((OCPayload *) snapshot, OC_FORMAT_CBOR, &b, &bSize) ==
+                    OC_STACK_OK) &&
+            (aSize == bSize) && !memcmp(a, b, aSize);
+    OICFree(a);
+    OICFree(b);
+    return matches;
+}
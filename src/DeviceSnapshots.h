@@ -0,0 +1,67 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#ifndef _DEVICESNAPSHOTS_H
+#define _DEVICESNAPSHOTS_H
+
+#include "PayloadStore.h"
+#include "Resource.h"
+#include "octypes.h"
+#include <string>
+#include <vector>
+
+/*
+ * What was learned about each OC device when it was last discovered: its resources and
+ * endpoints, the payloads its about data was created from, and its introspection data.  This is
+ * enough to recreate the virtual AJ device without waiting for the device to be rediscovered.
+ */
+class DeviceSnapshots : public PayloadStore
+{
+    public:
+        typedef Payload Snapshot;
+
+        /*
+         * @param[in] device the resources of the device.
+         * @param[in] piid the protocol independent ID of the device.
+         * @param[in] dmv the data model version of the device.
+         * @param[in] aboutData the payloads passed to VirtualBusAttachment::SetAboutData().
+         * @param[in] introspection the introspection data of the device.
+         *
+         * @return a new snapshot to be freed with OCRepPayloadDestroy(), or NULL on failure.
+         */
+        static OCRepPayload *Create(const Device &device, const char *piid, const char *dmv,
+                const std::vector<OCRepPayload *> &aboutData, const OCRepPayload *introspection);
+
+        /*
+         * The about data and introspection pointers returned by Parse() point into snapshot.
+         *
+         * @return false if snapshot is malformed.
+         */
+        static bool Parse(const OCRepPayload *snapshot, Device &device, std::string &piid,
+                std::string &dmv, std::vector<const OCRepPayload *> &aboutData,
+                const OCRepPayload **introspection);
+
+        /*
+         * @return true if the stored snapshot of di is identical to snapshot.
+         */
+        bool Matches(const std::string &di, const OCRepPayload *snapshot);
+};
+
+#endif
@@ -0,0 +1,49 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "DiscoveryScheduler.h"
+
+#include <algorithm>
+
+DiscoveryScheduler::DiscoveryScheduler(time_t minPeriodSecs, time_t maxPeriodSecs)
+    : m_minPeriodSecs(minPeriodSecs), m_maxPeriodSecs(std::max(minPeriodSecs, maxPeriodSecs)),
+      m_periodSecs(minPeriodSecs), m_nextTick(0), m_numRequests(0), m_numResponses(0),
+      m_numChanges(0)
+{
+}
+
+bool DiscoveryScheduler::IsDue(time_t now) const
+{
+    return now >= m_nextTick;
+}
+
+void DiscoveryScheduler::Sent(time_t now)
+{
+    ++m_numRequests;
+    m_nextTick = now + m_periodSecs;
+    m_periodSecs = std::min(m_periodSecs * 2, m_maxPeriodSecs);
+}
+
+void DiscoveryScheduler::Changed(time_t now)
+{
+    ++m_numChanges;
+    m_periodSecs = m_minPeriodSecs;
+    m_nextTick = std::min(m_nextTick, now + m_minPeriodSecs);
+}
@@ -0,0 +1,72 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#ifndef _DISCOVERYSCHEDULER_H
+#define _DISCOVERYSCHEDULER_H
+
+#include <stddef.h>
+#include <time.h>
+
+/*
+ * Decides when to send the next multicast discovery request.  Requests start out every
+ * minPeriodSecs and back off exponentially to maxPeriodSecs while the set of devices is stable.
+ * Any change brings the period back down to minPeriodSecs.
+ */
+class DiscoveryScheduler
+{
+    public:
+        DiscoveryScheduler(time_t minPeriodSecs, time_t maxPeriodSecs);
+
+        /*
+         * @return true if a request should be sent at now.
+         */
+        bool IsDue(time_t now) const;
+
+        /*
+         * Called when a request is sent at now.
+         */
+        void Sent(time_t now);
+
+        /*
+         * Called for each response received.
+         */
+        void Responded() { ++m_numResponses; }
+
+        /*
+         * Called when a device appears or disappears at now.
+         */
+        void Changed(time_t now);
+
+        time_t GetPeriod() const { return m_periodSecs; }
+        size_t GetNumRequests() const { return m_numRequests; }
+        size_t GetNumResponses() const { return m_numResponses; }
+        size_t GetNumChanges() const { return m_numChanges; }
+
+    private:
+        const time_t m_minPeriodSecs;
+        const time_t m_maxPeriodSecs;
+        time_t m_periodSecs;
+        time_t m_nextTick;
+        size_t m_numRequests;
+        size_t m_numResponses;
+        size_t m_numChanges;
+};
+
+#endif
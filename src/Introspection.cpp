@@ -25,6 +25,7 @@
 #include "Name.h"
 #include "Payload.h"
 #include "Plugin.h"
+#include "Resource.h"
 #include "SecureModeResource.h"
 #include "Signature.h"
 #include "oic_malloc.h"
@@ -32,6 +33,7 @@
 #include "ocpayload.h"
 #include "ocstack.h"
 #include <assert.h>
+#include <functional>
 
 /*
  * Internal functions needed to append boilerplate introspection data at runtime.
@@ -267,116 +269,117 @@ exit:
     return err;
 }
 
-static int64_t Paths(CborEncoder *cbor)
+/* Encodes the path item of resource h, if it has one. */
+static int64_t Path(CborEncoder *paths, OCResourceHandle h)
 {
-    OCStackResult result = OC_STACK_ERROR;
     int64_t err = CborNoError;
-    CborEncoder paths;
-    err |= cbor_encode_text_stringz(cbor, "paths");
-    VERIFY_CBOR(err);
-    err |= cbor_encoder_create_map(cbor, &paths, CborIndefiniteLength);
-    VERIFY_CBOR(err);
-    uint8_t nr;
-    result = OCGetNumberOfResources(&nr);
-    if (result != OC_STACK_OK)
+    const char *uri = OCGetResourceUri(h);
+    if (!strcmp(uri, OC_RSRVD_WELL_KNOWN_URI) ||
+            !strcmp(uri, OC_RSRVD_DEVICE_URI) ||
+            !strcmp(uri, OC_RSRVD_PLATFORM_URI) ||
+            !strncmp(uri, "/oic/sec", 8))
     {
-        err |= CborErrorInternalError;
+        // TODO skip unless there are vendor specific properties
         goto exit;
     }
-    for (uint8_t i = 0; i < nr; ++i)
+    if (!strcmp(uri, OC_RSRVD_RD_URI))
     {
-        OCResourceHandle h = OCGetResourceHandle(i);
-        if (!(OCGetResourceProperties(h) & OC_ACTIVE))
-        {
-            continue;
-        }
-        const char *uri = OCGetResourceUri(h);
-        if (!strcmp(uri, OC_RSRVD_WELL_KNOWN_URI) ||
-                !strcmp(uri, OC_RSRVD_DEVICE_URI) ||
-                !strcmp(uri, OC_RSRVD_PLATFORM_URI) ||
-                !strncmp(uri, "/oic/sec", 8))
-        {
-            // TODO skip unless there are vendor specific properties
-            continue;
-        }
-        if (!strcmp(uri, OC_RSRVD_RD_URI))
-        {
-            err |= append(&paths, oic_rd_paths,
-                    sizeof(oic_rd_paths) / sizeof(oic_rd_paths[0]));
-            VERIFY_CBOR(err);
-        }
-        else if (!strcmp(uri, OC_RSRVD_INTROSPECTION_URI_PATH))
+        err |= append(paths, oic_rd_paths,
+                sizeof(oic_rd_paths) / sizeof(oic_rd_paths[0]));
+        VERIFY_CBOR(err);
+    }
+    else if (!strcmp(uri, OC_RSRVD_INTROSPECTION_URI_PATH))
+    {
+        err |= append(paths, introspection_paths,
+                sizeof(introspection_paths) / sizeof(introspection_paths[0]));
+        VERIFY_CBOR(err);
+    }
+    else if (!strcmp(uri, OC_RSRVD_SECURE_MODE_URI))
+    {
+        err |= append(paths, securemode_paths,
+                sizeof(securemode_paths) / sizeof(securemode_paths[0]));
+        VERIFY_CBOR(err);
+    }
+    else
+    {
+        CborEncoder path;
+        err |= cbor_encode_text_stringz(paths, uri);
+        VERIFY_CBOR(err);
+        err |= cbor_encoder_create_map(paths, &path, CborIndefiniteLength);
+        VERIFY_CBOR(err);
+        CborEncoder get;
+        err |= cbor_encode_text_stringz(&path, "get");
+        VERIFY_CBOR(err);
+        err |= cbor_encoder_create_map(&path, &get, CborIndefiniteLength);
+        VERIFY_CBOR(err);
+        CborEncoder parameters;
+        err |= cbor_encode_text_stringz(&get, "parameters");
+        VERIFY_CBOR(err);
+        err |= cbor_encoder_create_array(&get, &parameters, CborIndefiniteLength);
+        VERIFY_CBOR(err);
+        err |= QueryParameters(&parameters, h);
+        VERIFY_CBOR(err);
+        err |= cbor_encoder_close_container(&get, &parameters);
+        VERIFY_CBOR(err);
+        err |= Responses(&get, h);
+        VERIFY_CBOR(err);
+        err |= cbor_encoder_close_container(&path, &get);
+        VERIFY_CBOR(err);
+        if (ImplementsPost(h))
         {
-            err |= append(&paths, introspection_paths,
-                    sizeof(introspection_paths) / sizeof(introspection_paths[0]));
+            CborEncoder post;
+            err |= cbor_encode_text_stringz(&path, "post");
             VERIFY_CBOR(err);
-        }
-        else if (!strcmp(uri, OC_RSRVD_SECURE_MODE_URI))
-        {
-            err |= append(&paths, securemode_paths,
-                    sizeof(securemode_paths) / sizeof(securemode_paths[0]));
+            err |= cbor_encoder_create_map(&path, &post, CborIndefiniteLength);
             VERIFY_CBOR(err);
-        }
-        else
-        {
-            CborEncoder path;
-            err |= cbor_encode_text_stringz(&paths, uri);
+            CborEncoder parameters;
+            err |= cbor_encode_text_stringz(&post, "parameters");
             VERIFY_CBOR(err);
-            err |= cbor_encoder_create_map(&paths, &path, CborIndefiniteLength);
+            err |= cbor_encoder_create_array(&post, &parameters, CborIndefiniteLength);
             VERIFY_CBOR(err);
-            CborEncoder get;
-            err |= cbor_encode_text_stringz(&path, "get");
+            err |= QueryParameters(&parameters, h);
             VERIFY_CBOR(err);
-            err |= cbor_encoder_create_map(&path, &get, CborIndefiniteLength);
+            CborEncoder body;
+            err |= cbor_encoder_create_map(&parameters, &body, CborIndefiniteLength);
             VERIFY_CBOR(err);
-            CborEncoder parameters;
-            err |= cbor_encode_text_stringz(&get, "parameters");
+            err |= Pair(&body, "name", "body");
             VERIFY_CBOR(err);
-            err |= cbor_encoder_create_array(&get, &parameters, CborIndefiniteLength);
+            err |= Pair(&body, "in", "body");
             VERIFY_CBOR(err);
-            err |= QueryParameters(&parameters, h);
+            err |= Schema(&body, h);
             VERIFY_CBOR(err);
-            err |= cbor_encoder_close_container(&get, &parameters);
+            err |= cbor_encoder_close_container(&parameters, &body);
             VERIFY_CBOR(err);
-            err |= Responses(&get, h);
+            err |= cbor_encoder_close_container(&post, &parameters);
             VERIFY_CBOR(err);
-            err |= cbor_encoder_close_container(&path, &get);
+            err |= Responses(&post, h);
             VERIFY_CBOR(err);
-            if (ImplementsPost(h))
-            {
-                CborEncoder post;
-                err |= cbor_encode_text_stringz(&path, "post");
-                VERIFY_CBOR(err);
-                err |= cbor_encoder_create_map(&path, &post, CborIndefiniteLength);
-                VERIFY_CBOR(err);
-                CborEncoder parameters;
-                err |= cbor_encode_text_stringz(&post, "parameters");
-                VERIFY_CBOR(err);
-                err |= cbor_encoder_create_array(&post, &parameters, CborIndefiniteLength);
-                VERIFY_CBOR(err);
-                err |= QueryParameters(&parameters, h);
-                VERIFY_CBOR(err);
-                CborEncoder body;
-                err |= cbor_encoder_create_map(&parameters, &body, CborIndefiniteLength);
-                VERIFY_CBOR(err);
-                err |= Pair(&body, "name", "body");
-                VERIFY_CBOR(err);
-                err |= Pair(&body, "in", "body");
-                VERIFY_CBOR(err);
-                err |= Schema(&body, h);
-                VERIFY_CBOR(err);
-                err |= cbor_encoder_close_container(&parameters, &body);
-                VERIFY_CBOR(err);
-                err |= cbor_encoder_close_container(&post, &parameters);
-                VERIFY_CBOR(err);
-                err |= Responses(&post, h);
-                VERIFY_CBOR(err);
-                err |= cbor_encoder_close_container(&path, &post);
-                VERIFY_CBOR(err);
-            }
-            err |= cbor_encoder_close_container(&paths, &path);
+            err |= cbor_encoder_close_container(&path, &post);
             VERIFY_CBOR(err);
         }
+        err |= cbor_encoder_close_container(paths, &path);
+        VERIFY_CBOR(err);
+    }
+exit:
+    return err;
+}
+
+static int64_t Paths(CborEncoder *cbor)
+{
+    int64_t err = CborNoError;
+    CborEncoder paths;
+    err |= cbor_encode_text_stringz(cbor, "paths");
+    VERIFY_CBOR(err);
+    err |= cbor_encoder_create_map(cbor, &paths, CborIndefiniteLength);
+    VERIFY_CBOR(err);
+    for (OCResourceHandle h : GetResourceHandles())
+    {
+        if (!(OCGetResourceProperties(h) & OC_ACTIVE))
+        {
+            continue;
+        }
+        err |= Path(&paths, h);
+        VERIFY_CBOR(err);
     }
     err |= cbor_encoder_close_container(cbor, &paths);
     VERIFY_CBOR(err);
@@ -662,131 +665,719 @@ static int64_t Properties(CborEncoder *cbor, const char *ajSoftwareVersion,
     }
     for (size_t k = 0; k < numArgs; ++k, ++argN)
     {
-        ParseCompleteType(signature);
-        qcc::String sig(argSignature, signature - argSignature);
-        argSignature = signature;
-        std::string argName = NextArgName(argNames);
-        if (strcmp(ajSoftwareVersion, "v16.10.00") >= 0)
+        ParseCompleteType(signature);
+        qcc::String sig(argSignature, signature - argSignature);
+        argSignature = signature;
+        std::string argName = NextArgName(argNames);
+        if (strcmp(ajSoftwareVersion, "v16.10.00") >= 0)
+        {
+            member->GetArgAnnotation(argName.c_str(), "org.alljoyn.Bus.Type.Name", sig);
+        }
+        std::string propName = GetPropName(member, argName, argN);
+        qcc::String min, max, def;
+        member->GetAnnotation("org.alljoyn.Bus.Type.Min", min);
+        member->GetAnnotation("org.alljoyn.Bus.Type.Max", max);
+        member->GetAnnotation("org.alljoyn.Bus.Type.Default", def);
+        err |= Property(cbor, propName, member->description, readOnly, sig, min, max, def);
+        VERIFY_CBOR(err);
+    }
+exit:
+    return err;
+}
+
+static int64_t Parameter(CborEncoder *parameters, OCResourceHandle h)
+{
+    int64_t err = CborNoError;
+    const char *uri = OCGetResourceUri(h);
+    if (!strcmp(uri, OC_RSRVD_RD_URI))
+    {
+        err |= append(parameters, oic_rd_parameters,
+                sizeof(oic_rd_parameters) / sizeof(oic_rd_parameters[0]));
+        VERIFY_CBOR(err);
+    }
+    else if (!strcmp(uri, OC_RSRVD_INTROSPECTION_URI_PATH))
+    {
+        err |= append(parameters, introspection_parameters,
+                sizeof(introspection_parameters) / sizeof(introspection_parameters[0]));
+        VERIFY_CBOR(err);
+    }
+    else if (!strcmp(uri, OC_RSRVD_SECURE_MODE_URI))
+    {
+        err |= append(parameters, securemode_parameters,
+                sizeof(securemode_parameters) / sizeof(securemode_parameters[0]));
+        VERIFY_CBOR(err);
+    }
+exit:
+    return err;
+}
+
+static int64_t Parameters(CborEncoder *cbor)
+{
+    int64_t err = CborNoError;
+    CborEncoder parameters;
+    err |= cbor_encode_text_stringz(cbor, "parameters");
+    VERIFY_CBOR(err);
+    err |= cbor_encoder_create_map(cbor, &parameters, CborIndefiniteLength);
+    VERIFY_CBOR(err);
+    for (OCResourceHandle h : GetResourceHandles())
+    {
+        if (!(OCGetResourceProperties(h) & OC_ACTIVE))
+        {
+            continue;
+        }
+        err |= Parameter(&parameters, h);
+        VERIFY_CBOR(err);
+    }
+    err |= cbor_encoder_close_container(cbor, &parameters);
+    VERIFY_CBOR(err);
+exit:
+    return err;
+}
+
+static int64_t ResourceDefinition(CborEncoder *definitions, OCResourceHandle h)
+{
+    int64_t err = CborNoError;
+    const char *uri = OCGetResourceUri(h);
+    if (!strcmp(uri, OC_RSRVD_RD_URI))
+    {
+        err |= append(definitions, oic_rd_definitions,
+                sizeof(oic_rd_definitions) / sizeof(oic_rd_definitions[0]));
+        VERIFY_CBOR(err);
+    }
+    else if (!strcmp(uri, OC_RSRVD_INTROSPECTION_URI_PATH))
+    {
+        err |= append(definitions, introspection_definitions,
+                sizeof(introspection_definitions) / sizeof(introspection_definitions[0]));
+        VERIFY_CBOR(err);
+    }
+    else if (!strcmp(uri, OC_RSRVD_SECURE_MODE_URI))
+    {
+        err |= append(definitions, securemode_definitions,
+                sizeof(securemode_definitions) / sizeof(securemode_definitions[0]));
+        VERIFY_CBOR(err);
+    }
+exit:
+    return err;
+}
+
+static int64_t InterfaceDefinitions(CborEncoder *definitions,
+        const ajn::InterfaceDescription *iface, const char *ajSoftwareVersion)
+{
+    const ajn::InterfaceDescription::Property **props = NULL;
+    const ajn::InterfaceDescription::Member **members = NULL;
+    qcc::String *names = NULL;
+    qcc::String *values = NULL;
+    size_t numMembers;
+    int64_t err = CborNoError;
+    size_t numProps = iface->GetProperties(NULL, 0);
+    props = new const ajn::InterfaceDescription::Property*[numProps];
+    iface->GetProperties(props, numProps);
+    static const char *emitsChangedValues[] =
+            { "const", "false", "true", "invalidates", NULL };
+    for (const char **emitsChanged = emitsChangedValues; *emitsChanged; ++emitsChanged)
+    {
+        bool hasProps = false;
+        CborEncoder definition;
+        CborEncoder properties;
+        uint8_t access = NONE;
+        std::string rt = GetResourceTypeName(iface, *emitsChanged);
+        for (size_t j = 0; j < numProps; ++j)
+        {
+            qcc::String emitsChangedValue = (props[j]->name == "Version") ? "const" : "false";
+            props[j]->GetAnnotation(::ajn::org::freedesktop::DBus::AnnotateEmitsChanged,
+                    emitsChangedValue);
+            if (emitsChangedValue != *emitsChanged)
+            {
+                continue;
+            }
+            if (!hasProps)
+            {
+                err |= cbor_encode_text_stringz(definitions, rt.c_str());
+                VERIFY_CBOR(err);
+                err |= cbor_encoder_create_map(definitions, &definition,
+                        CborIndefiniteLength);
+                VERIFY_CBOR(err);
+                err |= Pair(&definition, "type", "object");
+                VERIFY_CBOR(err);
+                err |= cbor_encode_text_stringz(&definition, "properties");
+                VERIFY_CBOR(err);
+                err |= cbor_encoder_create_map(&definition, &properties,
+                        CborIndefiniteLength);
+                VERIFY_CBOR(err);
+                hasProps = true;
+            }
+            std::string propName = GetPropName(iface, emitsChangedValue + "." +
+                    ToOCPropName(props[j]->name));
+            /*
+             * Annotations prior to v16.10.00 are not guaranteed to
+             * appear in the order they were specified, so are
+             * unreliable.
+             */
+            qcc::String signature = props[j]->signature;
+            if (strcmp(ajSoftwareVersion, "v16.10.00") >= 0)
+            {
+                props[j]->GetAnnotation("org.alljoyn.Bus.Type.Name", signature);
+            }
+            qcc::String min, max, def;
+            props[j]->GetAnnotation("org.alljoyn.Bus.Type.Min", min);
+            props[j]->GetAnnotation("org.alljoyn.Bus.Type.Max", max);
+            props[j]->GetAnnotation("org.alljoyn.Bus.Type.Default", def);
+            err  |= Property(&properties, propName, props[j]->description,
+                    (props[j]->access == ajn::PROP_ACCESS_READ), signature, min, max, def);
+            VERIFY_CBOR(err);
+            switch (props[j]->access)
+            {
+                case ajn::PROP_ACCESS_RW:
+                case ajn::PROP_ACCESS_WRITE:
+                    access |= READWRITE;
+                    break;
+                case ajn::PROP_ACCESS_READ:
+                    access |= READ;
+                    break;
+            }
+        }
+        if (hasProps)
+        {
+            CborEncoder rtMap;
+            err |= cbor_encode_text_stringz(&properties, "rt");
+            VERIFY_CBOR(err);
+            err |= cbor_encoder_create_map(&properties, &rtMap, CborIndefiniteLength);
+            VERIFY_CBOR(err);
+            err |= cbor_encode_text_stringz(&rtMap, "readOnly");
+            VERIFY_CBOR(err);
+            err |= cbor_encode_boolean(&rtMap, true);
+            VERIFY_CBOR(err);
+            err |= Pair(&rtMap, "type", "array");
+            VERIFY_CBOR(err);
+            CborEncoder def;
+            err |= cbor_encode_text_stringz(&rtMap, "default");
+            VERIFY_CBOR(err);
+            err |= cbor_encoder_create_array(&rtMap, &def, 1);
+            VERIFY_CBOR(err);
+            err |= cbor_encode_text_stringz(&def, rt.c_str());
+            VERIFY_CBOR(err);
+            err |= cbor_encoder_close_container(&rtMap, &def);
+            VERIFY_CBOR(err);
+            err |= cbor_encoder_close_container(&properties, &rtMap);
+            VERIFY_CBOR(err);
+            CborEncoder ifMap;
+            err |= cbor_encode_text_stringz(&properties, "if");
+            VERIFY_CBOR(err);
+            err |= cbor_encoder_create_map(&properties, &ifMap, CborIndefiniteLength);
+            VERIFY_CBOR(err);
+            err |= cbor_encode_text_stringz(&ifMap, "readOnly");
+            VERIFY_CBOR(err);
+            err |= cbor_encode_boolean(&ifMap, true);
+            VERIFY_CBOR(err);
+            err |= Pair(&ifMap, "type", "array");
+            VERIFY_CBOR(err);
+            CborEncoder items;
+            err |= cbor_encode_text_stringz(&ifMap, "items");
+            VERIFY_CBOR(err);
+            err |= cbor_encoder_create_map(&ifMap, &items, 2);
+            VERIFY_CBOR(err);
+            err |= Pair(&items, "type", "string");
+            VERIFY_CBOR(err);
+            CborEncoder enumArr;
+            err |= cbor_encode_text_stringz(&items, "enum");
+            VERIFY_CBOR(err);
+            err |= cbor_encoder_create_array(&items, &enumArr, CborIndefiniteLength);
+            VERIFY_CBOR(err);
+            err |= cbor_encode_text_stringz(&enumArr, "oic.if.baseline");
+            VERIFY_CBOR(err);
+            if (access & READ)
+            {
+                err |= cbor_encode_text_stringz(&enumArr, "oic.if.r");
+                VERIFY_CBOR(err);
+            }
+            if (access & READWRITE)
+            {
+                err |= cbor_encode_text_stringz(&enumArr, "oic.if.rw");
+                VERIFY_CBOR(err);
+            }
+            err |= cbor_encoder_close_container(&items, &enumArr);
+            VERIFY_CBOR(err);
+            err |= cbor_encoder_close_container(&ifMap, &items);
+            VERIFY_CBOR(err);
+            err |= cbor_encoder_close_container(&properties, &ifMap);
+            VERIFY_CBOR(err);
+            err |= cbor_encoder_close_container(&definition, &properties);
+            VERIFY_CBOR(err);
+            err |= cbor_encoder_close_container(definitions, &definition);
+            VERIFY_CBOR(err);
+        }
+    }
+    delete[] props;
+    props = NULL;
+    numMembers = iface->GetMembers(NULL, 0);
+    members = new const ajn::InterfaceDescription::Member*[numMembers];
+    iface->GetMembers(members, numMembers);
+    for (size_t j = 0; j < numMembers; ++j)
+    {
+        std::string rt = GetResourceTypeName(iface, members[j]->name);
+        CborEncoder definition;
+        err |= cbor_encode_text_stringz(definitions, rt.c_str());
+        VERIFY_CBOR(err);
+        err |= cbor_encoder_create_map(definitions, &definition, CborIndefiniteLength);
+        VERIFY_CBOR(err);
+        err |= Pair(&definition, "type", "object");
+        VERIFY_CBOR(err);
+        CborEncoder properties;
+        err |= cbor_encode_text_stringz(&definition, "properties");
+        VERIFY_CBOR(err);
+        err |= cbor_encoder_create_map(&definition, &properties, CborIndefiniteLength);
+        VERIFY_CBOR(err);
+        std::string propName = GetPropName(members[j], "validity");
+        CborEncoder prop;
+        err |= cbor_encode_text_stringz(&properties, propName.c_str());
+        VERIFY_CBOR(err);
+        err |= cbor_encoder_create_map(&properties, &prop, CborIndefiniteLength);
+        VERIFY_CBOR(err);
+        if (members[j]->memberType == ajn::MESSAGE_SIGNAL)
+        {
+            err |= cbor_encode_text_stringz(&prop, "readOnly");
+            VERIFY_CBOR(err);
+            err |= cbor_encode_boolean(&prop, true);
+            VERIFY_CBOR(err);
+        }
+        err |= Pair(&prop, "type", "boolean");
+        VERIFY_CBOR(err);
+        err |= cbor_encoder_close_container(&properties, &prop);
+        VERIFY_CBOR(err);
+        size_t argN = 0;
+        err |= Properties(&properties, ajSoftwareVersion, members[j],
+                members[j]->signature.c_str(), argN,
+                (members[j]->memberType == ajn::MESSAGE_SIGNAL));
+        VERIFY_CBOR(err);
+        err |= Properties(&properties, ajSoftwareVersion, members[j],
+                members[j]->returnSignature.c_str(), argN, true);
+        VERIFY_CBOR(err);
+        err |= cbor_encode_text_stringz(&properties, "rt");
+        VERIFY_CBOR(err);
+        err |= cbor_encoder_create_map(&properties, &prop, CborIndefiniteLength);
+        VERIFY_CBOR(err);
+        err |= cbor_encode_text_stringz(&prop, "readOnly");
+        VERIFY_CBOR(err);
+        err |= cbor_encode_boolean(&prop, true);
+        VERIFY_CBOR(err);
+        err |= Pair(&prop, "type", "array");
+        VERIFY_CBOR(err);
+        CborEncoder def;
+        err |= cbor_encode_text_stringz(&prop, "default");
+        VERIFY_CBOR(err);
+        err |= cbor_encoder_create_array(&prop, &def, 1);
+        VERIFY_CBOR(err);
+        err |= cbor_encode_text_stringz(&def, rt.c_str());
+        VERIFY_CBOR(err);
+        err |= cbor_encoder_close_container(&prop, &def);
+        VERIFY_CBOR(err);
+        err |= cbor_encoder_close_container(&properties, &prop);
+        VERIFY_CBOR(err);
+        err |= cbor_encode_text_stringz(&properties, "if");
+        VERIFY_CBOR(err);
+        err |= cbor_encoder_create_map(&properties, &prop, CborIndefiniteLength);
+        VERIFY_CBOR(err);
+        err |= cbor_encode_text_stringz(&prop, "readOnly");
+        VERIFY_CBOR(err);
+        err |= cbor_encode_boolean(&prop, true);
+        VERIFY_CBOR(err);
+        err |= Pair(&prop, "type", "array");
+        VERIFY_CBOR(err);
+        CborEncoder items;
+        err |= cbor_encode_text_stringz(&prop, "items");
+        VERIFY_CBOR(err);
+        err |= cbor_encoder_create_map(&prop, &items, 2);
+        VERIFY_CBOR(err);
+        err |= Pair(&items, "type", "string");
+        VERIFY_CBOR(err);
+        CborEncoder enumArr;
+        err |= cbor_encode_text_stringz(&items, "enum");
+        VERIFY_CBOR(err);
+        err |= cbor_encoder_create_array(&items, &enumArr, CborIndefiniteLength);
+        VERIFY_CBOR(err);
+        err |= cbor_encode_text_stringz(&enumArr, "oic.if.baseline");
+        VERIFY_CBOR(err);
+        if (members[j]->memberType == ajn::MESSAGE_SIGNAL)
+        {
+            err |= cbor_encode_text_stringz(&enumArr, "oic.if.r");
+            VERIFY_CBOR(err);
+        }
+        else
+        {
+            err |= cbor_encode_text_stringz(&enumArr, "oic.if.rw");
+            VERIFY_CBOR(err);
+        }
+        err |= cbor_encoder_close_container(&items, &enumArr);
+        VERIFY_CBOR(err);
+        err |= cbor_encoder_close_container(&prop, &items);
+        VERIFY_CBOR(err);
+        err |= cbor_encoder_close_container(&properties, &prop);
+        VERIFY_CBOR(err);
+        err |= cbor_encoder_close_container(&definition, &properties);
+        VERIFY_CBOR(err);
+        err |= cbor_encoder_close_container(definitions, &definition);
+        VERIFY_CBOR(err);
+    }
+    delete[] members;
+    members = NULL;
+    if (strcmp(ajSoftwareVersion, "v16.10.00") >= 0)
+    {
+        size_t numAnnotations = iface->GetAnnotations();
+        names = new qcc::String[numAnnotations];
+        values = new qcc::String[numAnnotations];
+        iface->GetAnnotations(names, values, numAnnotations);
+        CborEncoder definition;
+        CborEncoder properties;
+        qcc::String lastName;
+        for (size_t j = 0; j < numAnnotations; ++j)
+        {
+            if (names[j].find("org.alljoyn.Bus.Struct.") == 0)
+            {
+                size_t pos = sizeof("org.alljoyn.Bus.Struct.") - 1;
+                size_t dot = names[j].find(".", pos);
+                if (dot == qcc::String::npos)
+                {
+                    continue;
+                }
+                qcc::String structName = names[j].substr(pos, dot - pos);
+                pos = dot + sizeof(".Field.") - 1;
+                dot = names[j].find(".", pos);
+                if (dot == qcc::String::npos)
+                {
+                    continue;
+                }
+                qcc::String fieldName = ToOCPropName(names[j].substr(pos, dot - pos));
+                if (structName != lastName)
+                {
+                    if (!lastName.empty())
+                    {
+                        err |= cbor_encoder_close_container(&definition, &properties);
+                        VERIFY_CBOR(err);
+                        err |= cbor_encoder_close_container(definitions, &definition);
+                        VERIFY_CBOR(err);
+                    }
+                    err |= cbor_encode_text_stringz(definitions, structName.c_str());
+                    VERIFY_CBOR(err);
+                    err |= cbor_encoder_create_map(definitions, &definition,
+                            CborIndefiniteLength);
+                    VERIFY_CBOR(err);
+                    err |= Pair(&definition, "type", "object");
+                    VERIFY_CBOR(err);
+                    err |= cbor_encode_text_stringz(&definition, "properties");
+                    VERIFY_CBOR(err);
+                    err |= cbor_encoder_create_map(&definition, &properties,
+                            CborIndefiniteLength);
+                    VERIFY_CBOR(err);
+                    lastName = structName;
+                }
+                CborEncoder prop;
+                err |= cbor_encode_text_stringz(&properties, fieldName.c_str());
+                VERIFY_CBOR(err);
+                err |= cbor_encoder_create_map(&properties, &prop, CborIndefiniteLength);
+                VERIFY_CBOR(err);
+                qcc::String min, max, def;
+                err |= GetJsonType(&prop, values[j].c_str(), min, max, def);
+                VERIFY_CBOR(err);
+                err |= cbor_encoder_close_container(&properties, &prop);
+                VERIFY_CBOR(err);
+            }
+        }
+        if (!lastName.empty())
+        {
+            err |= cbor_encoder_close_container(&definition, &properties);
+            VERIFY_CBOR(err);
+            err |= cbor_encoder_close_container(definitions, &definition);
+            VERIFY_CBOR(err);
+        }
+        lastName.clear();
+        for (size_t j = 0; j < numAnnotations; ++j)
+        {
+            if (names[j].find("org.alljoyn.Bus.Dict.") == 0)
+            {
+                size_t pos = sizeof("org.alljoyn.Bus.Dict.") - 1;
+                size_t dot = names[j].find(".", pos);
+                if (dot == qcc::String::npos)
+                {
+                    continue;
+                }
+                qcc::String dictName = names[j].substr(pos, dot - pos);
+                if (dictName != lastName)
+                {
+                    err |= cbor_encode_text_stringz(definitions, dictName.c_str());
+                    VERIFY_CBOR(err);
+                    err |= cbor_encoder_create_map(definitions, &definition, 1);
+                    VERIFY_CBOR(err);
+                    err |= Pair(&definition, "type", "object");
+                    VERIFY_CBOR(err);
+                    err |= cbor_encoder_close_container(definitions, &definition);
+                    VERIFY_CBOR(err);
+                    lastName = dictName;
+                }
+            }
+        }
+        lastName.clear();
+        CborEncoder prop;
+        for (size_t j = 0; j < numAnnotations; ++j)
+        {
+            if (names[j].find("org.alljoyn.Bus.Enum.") == 0)
+            {
+                size_t pos = sizeof("org.alljoyn.Bus.Enum.") - 1;
+                size_t dot = names[j].find_first_of('.', pos);
+                if (dot == qcc::String::npos)
+                {
+                    continue;
+                }
+                qcc::String enumName = names[j].substr(pos, dot - pos);
+                dot = names[j].find_last_of_std('.');
+                qcc::String enumValue = names[j].substr(dot + 1);
+                if (enumName != lastName)
+                {
+                    if (!lastName.empty())
+                    {
+                        err |= cbor_encoder_close_container(definitions, &prop);
+                        VERIFY_CBOR(err);
+                        err |= cbor_encoder_close_container(definitions, &definition);
+                        VERIFY_CBOR(err);
+                    }
+                    err |= cbor_encode_text_stringz(definitions, enumName.c_str());
+                    VERIFY_CBOR(err);
+                    err |= cbor_encoder_create_map(definitions, &definition,
+                            CborIndefiniteLength);
+                    VERIFY_CBOR(err);
+                    err |= cbor_encode_text_stringz(definitions, "oneOf");
+                    VERIFY_CBOR(err);
+                    err |= cbor_encoder_create_array(definitions, &prop,
+                            CborIndefiniteLength);
+                    VERIFY_CBOR(err);
+                    lastName = enumName;
+                }
+                CborEncoder enumMap;
+                err |= cbor_encoder_create_map(&prop, &enumMap, CborIndefiniteLength);
+                VERIFY_CBOR(err);
+                CborEncoder enumArr;
+                err |= cbor_encode_text_stringz(&enumMap, "enum");
+                VERIFY_CBOR(err);
+                err |= cbor_encoder_create_array(&enumMap, &enumArr, CborIndefiniteLength);
+                VERIFY_CBOR(err);
+                err |= cbor_encode_text_stringz(&enumArr, values[j].c_str());
+                VERIFY_CBOR(err);
+                err |= cbor_encoder_close_container(&enumMap, &enumArr);
+                VERIFY_CBOR(err);
+                err |= cbor_encode_text_stringz(&enumMap, "title");
+                VERIFY_CBOR(err);
+                err |= cbor_encode_text_stringz(&enumMap, enumValue.c_str());
+                VERIFY_CBOR(err);
+                err |= cbor_encoder_close_container(&prop, &enumMap);
+                VERIFY_CBOR(err);
+            }
+        }
+        if (!lastName.empty())
+        {
+            err |= cbor_encoder_close_container(definitions, &prop);
+            VERIFY_CBOR(err);
+            err |= cbor_encoder_close_container(definitions, &definition);
+            VERIFY_CBOR(err);
+        }
+    }
+
+exit:
+    delete[] names;
+    delete[] values;
+    delete[] members;
+    delete[] props;
+    return err;
+}
+
+static int64_t Definitions(CborEncoder *cbor, ajn::BusAttachment *bus,
+        const char *ajSoftwareVersion)
+{
+    size_t numIfaces = 0;
+    const ajn::InterfaceDescription **ifaces = NULL;
+    int64_t err = CborNoError;
+    CborEncoder definitions;
+    err |= cbor_encode_text_stringz(cbor, "definitions");
+    VERIFY_CBOR(err);
+    err |= cbor_encoder_create_map(cbor, &definitions, CborIndefiniteLength);
+    VERIFY_CBOR(err);
+
+    for (OCResourceHandle h : GetResourceHandles())
+    {
+        if (!(OCGetResourceProperties(h) & OC_ACTIVE))
+        {
+            continue;
+        }
+        err |= ResourceDefinition(&definitions, h);
+        VERIFY_CBOR(err);
+    }
+
+    if (bus)
+    {
+        numIfaces = bus->GetInterfaces(NULL, 0);
+        ifaces = new const ajn::InterfaceDescription*[numIfaces];
+        bus->GetInterfaces(ifaces, numIfaces);
+        for (size_t i = 0; i < numIfaces; ++i)
+        {
+            if (!TranslateInterface(ifaces[i]->GetName()))
+            {
+                continue;
+            }
+            err |= InterfaceDefinitions(&definitions, ifaces[i], ajSoftwareVersion);
+            VERIFY_CBOR(err);
+        }
+    }
+
+    err |= cbor_encoder_close_container(cbor, &definitions);
+    VERIFY_CBOR(err);
+
+exit:
+    delete[] ifaces;
+    return err;
+}
+
+CborError Introspect(ajn::BusAttachment *bus, const char *ajSoftwareVersion, const char *title,
+        const char *version, uint8_t *out, size_t *outSize)
+{
+    int64_t err = CborNoError;
+    CborEncoder encoder;
+    cbor_encoder_init(&encoder, out, *outSize, 0);
+    CborEncoder map;
+    err |= cbor_encoder_create_map(&encoder, &map, CborIndefiniteLength);
+    VERIFY_CBOR(err);
+    err |= Pair(&map, "swagger", "2.0");
+    VERIFY_CBOR(err);
+    err |= Info(&map, title, version);
+    VERIFY_CBOR(err);
+    err |= Paths(&map);
+    VERIFY_CBOR(err);
+    err |= Parameters(&map);
+    VERIFY_CBOR(err);
+    err |= Definitions(&map, bus, ajSoftwareVersion);
+    VERIFY_CBOR(err);
+    err |= cbor_encoder_close_container(&encoder, &map);
+    VERIFY_CBOR(err);
+
+exit:
+    if (err == CborErrorOutOfMemory)
+    {
+        *outSize += cbor_encoder_get_extra_bytes_needed(&encoder);
+    }
+    else if (err == CborNoError)
+    {
+        *outSize = cbor_encoder_get_buffer_size(&encoder, out);
+    }
+    return (CborError)err;
+}
+
+/* Anything in the introspection data that is not in a fragment, less title and version. */
+static const size_t INTROSPECTION_OVERHEAD = 128;
+
+/* Encodes into a buffer grown to fit. */
+static int64_t Encode(std::vector<uint8_t> &out, std::function<int64_t(CborEncoder *)> encode)
+{
+    int64_t err;
+    CborEncoder encoder;
+    out.resize(256);
+    for (;;)
+    {
+        cbor_encoder_init(&encoder, &out[0], out.size(), 0);
+        err = encode(&encoder);
+        if (err != CborErrorOutOfMemory)
         {
-            member->GetArgAnnotation(argName.c_str(), "org.alljoyn.Bus.Type.Name", sig);
+            break;
         }
-        std::string propName = GetPropName(member, argName, argN);
-        qcc::String min, max, def;
-        member->GetAnnotation("org.alljoyn.Bus.Type.Min", min);
-        member->GetAnnotation("org.alljoyn.Bus.Type.Max", max);
-        member->GetAnnotation("org.alljoyn.Bus.Type.Default", def);
-        err |= Property(cbor, propName, member->description, readOnly, sig, min, max, def);
-        VERIFY_CBOR(err);
+        out.resize(out.size() + cbor_encoder_get_extra_bytes_needed(&encoder));
+    }
+    if (err == CborNoError)
+    {
+        out.resize(cbor_encoder_get_buffer_size(&encoder, &out[0]));
+    }
+    else
+    {
+        out.clear();
     }
-exit:
     return err;
 }
 
-static int64_t Parameters(CborEncoder *cbor)
+/* Everything the fragments of resource h are encoded from. */
+static std::string GetResourceKey(OCResourceHandle h)
 {
-    OCStackResult result = OC_STACK_ERROR;
-    int64_t err = CborNoError;
-    CborEncoder parameters;
-    err |= cbor_encode_text_stringz(cbor, "parameters");
-    VERIFY_CBOR(err);
-    err |= cbor_encoder_create_map(cbor, &parameters, CborIndefiniteLength);
-    VERIFY_CBOR(err);
-    uint8_t nr;
-    result = OCGetNumberOfResources(&nr);
-    if (result != OC_STACK_OK)
-    {
-        err |= CborErrorInternalError;
-        goto exit;
-    }
-    for (uint8_t i = 0; i < nr; ++i)
+    std::string key = OCGetResourceUri(h);
+    uint8_t n;
+    if (OCGetNumberOfResourceTypes(h, &n) == OC_STACK_OK)
     {
-        OCResourceHandle h = OCGetResourceHandle(i);
-        if (!(OCGetResourceProperties(h) & OC_ACTIVE))
-        {
-            continue;
-        }
-        const char *uri = OCGetResourceUri(h);
-        if (!strcmp(uri, OC_RSRVD_RD_URI))
-        {
-            err |= append(&parameters, oic_rd_parameters,
-                    sizeof(oic_rd_parameters) / sizeof(oic_rd_parameters[0]));
-            VERIFY_CBOR(err);
-        }
-        else if (!strcmp(uri, OC_RSRVD_INTROSPECTION_URI_PATH))
+        for (uint8_t i = 0; i < n; ++i)
         {
-            err |= append(&parameters, introspection_parameters,
-                    sizeof(introspection_parameters) / sizeof(introspection_parameters[0]));
-            VERIFY_CBOR(err);
+            key += std::string("\n") + OCGetResourceTypeName(h, i);
         }
-        else if (!strcmp(uri, OC_RSRVD_SECURE_MODE_URI))
+    }
+    key += "\n";
+    if (OCGetNumberOfResourceInterfaces(h, &n) == OC_STACK_OK)
+    {
+        for (uint8_t i = 0; i < n; ++i)
         {
-            err |= append(&parameters, securemode_parameters,
-                    sizeof(securemode_parameters) / sizeof(securemode_parameters[0]));
-            VERIFY_CBOR(err);
+            key += std::string("\n") + OCGetResourceInterfaceName(h, i);
         }
     }
-    err |= cbor_encoder_close_container(cbor, &parameters);
-    VERIFY_CBOR(err);
-exit:
-    return err;
+    return key;
 }
 
-static int64_t Definitions(CborEncoder *cbor, ajn::BusAttachment *bus,
-        const char *ajSoftwareVersion)
+size_t IntrospectionCache::Update(ajn::BusAttachment *bus, const char *ajSoftwareVersion,
+        const char *title, const char *version)
 {
-    size_t numIfaces = 0;
-    const ajn::InterfaceDescription **ifaces = NULL;
-    const ajn::InterfaceDescription::Property **props = NULL;
-    const ajn::InterfaceDescription::Member **members = NULL;
-    qcc::String *names = NULL;
-    qcc::String *values = NULL;
-    OCStackResult result;
-    int64_t err = CborNoError;
-    CborEncoder definitions;
-    err |= cbor_encode_text_stringz(cbor, "definitions");
-    VERIFY_CBOR(err);
-    err |= cbor_encoder_create_map(cbor, &definitions, CborIndefiniteLength);
-    VERIFY_CBOR(err);
+    using namespace std::placeholders;
 
-    uint8_t nr;
-    result = OCGetNumberOfResources(&nr);
-    if (result != OC_STACK_OK)
+    m_numEncoded = 0;
+    if (m_ajSoftwareVersion != (ajSoftwareVersion ? ajSoftwareVersion : ""))
     {
-        err |= CborErrorInternalError;
-        goto exit;
+        m_ajSoftwareVersion = ajSoftwareVersion ? ajSoftwareVersion : "";
+        m_interfaces.clear();
     }
-    for (uint8_t i = 0; i < nr; ++i)
+    m_title = title;
+    m_version = version;
+    size_t size = INTROSPECTION_OVERHEAD + m_title.size() + m_version.size();
+
+    std::map<OCResourceHandle, Fragments> resources;
+    m_handles.clear();
+    for (OCResourceHandle h : GetResourceHandles())
     {
-        OCResourceHandle h = OCGetResourceHandle(i);
         if (!(OCGetResourceProperties(h) & OC_ACTIVE))
         {
             continue;
         }
-        const char *uri = OCGetResourceUri(h);
-        if (!strcmp(uri, OC_RSRVD_RD_URI))
-        {
-            err |= append(&definitions, oic_rd_definitions,
-                    sizeof(oic_rd_definitions) / sizeof(oic_rd_definitions[0]));
-            VERIFY_CBOR(err);
-        }
-        else if (!strcmp(uri, OC_RSRVD_INTROSPECTION_URI_PATH))
+        Fragments &fragments = resources[h];
+        std::string key = GetResourceKey(h);
+        std::map<OCResourceHandle, Fragments>::iterator it = m_resources.find(h);
+        if ((it != m_resources.end()) && (it->second.m_key == key))
         {
-            err |= append(&definitions, introspection_definitions,
-                    sizeof(introspection_definitions) / sizeof(introspection_definitions[0]));
-            VERIFY_CBOR(err);
+            std::swap(fragments, it->second);
         }
-        else if (!strcmp(uri, OC_RSRVD_SECURE_MODE_URI))
+        else
         {
-            err |= append(&definitions, securemode_definitions,
-                    sizeof(securemode_definitions) / sizeof(securemode_definitions[0]));
-            VERIFY_CBOR(err);
+            if ((Encode(fragments.m_path, std::bind(Path, _1, h)) == CborNoError) &&
+                    (Encode(fragments.m_parameter, std::bind(Parameter, _1, h)) == CborNoError) &&
+                    (Encode(fragments.m_definition, std::bind(ResourceDefinition, _1, h)) ==
+                            CborNoError))
+            {
+                fragments.m_key = key;
+            }
+            else
+            {
+                LOG(LOG_ERR, "Failed to encode %s", OCGetResourceUri(h));
+            }
+            ++m_numEncoded;
         }
+        m_handles.push_back(h);
+        size += fragments.m_path.size() + fragments.m_parameter.size() +
+                fragments.m_definition.size();
     }
+    m_resources.swap(resources);
 
+    std::map<const ajn::InterfaceDescription *, Fragments> interfaces;
+    m_ifaces.clear();
     if (bus)
     {
-        numIfaces = bus->GetInterfaces(NULL, 0);
-        ifaces = new const ajn::InterfaceDescription*[numIfaces];
+        size_t numIfaces = bus->GetInterfaces(NULL, 0);
+        const ajn::InterfaceDescription **ifaces = new const ajn::InterfaceDescription*[numIfaces];
         bus->GetInterfaces(ifaces, numIfaces);
         for (size_t i = 0; i < numIfaces; ++i)
         {
@@ -795,433 +1386,71 @@ static int64_t Definitions(CborEncoder *cbor, ajn::BusAttachment *bus,
             {
                 continue;
             }
-            size_t numProps = ifaces[i]->GetProperties(NULL, 0);
-            props = new const ajn::InterfaceDescription::Property*[numProps];
-            ifaces[i]->GetProperties(props, numProps);
-            static const char *emitsChangedValues[] =
-                    { "const", "false", "true", "invalidates", NULL };
-            for (const char **emitsChanged = emitsChangedValues; *emitsChanged; ++emitsChanged)
+            Fragments &fragments = interfaces[ifaces[i]];
+            std::map<const ajn::InterfaceDescription *, Fragments>::iterator it =
+                    m_interfaces.find(ifaces[i]);
+            if ((it != m_interfaces.end()) && (it->second.m_key == ifaceName))
             {
-                bool hasProps = false;
-                CborEncoder definition;
-                CborEncoder properties;
-                uint8_t access = NONE;
-                std::string rt = GetResourceTypeName(ifaces[i], *emitsChanged);
-                for (size_t j = 0; j < numProps; ++j)
-                {
-                    qcc::String emitsChangedValue = (props[j]->name == "Version") ? "const" : "false";
-                    props[j]->GetAnnotation(::ajn::org::freedesktop::DBus::AnnotateEmitsChanged,
-                            emitsChangedValue);
-                    if (emitsChangedValue != *emitsChanged)
-                    {
-                        continue;
-                    }
-                    if (!hasProps)
-                    {
-                        err |= cbor_encode_text_stringz(&definitions, rt.c_str());
-                        VERIFY_CBOR(err);
-                        err |= cbor_encoder_create_map(&definitions, &definition,
-                                CborIndefiniteLength);
-                        VERIFY_CBOR(err);
-                        err |= Pair(&definition, "type", "object");
-                        VERIFY_CBOR(err);
-                        err |= cbor_encode_text_stringz(&definition, "properties");
-                        VERIFY_CBOR(err);
-                        err |= cbor_encoder_create_map(&definition, &properties,
-                                CborIndefiniteLength);
-                        VERIFY_CBOR(err);
-                        hasProps = true;
-                    }
-                    std::string propName = GetPropName(ifaces[i], emitsChangedValue + "." +
-                            ToOCPropName(props[j]->name));
-                    /*
-                     * Annotations prior to v16.10.00 are not guaranteed to
-                     * appear in the order they were specified, so are
-                     * unreliable.
-                     */
-                    qcc::String signature = props[j]->signature;
-                    if (strcmp(ajSoftwareVersion, "v16.10.00") >= 0)
-                    {
-                        props[j]->GetAnnotation("org.alljoyn.Bus.Type.Name", signature);
-                    }
-                    qcc::String min, max, def;
-                    props[j]->GetAnnotation("org.alljoyn.Bus.Type.Min", min);
-                    props[j]->GetAnnotation("org.alljoyn.Bus.Type.Max", max);
-                    props[j]->GetAnnotation("org.alljoyn.Bus.Type.Default", def);
-                    err  |= Property(&properties, propName, props[j]->description,
-                            (props[j]->access == ajn::PROP_ACCESS_READ), signature, min, max, def);
-                    VERIFY_CBOR(err);
-                    switch (props[j]->access)
-                    {
-                        case ajn::PROP_ACCESS_RW:
-                        case ajn::PROP_ACCESS_WRITE:
-                            access |= READWRITE;
-                            break;
-                        case ajn::PROP_ACCESS_READ:
-                            access |= READ;
-                            break;
-                    }
-                }
-                if (hasProps)
-                {
-                    CborEncoder rtMap;
-                    err |= cbor_encode_text_stringz(&properties, "rt");
-                    VERIFY_CBOR(err);
-                    err |= cbor_encoder_create_map(&properties, &rtMap, CborIndefiniteLength);
-                    VERIFY_CBOR(err);
-                    err |= cbor_encode_text_stringz(&rtMap, "readOnly");
-                    VERIFY_CBOR(err);
-                    err |= cbor_encode_boolean(&rtMap, true);
-                    VERIFY_CBOR(err);
-                    err |= Pair(&rtMap, "type", "array");
-                    VERIFY_CBOR(err);
-                    CborEncoder def;
-                    err |= cbor_encode_text_stringz(&rtMap, "default");
-                    VERIFY_CBOR(err);
-                    err |= cbor_encoder_create_array(&rtMap, &def, 1);
-                    VERIFY_CBOR(err);
-                    err |= cbor_encode_text_stringz(&def, rt.c_str());
-                    VERIFY_CBOR(err);
-                    err |= cbor_encoder_close_container(&rtMap, &def);
-                    VERIFY_CBOR(err);
-                    err |= cbor_encoder_close_container(&properties, &rtMap);
-                    VERIFY_CBOR(err);
-                    CborEncoder ifMap;
-                    err |= cbor_encode_text_stringz(&properties, "if");
-                    VERIFY_CBOR(err);
-                    err |= cbor_encoder_create_map(&properties, &ifMap, CborIndefiniteLength);
-                    VERIFY_CBOR(err);
-                    err |= cbor_encode_text_stringz(&ifMap, "readOnly");
-                    VERIFY_CBOR(err);
-                    err |= cbor_encode_boolean(&ifMap, true);
-                    VERIFY_CBOR(err);
-                    err |= Pair(&ifMap, "type", "array");
-                    VERIFY_CBOR(err);
-                    CborEncoder items;
-                    err |= cbor_encode_text_stringz(&ifMap, "items");
-                    VERIFY_CBOR(err);
-                    err |= cbor_encoder_create_map(&ifMap, &items, 2);
-                    VERIFY_CBOR(err);
-                    err |= Pair(&items, "type", "string");
-                    VERIFY_CBOR(err);
-                    CborEncoder enumArr;
-                    err |= cbor_encode_text_stringz(&items, "enum");
-                    VERIFY_CBOR(err);
-                    err |= cbor_encoder_create_array(&items, &enumArr, CborIndefiniteLength);
-                    VERIFY_CBOR(err);
-                    err |= cbor_encode_text_stringz(&enumArr, "oic.if.baseline");
-                    VERIFY_CBOR(err);
-                    if (access & READ)
-                    {
-                        err |= cbor_encode_text_stringz(&enumArr, "oic.if.r");
-                        VERIFY_CBOR(err);
-                    }
-                    if (access & READWRITE)
-                    {
-                        err |= cbor_encode_text_stringz(&enumArr, "oic.if.rw");
-                        VERIFY_CBOR(err);
-                    }
-                    err |= cbor_encoder_close_container(&items, &enumArr);
-                    VERIFY_CBOR(err);
-                    err |= cbor_encoder_close_container(&ifMap, &items);
-                    VERIFY_CBOR(err);
-                    err |= cbor_encoder_close_container(&properties, &ifMap);
-                    VERIFY_CBOR(err);
-                    err |= cbor_encoder_close_container(&definition, &properties);
-                    VERIFY_CBOR(err);
-                    err |= cbor_encoder_close_container(&definitions, &definition);
-                    VERIFY_CBOR(err);
-                }
+                std::swap(fragments, it->second);
             }
-            delete[] props;
-            props = NULL;
-            size_t numMembers = ifaces[i]->GetMembers(NULL, 0);
-            members = new const ajn::InterfaceDescription::Member*[numMembers];
-            ifaces[i]->GetMembers(members, numMembers);
-            for (size_t j = 0; j < numMembers; ++j)
+            else
             {
-                std::string rt = GetResourceTypeName(ifaces[i], members[j]->name);
-                CborEncoder definition;
-                err |= cbor_encode_text_stringz(&definitions, rt.c_str());
-                VERIFY_CBOR(err);
-                err |= cbor_encoder_create_map(&definitions, &definition, CborIndefiniteLength);
-                VERIFY_CBOR(err);
-                err |= Pair(&definition, "type", "object");
-                VERIFY_CBOR(err);
-                CborEncoder properties;
-                err |= cbor_encode_text_stringz(&definition, "properties");
-                VERIFY_CBOR(err);
-                err |= cbor_encoder_create_map(&definition, &properties, CborIndefiniteLength);
-                VERIFY_CBOR(err);
-                std::string propName = GetPropName(members[j], "validity");
-                CborEncoder prop;
-                err |= cbor_encode_text_stringz(&properties, propName.c_str());
-                VERIFY_CBOR(err);
-                err |= cbor_encoder_create_map(&properties, &prop, CborIndefiniteLength);
-                VERIFY_CBOR(err);
-                if (members[j]->memberType == ajn::MESSAGE_SIGNAL)
-                {
-                    err |= cbor_encode_text_stringz(&prop, "readOnly");
-                    VERIFY_CBOR(err);
-                    err |= cbor_encode_boolean(&prop, true);
-                    VERIFY_CBOR(err);
-                }
-                err |= Pair(&prop, "type", "boolean");
-                VERIFY_CBOR(err);
-                err |= cbor_encoder_close_container(&properties, &prop);
-                VERIFY_CBOR(err);
-                size_t argN = 0;
-                err |= Properties(&properties, ajSoftwareVersion, members[j],
-                        members[j]->signature.c_str(), argN,
-                        (members[j]->memberType == ajn::MESSAGE_SIGNAL));
-                VERIFY_CBOR(err);
-                err |= Properties(&properties, ajSoftwareVersion, members[j],
-                        members[j]->returnSignature.c_str(), argN, true);
-                VERIFY_CBOR(err);
-                err |= cbor_encode_text_stringz(&properties, "rt");
-                VERIFY_CBOR(err);
-                err |= cbor_encoder_create_map(&properties, &prop, CborIndefiniteLength);
-                VERIFY_CBOR(err);
-                err |= cbor_encode_text_stringz(&prop, "readOnly");
-                VERIFY_CBOR(err);
-                err |= cbor_encode_boolean(&prop, true);
-                VERIFY_CBOR(err);
-                err |= Pair(&prop, "type", "array");
-                VERIFY_CBOR(err);
-                CborEncoder def;
-                err |= cbor_encode_text_stringz(&prop, "default");
-                VERIFY_CBOR(err);
-                err |= cbor_encoder_create_array(&prop, &def, 1);
-                VERIFY_CBOR(err);
-                err |= cbor_encode_text_stringz(&def, rt.c_str());
-                VERIFY_CBOR(err);
-                err |= cbor_encoder_close_container(&prop, &def);
-                VERIFY_CBOR(err);
-                err |= cbor_encoder_close_container(&properties, &prop);
-                VERIFY_CBOR(err);
-                err |= cbor_encode_text_stringz(&properties, "if");
-                VERIFY_CBOR(err);
-                err |= cbor_encoder_create_map(&properties, &prop, CborIndefiniteLength);
-                VERIFY_CBOR(err);
-                err |= cbor_encode_text_stringz(&prop, "readOnly");
-                VERIFY_CBOR(err);
-                err |= cbor_encode_boolean(&prop, true);
-                VERIFY_CBOR(err);
-                err |= Pair(&prop, "type", "array");
-                VERIFY_CBOR(err);
-                CborEncoder items;
-                err |= cbor_encode_text_stringz(&prop, "items");
-                VERIFY_CBOR(err);
-                err |= cbor_encoder_create_map(&prop, &items, 2);
-                VERIFY_CBOR(err);
-                err |= Pair(&items, "type", "string");
-                VERIFY_CBOR(err);
-                CborEncoder enumArr;
-                err |= cbor_encode_text_stringz(&items, "enum");
-                VERIFY_CBOR(err);
-                err |= cbor_encoder_create_array(&items, &enumArr, CborIndefiniteLength);
-                VERIFY_CBOR(err);
-                err |= cbor_encode_text_stringz(&enumArr, "oic.if.baseline");
-                VERIFY_CBOR(err);
-                if (members[j]->memberType == ajn::MESSAGE_SIGNAL)
+                if (Encode(fragments.m_definition, std::bind(InterfaceDefinitions, _1, ifaces[i],
+                        m_ajSoftwareVersion.c_str())) == CborNoError)
                 {
-                    err |= cbor_encode_text_stringz(&enumArr, "oic.if.r");
-                    VERIFY_CBOR(err);
+                    fragments.m_key = ifaceName;
                 }
                 else
                 {
-                    err |= cbor_encode_text_stringz(&enumArr, "oic.if.rw");
-                    VERIFY_CBOR(err);
-                }
-                err |= cbor_encoder_close_container(&items, &enumArr);
-                VERIFY_CBOR(err);
-                err |= cbor_encoder_close_container(&prop, &items);
-                VERIFY_CBOR(err);
-                err |= cbor_encoder_close_container(&properties, &prop);
-                VERIFY_CBOR(err);
-                err |= cbor_encoder_close_container(&definition, &properties);
-                VERIFY_CBOR(err);
-                err |= cbor_encoder_close_container(&definitions, &definition);
-                VERIFY_CBOR(err);
-            }
-            delete[] members;
-            members = NULL;
-            if (strcmp(ajSoftwareVersion, "v16.10.00") >= 0)
-            {
-                size_t numAnnotations = ifaces[i]->GetAnnotations();
-                names = new qcc::String[numAnnotations];
-                values = new qcc::String[numAnnotations];
-                ifaces[i]->GetAnnotations(names, values, numAnnotations);
-                CborEncoder definition;
-                CborEncoder properties;
-                qcc::String lastName;
-                for (size_t j = 0; j < numAnnotations; ++j)
-                {
-                    if (names[j].find("org.alljoyn.Bus.Struct.") == 0)
-                    {
-                        size_t pos = sizeof("org.alljoyn.Bus.Struct.") - 1;
-                        size_t dot = names[j].find(".", pos);
-                        if (dot == qcc::String::npos)
-                        {
-                            continue;
-                        }
-                        qcc::String structName = names[j].substr(pos, dot - pos);
-                        pos = dot + sizeof(".Field.") - 1;
-                        dot = names[j].find(".", pos);
-                        if (dot == qcc::String::npos)
-                        {
-                            continue;
-                        }
-                        qcc::String fieldName = ToOCPropName(names[j].substr(pos, dot - pos));
-                        if (structName != lastName)
-                        {
-                            if (!lastName.empty())
-                            {
-                                err |= cbor_encoder_close_container(&definition, &properties);
-                                VERIFY_CBOR(err);
-                                err |= cbor_encoder_close_container(&definitions, &definition);
-                                VERIFY_CBOR(err);
-                            }
-                            err |= cbor_encode_text_stringz(&definitions, structName.c_str());
-                            VERIFY_CBOR(err);
-                            err |= cbor_encoder_create_map(&definitions, &definition,
-                                    CborIndefiniteLength);
-                            VERIFY_CBOR(err);
-                            err |= Pair(&definition, "type", "object");
-                            VERIFY_CBOR(err);
-                            err |= cbor_encode_text_stringz(&definition, "properties");
-                            VERIFY_CBOR(err);
-                            err |= cbor_encoder_create_map(&definition, &properties,
-                                    CborIndefiniteLength);
-                            VERIFY_CBOR(err);
-                            lastName = structName;
-                        }
-                        CborEncoder prop;
-                        err |= cbor_encode_text_stringz(&properties, fieldName.c_str());
-                        VERIFY_CBOR(err);
-                        err |= cbor_encoder_create_map(&properties, &prop, CborIndefiniteLength);
-                        VERIFY_CBOR(err);
-                        qcc::String min, max, def;
-                        err |= GetJsonType(&prop, values[j].c_str(), min, max, def);
-                        VERIFY_CBOR(err);
-                        err |= cbor_encoder_close_container(&properties, &prop);
-                        VERIFY_CBOR(err);
-                    }
-                }
-                if (!lastName.empty())
-                {
-                    err |= cbor_encoder_close_container(&definition, &properties);
-                    VERIFY_CBOR(err);
-                    err |= cbor_encoder_close_container(&definitions, &definition);
-                    VERIFY_CBOR(err);
-                }
-                lastName.clear();
-                for (size_t j = 0; j < numAnnotations; ++j)
-                {
-                    if (names[j].find("org.alljoyn.Bus.Dict.") == 0)
-                    {
-                        size_t pos = sizeof("org.alljoyn.Bus.Dict.") - 1;
-                        size_t dot = names[j].find(".", pos);
-                        if (dot == qcc::String::npos)
-                        {
-                            continue;
-                        }
-                        qcc::String dictName = names[j].substr(pos, dot - pos);
-                        if (dictName != lastName)
-                        {
-                            err |= cbor_encode_text_stringz(&definitions, dictName.c_str());
-                            VERIFY_CBOR(err);
-                            err |= cbor_encoder_create_map(&definitions, &definition, 1);
-                            VERIFY_CBOR(err);
-                            err |= Pair(&definition, "type", "object");
-                            VERIFY_CBOR(err);
-                            err |= cbor_encoder_close_container(&definitions, &definition);
-                            VERIFY_CBOR(err);
-                            lastName = dictName;
-                        }
-                    }
-                }
-                lastName.clear();
-                CborEncoder prop;
-                for (size_t j = 0; j < numAnnotations; ++j)
-                {
-                    if (names[j].find("org.alljoyn.Bus.Enum.") == 0)
-                    {
-                        size_t pos = sizeof("org.alljoyn.Bus.Enum.") - 1;
-                        size_t dot = names[j].find_first_of('.', pos);
-                        if (dot == qcc::String::npos)
-                        {
-                            continue;
-                        }
-                        qcc::String enumName = names[j].substr(pos, dot - pos);
-                        dot = names[j].find_last_of_std('.');
-                        qcc::String enumValue = names[j].substr(dot + 1);
-                        if (enumName != lastName)
-                        {
-                            if (!lastName.empty())
-                            {
-                                err |= cbor_encoder_close_container(&definitions, &prop);
-                                VERIFY_CBOR(err);
-                                err |= cbor_encoder_close_container(&definitions, &definition);
-                                VERIFY_CBOR(err);
-                            }
-                            err |= cbor_encode_text_stringz(&definitions, enumName.c_str());
-                            VERIFY_CBOR(err);
-                            err |= cbor_encoder_create_map(&definitions, &definition,
-                                    CborIndefiniteLength);
-                            VERIFY_CBOR(err);
-                            err |= cbor_encode_text_stringz(&definitions, "oneOf");
-                            VERIFY_CBOR(err);
-                            err |= cbor_encoder_create_array(&definitions, &prop,
-                                    CborIndefiniteLength);
-                            VERIFY_CBOR(err);
-                            lastName = enumName;
-                        }
-                        CborEncoder enumMap;
-                        err |= cbor_encoder_create_map(&prop, &enumMap, CborIndefiniteLength);
-                        VERIFY_CBOR(err);
-                        CborEncoder enumArr;
-                        err |= cbor_encode_text_stringz(&enumMap, "enum");
-                        VERIFY_CBOR(err);
-                        err |= cbor_encoder_create_array(&enumMap, &enumArr, CborIndefiniteLength);
-                        VERIFY_CBOR(err);
-                        err |= cbor_encode_text_stringz(&enumArr, values[j].c_str());
-                        VERIFY_CBOR(err);
-                        err |= cbor_encoder_close_container(&enumMap, &enumArr);
-                        VERIFY_CBOR(err);
-                        err |= cbor_encode_text_stringz(&enumMap, "title");
-                        VERIFY_CBOR(err);
-                        err |= cbor_encode_text_stringz(&enumMap, enumValue.c_str());
-                        VERIFY_CBOR(err);
-                        err |= cbor_encoder_close_container(&prop, &enumMap);
-                        VERIFY_CBOR(err);
-                    }
-                }
-                if (!lastName.empty())
-                {
-                    err |= cbor_encoder_close_container(&definitions, &prop);
-                    VERIFY_CBOR(err);
-                    err |= cbor_encoder_close_container(&definitions, &definition);
-                    VERIFY_CBOR(err);
+                    LOG(LOG_ERR, "Failed to encode %s", ifaceName);
                 }
+                ++m_numEncoded;
             }
+            m_ifaces.push_back(ifaces[i]);
+            size += fragments.m_definition.size();
         }
+        delete[] ifaces;
     }
+    m_interfaces.swap(interfaces);
 
-    err |= cbor_encoder_close_container(cbor, &definitions);
-    VERIFY_CBOR(err);
+    LOG(LOG_INFO, "[%p] numEncoded=%zu,size=%zu", this, m_numEncoded, size);
+    return size;
+}
 
+int64_t IntrospectionCache::Section(CborEncoder *cbor, const char *key,
+        std::vector<uint8_t> Fragments::*fragment, bool hasInterfaces)
+{
+    int64_t err = CborNoError;
+    CborEncoder section;
+    err |= cbor_encode_text_stringz(cbor, key);
+    VERIFY_CBOR(err);
+    err |= cbor_encoder_create_map(cbor, &section, CborIndefiniteLength);
+    VERIFY_CBOR(err);
+    for (OCResourceHandle h : m_handles)
+    {
+        std::vector<uint8_t> &cached = m_resources[h].*fragment;
+        if (!cached.empty())
+        {
+            err |= append(&section, &cached[0], cached.size());
+            VERIFY_CBOR(err);
+        }
+    }
+    for (size_t i = 0; hasInterfaces && (i < m_ifaces.size()); ++i)
+    {
+        std::vector<uint8_t> &cached = m_interfaces[m_ifaces[i]].*fragment;
+        if (!cached.empty())
+        {
+            err |= append(&section, &cached[0], cached.size());
+            VERIFY_CBOR(err);
+        }
+    }
+    err |= cbor_encoder_close_container(cbor, &section);
+    VERIFY_CBOR(err);
 exit:
-    delete[] names;
-    delete[] values;
-    delete[] members;
-    delete[] props;
-    delete[] ifaces;
     return err;
 }
 
-CborError Introspect(ajn::BusAttachment *bus, const char *ajSoftwareVersion, const char *title,
-        const char *version, uint8_t *out, size_t *outSize)
+CborError IntrospectionCache::Introspect(uint8_t *out, size_t *outSize)
 {
     int64_t err = CborNoError;
     CborEncoder encoder;
@@ -1231,13 +1460,13 @@ CborError Introspect(ajn::BusAttachment *bus, const char *ajSoftwareVersion, con
     VERIFY_CBOR(err);
     err |= Pair(&map, "swagger", "2.0");
     VERIFY_CBOR(err);
-    err |= Info(&map, title, version);
+    err |= Info(&map, m_title.c_str(), m_version.c_str());
     VERIFY_CBOR(err);
-    err |= Paths(&map);
+    err |= Section(&map, "paths", &Fragments::m_path, false);
     VERIFY_CBOR(err);
-    err |= Parameters(&map);
+    err |= Section(&map, "parameters", &Fragments::m_parameter, false);
     VERIFY_CBOR(err);
-    err |= Definitions(&map, bus, ajSoftwareVersion);
+    err |= Section(&map, "definitions", &Fragments::m_definition, true);
     VERIFY_CBOR(err);
     err |= cbor_encoder_close_container(&encoder, &map);
     VERIFY_CBOR(err);
@@ -1563,8 +1792,8 @@ error:
     return NULL;
 }
 
-OCRepPayload *IntrospectPath(std::vector<std::string> &resourceTypes,
-        std::vector<std::string> &interfaces)
+OCRepPayload *IntrospectPath(const std::vector<std::string> &resourceTypes,
+        const std::vector<std::string> &interfaces)
 {
     OCRepPayload *path = NULL;
     OCRepPayload *method = NULL;
@@ -1622,7 +1851,7 @@ OCRepPayload *IntrospectPath(std::vector<std::string> &resourceTypes,
     for (size_t i = 0; i < interfaces.size(); ++i)
     {
         /* Filter out read-only interfaces from post method */
-        std::string &itf = interfaces[i];
+        const std::string &itf = interfaces[i];
         if (itf == "oic.if.ll" || itf == "oic.if.r" || itf == "oic.if.s")
         {
             continue;
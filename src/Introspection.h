@@ -27,6 +27,9 @@
 #include "octypes.h"
 #include <alljoyn/BusAttachment.h>
 #include <iostream>
+#include <map>
+#include <string>
+#include <vector>
 
 class Device;
 class VirtualBusAttachment;
@@ -48,6 +51,53 @@ typedef std::vector<Annotation> Annotations;
 CborError Introspect(ajn::BusAttachment *bus, const char *ajSoftwareVersion, const char *title,
         const char *version, uint8_t *out, size_t *outSize);
 
+/*
+ * Holds the CBOR-encoded introspection fragments of each resource and translatable AJ interface
+ * so that regenerating the introspection data only encodes what changed since the last time.
+ */
+class IntrospectionCache
+{
+    public:
+        IntrospectionCache() : m_numEncoded(0) { }
+
+        /*
+         * Encodes the fragments of any resources or interfaces added or changed since the last
+         * call and drops those that are gone.
+         *
+         * @return the size of the buffer needed by Introspect().
+         */
+        size_t Update(ajn::BusAttachment *bus, const char *ajSoftwareVersion, const char *title,
+                const char *version);
+
+        /*
+         * Creates CBOR-encoded introspection data from the fragments cached by Update().
+         */
+        CborError Introspect(uint8_t *out, size_t *outSize);
+
+        /* @return the number of resources and interfaces encoded by the last Update(). */
+        size_t GetNumEncoded() const { return m_numEncoded; }
+
+    private:
+        struct Fragments
+        {
+            std::string m_key;
+            std::vector<uint8_t> m_path;
+            std::vector<uint8_t> m_parameter;
+            std::vector<uint8_t> m_definition;
+        };
+        std::string m_ajSoftwareVersion;
+        std::string m_title;
+        std::string m_version;
+        std::map<OCResourceHandle, Fragments> m_resources;
+        std::map<const ajn::InterfaceDescription *, Fragments> m_interfaces;
+        std::vector<OCResourceHandle> m_handles;
+        std::vector<const ajn::InterfaceDescription *> m_ifaces;
+        size_t m_numEncoded;
+
+        int64_t Section(CborEncoder *cbor, const char *key,
+                std::vector<uint8_t> Fragments::*fragment, bool hasInterfaces);
+};
+
 /*
  * Creates an introspection definition object from a GET request payload.
  *
@@ -68,8 +118,8 @@ OCRepPayload *IntrospectDefinition(OCRepPayload *payload, std::string resourceTy
  *
  * @return a path object
  */
-OCRepPayload *IntrospectPath(std::vector<std::string> &resourceTypes,
-        std::vector<std::string> &interfaces);
+OCRepPayload *IntrospectPath(const std::vector<std::string> &resourceTypes,
+        const std::vector<std::string> &interfaces);
 
 /*
  * @param[in] device the device the OC introspection data is from.
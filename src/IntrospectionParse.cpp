@@ -49,6 +49,59 @@ static const char *GetRefDefinition(const char *ref)
     return NULL;
 }
 
+/*
+ * Unlike OCRepPayloadGetProp*(), the accessors below return pointers into payload instead of
+ * copies so that walking large introspection data does not clone its subtrees.
+ */
+
+static const OCRepPayloadValue *GetValue(const OCRepPayload *payload, const char *name,
+        OCRepPayloadPropType type)
+{
+    for (const OCRepPayloadValue *value = payload->values; value; value = value->next)
+    {
+        if (!strcmp(value->name, name))
+        {
+            return (value->type == type) ? value : NULL;
+        }
+    }
+    return NULL;
+}
+
+static const OCRepPayload *GetObject(const OCRepPayload *payload, const char *name)
+{
+    const OCRepPayloadValue *value = GetValue(payload, name, OCREP_PROP_OBJECT);
+    return value ? value->obj : NULL;
+}
+
+static const char *GetString(const OCRepPayload *payload, const char *name)
+{
+    const OCRepPayloadValue *value = GetValue(payload, name, OCREP_PROP_STRING);
+    return value ? value->str : NULL;
+}
+
+static bool GetDouble(const OCRepPayload *payload, const char *name, double *d)
+{
+    const OCRepPayloadValue *value;
+    if ((value = GetValue(payload, name, OCREP_PROP_DOUBLE)))
+    {
+        *d = value->d;
+        return true;
+    }
+    else if ((value = GetValue(payload, name, OCREP_PROP_INT)))
+    {
+        *d = value->i;
+        return true;
+    }
+    return false;
+}
+
+static const OCRepPayloadValueArray *GetArray(const OCRepPayload *payload, const char *name,
+        OCRepPayloadPropType type)
+{
+    const OCRepPayloadValue *value = GetValue(payload, name, OCREP_PROP_ARRAY);
+    return (value && (value->arr.type == type)) ? &value->arr : NULL;
+}
+
 /*
  * @param[in] schema a schema definition object.
  * @param[in] annotations map from definition name to AJ annotations
@@ -57,24 +110,21 @@ static const char *GetRefDefinition(const char *ref)
  *
  * @return a pair<D-Bus signature, org.alljoyn.Bus.Type.Name>
  */
-static std::pair<std::string, std::string> GetSignature(OCRepPayload *schema,
+static std::pair<std::string, std::string> GetSignature(const OCRepPayload *schema,
         std::map<std::string, Annotations> &annotations, OCRepPayloadPropType *type = NULL)
 {
     if (type)
     {
         *type = OCREP_PROP_NULL;
     }
-    char **typeArr = NULL;
-    size_t dim[MAX_REP_ARRAY_DEPTH] = { 0 };
-    char *str = NULL;
+    const char *str = NULL;
     const char *ref = NULL;
     std::pair<std::string, std::string> sig;
-    if (OCRepPayloadGetStringArray(schema, "type", &typeArr, dim))
+    if (GetArray(schema, "type", OCREP_PROP_STRING))
     {
         sig.first = "v";
     }
-    else if (OCRepPayloadGetPropString(schema, "$ref", &str) &&
-            (ref = GetRefDefinition(str)))
+    else if ((str = GetString(schema, "$ref")) && (ref = GetRefDefinition(str)))
     {
         Annotations &as = annotations[ref];
         if (!as.empty())
@@ -100,7 +150,7 @@ static std::pair<std::string, std::string> GetSignature(OCRepPayload *schema,
             sig.second = std::string("[") + ref + "]";
         }
     }
-    else if (OCRepPayloadGetPropString(schema, "type", &str))
+    else if ((str = GetString(schema, "type")))
     {
         if (!strcmp(str, "boolean"))
         {
@@ -110,8 +160,8 @@ static std::pair<std::string, std::string> GetSignature(OCRepPayload *schema,
         {
             double min = MIN_SAFE_INTEGER;
             double max = MAX_SAFE_INTEGER;
-            OCRepPayloadGetPropDouble(schema, "minimum", &min);
-            OCRepPayloadGetPropDouble(schema, "maximum", &max);
+            GetDouble(schema, "minimum", &min);
+            GetDouble(schema, "maximum", &max);
             if (min >= 0 && max <= UINT8_MAX)
             {
                 sig.first = "y";
@@ -147,13 +197,10 @@ static std::pair<std::string, std::string> GetSignature(OCRepPayload *schema,
         }
         else if (!strcmp(str, "string"))
         {
-            char *pattern = NULL;
-            char *format = NULL;
-            OCRepPayload *media = NULL;
-            char *encoding = NULL;
-            OCRepPayloadGetPropString(schema, "pattern", &pattern);
-            OCRepPayloadGetPropString(schema, "format", &format);
-            OCRepPayloadGetPropObject(schema, "media", &media);
+            const char *pattern = GetString(schema, "pattern");
+            const char *format = GetString(schema, "format");
+            const OCRepPayload *media = GetObject(schema, "media");
+            const char *encoding = NULL;
             if ((pattern && !strcmp(pattern, "^0([1-9][0-9]{0,19})$")) ||
                     (format && !strcmp(format, "uint64")))
             {
@@ -173,7 +220,7 @@ static std::pair<std::string, std::string> GetSignature(OCRepPayload *schema,
                 }
             }
             else if ((pattern && !strcmp(pattern, "^[a-fA-F0-9]{8}-[a-fA-F0-9]{4}-[a-fA-F0-9]{4}-[a-fA-F0-9]{4}-[a-fA-F0-9]{12}$")) ||
-                    (media && OCRepPayloadGetPropString(media, "binaryEncoding", &encoding) &&
+                    (media && (encoding = GetString(media, "binaryEncoding")) &&
                             !strcmp(encoding, "base64")))
             {
                 sig.first = "ay";
@@ -182,15 +229,12 @@ static std::pair<std::string, std::string> GetSignature(OCRepPayload *schema,
             {
                 sig.first = "s";
             }
-            OICFree(encoding);
-            OCRepPayloadDestroy(media);
-            OICFree(format);
         }
         else if (!strcmp(str, "object"))
         {
             sig.first = "a{sv}";
-            OCRepPayload *properties = NULL;
-            if (OCRepPayloadGetPropObject(schema, "properties", &properties))
+            const OCRepPayload *properties = GetObject(schema, "properties");
+            if (properties)
             {
                 std::string dictName = Types::GenerateAnonymousName();
                 for (OCRepPayloadValue *property = properties->values; property;
@@ -212,14 +256,12 @@ static std::pair<std::string, std::string> GetSignature(OCRepPayload *schema,
                 }
                 sig.second = dictName;
             }
-            OCRepPayloadDestroy(properties);
         }
         else if (!strcmp(str, "array"))
         {
-            OCRepPayload *items = NULL;
-            OCRepPayload **itemsArr = NULL;
-            size_t itemsDim[MAX_REP_ARRAY_DEPTH] = { 0 };
-            if (OCRepPayloadGetPropObject(schema, "items", &items))
+            const OCRepPayload *items = NULL;
+            const OCRepPayloadValueArray *itemsArr = NULL;
+            if ((items = GetObject(schema, "items")))
             {
                 std::pair<std::string, std::string> itemSig = GetSignature(items, annotations);
                 sig.first = "a" + itemSig.first;
@@ -227,26 +269,25 @@ static std::pair<std::string, std::string> GetSignature(OCRepPayload *schema,
                 {
                     sig.second = "a" + itemSig.second;
                 }
-                OCRepPayloadDestroy(items);
             }
-            else if (OCRepPayloadGetPropObjectArray(schema, "items", &itemsArr, itemsDim))
+            else if ((itemsArr = GetArray(schema, "items", OCREP_PROP_OBJECT)))
             {
                 /*
                  * Potentially have a struct here, confirm first that there are a fixed number of
                  * items.
                   */
                 double minItems, maxItems;
-                size_t dimTotal = calcDimTotal(itemsDim);
-                if (OCRepPayloadGetPropDouble(schema, "minItems", &minItems) &&
-                        OCRepPayloadGetPropDouble(schema, "maxItems", &maxItems) &&
+                size_t dimTotal = calcDimTotal(itemsArr->dimensions);
+                if (GetDouble(schema, "minItems", &minItems) &&
+                        GetDouble(schema, "maxItems", &maxItems) &&
                         ((minItems == maxItems) || (maxItems == dimTotal)))
                 {
                     sig.first = "(";
                     sig.second = "(";
                     for (size_t i = 0; i < dimTotal; ++i)
                     {
-                        std::pair<std::string, std::string> itemSig = GetSignature(itemsArr[i],
-                                annotations);
+                        std::pair<std::string, std::string> itemSig =
+                                GetSignature(itemsArr->objArray[i], annotations);
                         sig.first += itemSig.first;
                         sig.second += !itemSig.second.empty() ? itemSig.second : itemSig.first;
                     }
@@ -261,11 +302,6 @@ static std::pair<std::string, std::string> GetSignature(OCRepPayload *schema,
                 {
                     sig.first = "av";
                 }
-                for (size_t i = 0; i < dimTotal; ++i)
-                {
-                    OCRepPayloadDestroy(itemsArr[i]);
-                }
-                OICFree(itemsArr);
             }
             else
             {
@@ -281,13 +317,6 @@ static std::pair<std::string, std::string> GetSignature(OCRepPayload *schema,
     {
         LOG(LOG_INFO, "Missing \"$ref\" or \"type\" property");
     }
-    size_t dimTotal = calcDimTotal(dim);
-    for (size_t i = 0; i < dimTotal; ++i)
-    {
-        OICFree(typeArr[i]);
-    }
-    OICFree(typeArr);
-    OICFree(str);
     return sig;
 }
 
@@ -296,34 +325,32 @@ static std::pair<std::string, std::string> GetSignature(OCRepPayload *schema,
  * @param[in] annotations map from definition name to AJ annotations.
  * @param[in,out] iface the AJ iface to add annotations to.
  */
-static void AddAnnotations(const char *name, OCRepPayload *schema,
+static void AddAnnotations(const char *name, const OCRepPayload *schema,
         std::map<std::string, Annotations> &annotations, ajn::InterfaceDescription *iface)
 {
-    char *str = NULL;
+    const char *str = NULL;
     const char *ref = NULL;
-    if (OCRepPayloadGetPropString(schema, "$ref", &str) &&
-            (ref = GetRefDefinition(str)))
+    if ((str = GetString(schema, "$ref")) && (ref = GetRefDefinition(str)))
     {
         for (Annotation &a : annotations[ref])
         {
             iface->AddAnnotation(a.first, a.second);
         }
     }
-    else if (OCRepPayloadGetPropString(schema, "type", &str))
+    else if ((str = GetString(schema, "type")))
     {
         if (!strcmp(str, "array"))
         {
-            OCRepPayload *items = NULL;
-            if (OCRepPayloadGetPropObject(schema, "items", &items))
+            const OCRepPayload *items = GetObject(schema, "items");
+            if (items)
             {
                 AddAnnotations(name, items, annotations, iface);
-                OCRepPayloadDestroy(items);
             }
         }
         else
         {
             double d;
-            if (OCRepPayloadGetPropDouble(schema, "default", &d) &&
+            if (GetDouble(schema, "default", &d) &&
                     (floor(d) == d))
             {
                 iface->AddPropertyAnnotation(name, "org.alljoyn.Bus.Type.Default",
@@ -331,13 +358,13 @@ static void AddAnnotations(const char *name, OCRepPayload *schema,
             }
             double min = MIN_SAFE_INTEGER;
             double max = MAX_SAFE_INTEGER;
-            if ((OCRepPayloadGetPropDouble(schema, "maximum", &max) && (floor(max) == max)) ||
+            if ((GetDouble(schema, "maximum", &max) && (floor(max) == max)) ||
                     !strcmp(str, "integer"))
             {
                 iface->AddPropertyAnnotation(name, "org.alljoyn.Bus.Type.Max",
                         (max > 0) ? std::to_string((uint64_t) max) : std::to_string((int64_t) max));
             }
-            if ((OCRepPayloadGetPropDouble(schema, "minimum", &min) && (floor(min) == min)) ||
+            if ((GetDouble(schema, "minimum", &min) && (floor(min) == min)) ||
                     !strcmp(str, "integer"))
             {
                 iface->AddPropertyAnnotation(name, "org.alljoyn.Bus.Type.Min",
@@ -345,7 +372,6 @@ static void AddAnnotations(const char *name, OCRepPayload *schema,
             }
         }
     }
-    OICFree(str);
 }
 
 /*
@@ -354,7 +380,7 @@ static void AddAnnotations(const char *name, OCRepPayload *schema,
  * @param[in] annotations map from definition name to AJ annotations.
  * @param[in,out] iface the AJ iface to add annotations to.
  */
-static void AddProperty(OCRepPayloadValue *property, bool isObservable,
+static void AddProperty(const OCRepPayloadValue *property, bool isObservable,
         std::map<std::string, Annotations> &annotations, ajn::InterfaceDescription *iface)
 {
     std::pair<std::string, std::string> sig = GetSignature(property->obj, annotations);
@@ -364,8 +390,8 @@ static void AddProperty(OCRepPayloadValue *property, bool isObservable,
         return;
     }
     uint8_t access = ajn::PROP_ACCESS_RW;
-    bool readOnly;
-    if (OCRepPayloadGetPropBool(property->obj, "readOnly", &readOnly) && readOnly)
+    const OCRepPayloadValue *readOnly = GetValue(property->obj, "readOnly", OCREP_PROP_BOOL);
+    if (readOnly && readOnly->b)
     {
         access = ajn::PROP_ACCESS_READ;
     }
@@ -418,7 +444,7 @@ static void AddInterface(const char *refValue, std::map<std::string, std::string
  * @param[in] ajNames a map from definition name to interface name.
  * @param[in,out] obj the AJ bus object to add interfaces to.
  */
-static void AddInterface(OCRepPayload *schema, std::map<std::string, std::string> &ajNames,
+static void AddInterface(const OCRepPayload *schema, std::map<std::string, std::string> &ajNames,
         VirtualBusObject *obj)
 {
     if (!schema->values)
@@ -457,42 +483,50 @@ static void ParseAnnotations(const OCRepPayload *definitions,
             LOG(LOG_INFO, "%s unknown type %d, skipping", definition->name, definition->type);
             continue;
         }
-        size_t dim[MAX_REP_ARRAY_DEPTH] = { 0 };
-        OCRepPayload **oneOf = NULL;
-        char *type = NULL;
-        if (OCRepPayloadGetPropObjectArray(definition->obj, "oneOf", &oneOf, dim))
+        const OCRepPayloadValueArray *oneOf = NULL;
+        const char *type = NULL;
+        if ((oneOf = GetArray(definition->obj, "oneOf", OCREP_PROP_OBJECT)))
         {
-            size_t dimTotal = calcDimTotal(dim);
+            size_t dimTotal = calcDimTotal(oneOf->dimensions);
             for (size_t i = 0; i < dimTotal; ++i)
             {
-                char *enumName = NULL;
-                double *enumValue = NULL;
-                size_t dimEnumValue[MAX_REP_ARRAY_DEPTH] = { 0 };
-                if (OCRepPayloadGetPropString(oneOf[i], "title", &enumName) &&
-                        OCRepPayloadGetDoubleArray(oneOf[i], "enum", &enumValue, dimEnumValue) &&
-                        (calcDimTotal(dimEnumValue) == 1))
+                const char *enumName = GetString(oneOf->objArray[i], "title");
+                const OCRepPayloadValueArray *enumValue;
+                int64_t value;
+                if (!enumName)
+                {
+                    continue;
+                }
+                if ((enumValue = GetArray(oneOf->objArray[i], "enum", OCREP_PROP_INT)) &&
+                        (calcDimTotal(enumValue->dimensions) == 1))
+                {
+                    value = enumValue->iArray[0];
+                }
+                else if ((enumValue = GetArray(oneOf->objArray[i], "enum", OCREP_PROP_DOUBLE)) &&
+                        (calcDimTotal(enumValue->dimensions) == 1))
                 {
-                    std::string Enum = EnumPrefix + definition->name;
                     /* Assume enum value is in range of an int64_t */
-                    annotations[definition->name].push_back(Annotation(Enum + ".Value." + enumName,
-                            std::to_string((int64_t) enumValue[0])));
+                    value = (int64_t) enumValue->dArray[0];
                 }
-                OICFree(enumValue);
-                OICFree(enumName);
+                else
+                {
+                    continue;
+                }
+                std::string Enum = EnumPrefix + definition->name;
+                annotations[definition->name].push_back(Annotation(Enum + ".Value." + enumName,
+                        std::to_string(value)));
             }
         }
-        else if (OCRepPayloadGetPropString(definition->obj, "type", &type) &&
-                !strcmp(type, "object"))
+        else if ((type = GetString(definition->obj, "type")) && !strcmp(type, "object"))
         {
-            OCRepPayload *properties = NULL;
-            OCRepPayload *rt = NULL;
-            if (!OCRepPayloadGetPropObject(definition->obj, "properties", &properties))
+            const OCRepPayload *properties = GetObject(definition->obj, "properties");
+            if (!properties)
             {
                 std::string Dict = DictPrefix + definition->name;
                 annotations[definition->name].push_back(Annotation(Dict + ".Key.Type", "s"));
                 annotations[definition->name].push_back(Annotation(Dict + ".Value.Type", "v"));
             }
-            else if (!OCRepPayloadGetPropObject(properties, "rt", &rt))
+            else if (!GetObject(properties, "rt"))
             {
                 for (OCRepPayloadValue *property = properties->values; property;
                      property = property->next)
@@ -517,23 +551,11 @@ static void ParseAnnotations(const OCRepPayload *definitions,
                     }
                 }
             }
-            OCRepPayloadDestroy(rt);
-            OCRepPayloadDestroy(properties);
         }
         else
         {
             LOG(LOG_INFO, "%s unsupported \"type\" value \"%s\", skipping", definition->name, type);
         }
-        OICFree(type);
-        if (oneOf)
-        {
-            size_t dimTotal = calcDimTotal(dim);
-            for(size_t i = 0; i < dimTotal; ++i)
-            {
-                OCRepPayloadDestroy(oneOf[i]);
-            }
-        }
-        OICFree(oneOf);
     }
 }
 
@@ -556,46 +578,45 @@ static void ParseInterfaces(const OCRepPayload *definitions,
             LOG(LOG_INFO, "%s unknown type %d, skipping", definition->name, definition->type);
             continue;
         }
-        OCRepPayload *properties = NULL;
-        OCRepPayload *rt = NULL;
-        char **rts = NULL;
-        size_t rtsDim[MAX_REP_ARRAY_DEPTH] = { 0 };
+        const OCRepPayload *properties = NULL;
+        const OCRepPayload *rt = NULL;
+        const OCRepPayloadValueArray *rts = NULL;
         std::string ifaceName;
         ajn::InterfaceDescription *iface = NULL;
-        if (!OCRepPayloadGetPropObject(definition->obj, "properties", &properties))
+        if (!(properties = GetObject(definition->obj, "properties")))
         {
             LOG(LOG_INFO, "%s missing \"properties\", skipping", definition->name);
-            goto next_iface;
+            continue;
         }
-        if (!OCRepPayloadGetPropObject(properties, "rt", &rt))
+        if (!(rt = GetObject(properties, "rt")))
         {
             LOG(LOG_INFO, "%s missing \"rt\" property, skipping", definition->name);
-            goto next_iface;
+            continue;
         }
-        if (!OCRepPayloadGetStringArray(rt, "default", &rts, rtsDim) || !rtsDim[0])
+        if (!(rts = GetArray(rt, "default", OCREP_PROP_STRING)) || !rts->dimensions[0])
         {
             LOG(LOG_INFO, "%s missing or empty \"default\" property, skipping", definition->name);
-            goto next_iface;
+            continue;
         }
-        if (IsResourceTypeInWellDefinedSet(rts[0]))
+        if (IsResourceTypeInWellDefinedSet(rts->strArray[0]))
         {
-            LOG(LOG_INFO, "Skipping well-defined %s resource type", rts[0]);
-            goto next_iface;
+            LOG(LOG_INFO, "Skipping well-defined %s resource type", rts->strArray[0]);
+            continue;
         }
-        ifaceName = ToAJName(rts[0]);
+        ifaceName = ToAJName(rts->strArray[0]);
         ajNames[definition->name] = ifaceName;
         bus->CreateInterface(ifaceName.c_str(), iface, ajn::AJ_IFC_SECURITY_INHERIT);
         if (!iface)
         {
             LOG(LOG_ERR, "CreateInterface %s failed", ifaceName.c_str());
-            goto next_iface;
+            continue;
         }
         LOG(LOG_INFO, "Created interface %s", ifaceName.c_str());
         if (strstr(ifaceName.c_str(), "oic.d.") == ifaceName.c_str())
         {
             /* Device types are translated as empty interfaces */
             iface->Activate();
-            goto next_iface;
+            continue;
         }
         for (OCRepPayloadValue *property = properties->values; property; property = property->next)
         {
@@ -618,21 +639,9 @@ static void ParseInterfaces(const OCRepPayload *definitions,
                 /* Ignore baseline properties */
                 continue;
             }
-            AddProperty(property, isObservable[rts[0]], annotations, iface);
+            AddProperty(property, isObservable[rts->strArray[0]], annotations, iface);
         }
         iface->Activate();
-    next_iface:
-        size_t dimTotal = calcDimTotal(rtsDim);
-        for (size_t i = 0; i < dimTotal; ++i)
-        {
-            OICFree(rts[i]);
-        }
-        OICFree(rts);
-        rts = NULL;
-        OCRepPayloadDestroy(rt);
-        rt = NULL;
-        OCRepPayloadDestroy(properties);
-        properties = NULL;
     }
 }
 
@@ -643,7 +652,7 @@ static void ParseInterfaces(const OCRepPayload *definitions,
  *
  * @note obj must be a VirtualBusObject (and not an ajn::BusObject) as AddInterface is protected.
  */
-static void ParsePath(OCRepPayload *path, std::map<std::string, std::string> &ajNames,
+static void ParsePath(const OCRepPayload *path, std::map<std::string, std::string> &ajNames,
         VirtualBusObject *obj)
 {
     for (OCRepPayloadValue *method = path->values; method; method = method->next)
@@ -666,14 +675,11 @@ static void ParsePath(OCRepPayload *path, std::map<std::string, std::string> &aj
                 }
                 for (size_t i = 0; i < value->arr.dimensions[0]; ++i)
                 {
-                    OCRepPayload *schema = NULL;
-                    if (OCRepPayloadGetPropObject(value->arr.objArray[i], "schema",
-                            &schema))
+                    const OCRepPayload *schema = GetObject(value->arr.objArray[i], "schema");
+                    if (schema)
                     {
                         AddInterface(schema, ajNames, obj);
                     }
-                    OCRepPayloadDestroy(schema);
-                    schema = NULL;
                 }
             }
             else if (!strcmp(value->name, "responses"))
@@ -710,8 +716,8 @@ static void ParsePath(OCRepPayload *path, std::map<std::string, std::string> &aj
 bool ParseIntrospectionPayload(Device *device, VirtualBusAttachment *bus,
         const OCRepPayload *payload)
 {
-    OCRepPayload *definitions = NULL;
-    OCRepPayload *paths = NULL;
+    const OCRepPayload *definitions = NULL;
+    const OCRepPayload *paths = NULL;
     Resource *resource;
     std::map<std::string, bool> isObservable;
     std::map<std::string, Annotations> annotations;
@@ -744,19 +750,17 @@ bool ParseIntrospectionPayload(Device *device, VirtualBusAttachment *bus,
      * Create AJ interfaces from OC definitions.  Look for annotations first since they will be
      * needed by interface definitions.
      */
-    if (!OCRepPayloadGetPropObject(payload, "definitions", &definitions))
+    if (!(definitions = GetObject(payload, "definitions")))
     {
         goto exit;
     }
     ParseAnnotations(definitions, annotations);
     ParseInterfaces(definitions, annotations, isObservable, bus, ajNames);
-    OCRepPayloadDestroy(definitions);
-    definitions = NULL;
 
     /*
      * Create virtual bus objects from OC paths.
      */
-    if (!OCRepPayloadGetPropObject(payload, "paths", &paths))
+    if (!(paths = GetObject(payload, "paths")))
     {
         goto exit;
     }
@@ -764,8 +768,8 @@ bool ParseIntrospectionPayload(Device *device, VirtualBusAttachment *bus,
          it != device->m_resources.end(); ++it)
     {
         const char *uri = it->m_uri.c_str();
-        OCRepPayload *path = NULL;
-        if (!OCRepPayloadGetPropObject(paths, uri, &path))
+        const OCRepPayload *path = GetObject(paths, uri);
+        if (!path)
         {
             continue;
         }
@@ -799,13 +803,12 @@ bool ParseIntrospectionPayload(Device *device, VirtualBusAttachment *bus,
             for (std::vector<Resource>::iterator jt = it->m_resources.begin();
                  jt != it->m_resources.end(); ++jt)
             {
-                OCRepPayload *childPath = NULL;
-                if (!OCRepPayloadGetPropObject(paths, jt->m_uri.c_str(), &childPath))
+                const OCRepPayload *childPath = GetObject(paths, jt->m_uri.c_str());
+                if (!childPath)
                 {
                     continue;
                 }
                 ParsePath(childPath, ajNames, obj);
-                OCRepPayloadDestroy(childPath);
             }
             status = bus->RegisterBusObject(obj, it->IsSecure());
             if (status != ER_OK)
@@ -813,10 +816,7 @@ bool ParseIntrospectionPayload(Device *device, VirtualBusAttachment *bus,
                 delete obj;
             }
         }
-        OCRepPayloadDestroy(path);
     }
-    OCRepPayloadDestroy(paths);
-    paths = NULL;
 
     /* Done */
     resource = device->GetResourceUri(OC_RSRVD_DEVICE_URI);
@@ -840,7 +840,5 @@ bool ParseIntrospectionPayload(Device *device, VirtualBusAttachment *bus,
     success = true;
 
 exit:
-    OCRepPayloadDestroy(paths);
-    OCRepPayloadDestroy(definitions);
     return success;
 }
@@ -0,0 +1,229 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "Metrics.h"
+
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+#include <mutex>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+const unsigned Histogram::SUB_BUCKET_BITS;
+const unsigned Histogram::SUB_BUCKETS;
+const unsigned Histogram::NUM_BUCKETS;
+
+struct Registry
+{
+    std::mutex m_mutex;
+    std::vector<Metric *> m_metrics;
+};
+
+/* Constructed on first use since metrics are registered during static initialization */
+static Registry &GetRegistry()
+{
+    static Registry *sRegistry = new Registry();
+    return *sRegistry;
+}
+
+Metric::Metric(const char *name, Type type)
+    : m_name(name), m_type(type)
+{
+    Registry &registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.m_mutex);
+    registry.m_metrics.push_back(this);
+}
+
+Metric::~Metric()
+{
+    Registry &registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.m_mutex);
+    registry.m_metrics.erase(std::remove(registry.m_metrics.begin(), registry.m_metrics.end(),
+            this), registry.m_metrics.end());
+}
+
+void Counter::Get(Snapshot *snapshot) const
+{
+    snapshot->m_value = Get();
+}
+
+void Counter::Reset()
+{
+    m_value.store(0, std::memory_order_relaxed);
+}
+
+void Gauge::Get(Snapshot *snapshot) const
+{
+    snapshot->m_value = Get();
+}
+
+Histogram::Histogram(const char *name)
+    : Metric(name, HISTOGRAM)
+{
+    Reset();
+}
+
+unsigned Histogram::GetBucket(uint64_t value)
+{
+    if (value < SUB_BUCKETS)
+    {
+        return value;
+    }
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    unsigned exponent = index;
+#else
+    unsigned exponent = 63 - __builtin_clzll(value);
+#endif
+    unsigned subBucket = (value >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1);
+    return ((exponent - SUB_BUCKET_BITS + 1) << SUB_BUCKET_BITS) + subBucket;
+}
+
+uint64_t Histogram::GetBucketMax(unsigned bucket)
+{
+    if (bucket < SUB_BUCKETS)
+    {
+        return bucket;
+    }
+    unsigned exponent = (bucket >> SUB_BUCKET_BITS) + SUB_BUCKET_BITS - 1;
+    unsigned shift = exponent - SUB_BUCKET_BITS;
+    uint64_t min = (uint64_t) (SUB_BUCKETS + (bucket & (SUB_BUCKETS - 1))) << shift;
+    return min + ((UINT64_C(1) << shift) - 1);
+}
+
+void Histogram::Record(uint64_t value)
+{
+    m_buckets[GetBucket(value)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(value, std::memory_order_relaxed);
+    uint64_t max = m_max.load(std::memory_order_relaxed);
+    while ((value > max) &&
+            !m_max.compare_exchange_weak(max, value, std::memory_order_relaxed))
+    {
+    }
+}
+
+uint64_t Histogram::GetPercentile(double p) const
+{
+    uint64_t count = 0;
+    for (unsigned i = 0; i < NUM_BUCKETS; ++i)
+    {
+        count += m_buckets[i].load(std::memory_order_relaxed);
+    }
+    if (!count)
+    {
+        return 0;
+    }
+    uint64_t rank = (uint64_t) ceil((p / 100.0) * count);
+    rank = std::max(rank, (uint64_t) 1);
+    uint64_t seen = 0;
+    for (unsigned i = 0; i < NUM_BUCKETS; ++i)
+    {
+        seen += m_buckets[i].load(std::memory_order_relaxed);
+        if (seen >= rank)
+        {
+            return std::min(GetBucketMax(i), m_max.load(std::memory_order_relaxed));
+        }
+    }
+    return m_max.load(std::memory_order_relaxed);
+}
+
+void Histogram::Get(Snapshot *snapshot) const
+{
+    snapshot->m_count = m_count.load(std::memory_order_relaxed);
+    snapshot->m_sum = m_sum.load(std::memory_order_relaxed);
+    snapshot->m_max = m_max.load(std::memory_order_relaxed);
+    snapshot->m_p50 = GetPercentile(50);
+    snapshot->m_p90 = GetPercentile(90);
+    snapshot->m_p99 = GetPercentile(99);
+}
+
+void Histogram::Reset()
+{
+    for (unsigned i = 0; i < NUM_BUCKETS; ++i)
+    {
+        m_buckets[i].store(0, std::memory_order_relaxed);
+    }
+    m_count.store(0, std::memory_order_relaxed);
+    m_sum.store(0, std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+}
+
+ScopedTimer::ScopedTimer(Histogram &histogram)
+    : m_histogram(histogram), m_start(MetricsNow())
+{
+}
+
+ScopedTimer::~ScopedTimer()
+{
+    m_histogram.Record(MetricsNow() - m_start);
+}
+
+MeteredLock::MeteredLock(std::mutex &mutex, Histogram &waits)
+    : std::unique_lock<std::mutex>(mutex, std::try_to_lock)
+{
+    if (!owns_lock())
+    {
+        uint64_t start = MetricsNow();
+        lock();
+        waits.Record(MetricsNow() - start);
+    }
+}
+
+uint64_t MetricsNow()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static bool CompareSnapshots(const Metric::Snapshot &a, const Metric::Snapshot &b)
+{
+    return a.m_name < b.m_name;
+}
+
+std::vector<Metric::Snapshot> SnapshotMetrics()
+{
+    std::vector<Metric::Snapshot> snapshots;
+    Registry &registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.m_mutex);
+    for (Metric *metric : registry.m_metrics)
+    {
+        Metric::Snapshot snapshot;
+        snapshot.m_name = metric->GetName();
+        snapshot.m_type = metric->GetType();
+        metric->Get(&snapshot);
+        snapshots.push_back(snapshot);
+    }
+    std::sort(snapshots.begin(), snapshots.end(), CompareSnapshots);
+    return snapshots;
+}
+
+void ResetMetrics()
+{
+    Registry &registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.m_mutex);
+    for (Metric *metric : registry.m_metrics)
+    {
+        metric->Reset();
+    }
+}
@@ -0,0 +1,165 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#ifndef _METRICS_H
+#define _METRICS_H
+
+#include <atomic>
+#include <inttypes.h>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/*
+ * Counters, gauges, and latency histograms kept by the bridge and exposed by the
+ * MetricsResource and the MetricsBusObject.
+ *
+ * Metrics are usually declared static in the module that updates them and register themselves
+ * by name on construction.  Updates are lock-free and may be made from any thread.
+ */
+class Metric
+{
+    public:
+        enum Type { COUNTER, GAUGE, HISTOGRAM };
+
+        struct Snapshot {
+            std::string m_name;
+            Type m_type;
+            /* The value of a COUNTER or GAUGE */
+            int64_t m_value;
+            /* The number, sum, maximum, and percentiles of the values recorded by a HISTOGRAM */
+            uint64_t m_count;
+            uint64_t m_sum;
+            uint64_t m_max;
+            uint64_t m_p50;
+            uint64_t m_p90;
+            uint64_t m_p99;
+            Snapshot() : m_type(COUNTER), m_value(0), m_count(0), m_sum(0), m_max(0), m_p50(0),
+                m_p90(0), m_p99(0) { }
+        };
+
+        Metric(const char *name, Type type);
+        virtual ~Metric();
+        const char *GetName() const { return m_name; }
+        Type GetType() const { return m_type; }
+        virtual void Get(Snapshot *snapshot) const = 0;
+        virtual void Reset() = 0;
+
+    private:
+        const char *m_name;
+        Type m_type;
+
+        Metric(const Metric &);
+        Metric &operator=(const Metric &);
+};
+
+class Counter : public Metric
+{
+    public:
+        Counter(const char *name) : Metric(name, COUNTER), m_value(0) { }
+        void Increment(uint64_t n = 1) { m_value.fetch_add(n, std::memory_order_relaxed); }
+        uint64_t Get() const { return m_value.load(std::memory_order_relaxed); }
+        virtual void Get(Snapshot *snapshot) const;
+        virtual void Reset();
+
+    private:
+        std::atomic<uint64_t> m_value;
+};
+
+/*
+ * A level, such as the number of pending requests, that is not cleared by Reset().  It is
+ * either kept up to date with Increment() and Decrement() or sampled with Set().
+ */
+class Gauge : public Metric
+{
+    public:
+        Gauge(const char *name) : Metric(name, GAUGE), m_value(0) { }
+        void Increment() { m_value.fetch_add(1, std::memory_order_relaxed); }
+        void Decrement() { m_value.fetch_sub(1, std::memory_order_relaxed); }
+        void Set(int64_t value) { m_value.store(value, std::memory_order_relaxed); }
+        int64_t Get() const { return m_value.load(std::memory_order_relaxed); }
+        virtual void Get(Snapshot *snapshot) const;
+        virtual void Reset() { }
+
+    private:
+        std::atomic<int64_t> m_value;
+};
+
+/*
+ * A log-linear histogram: each power of two is split into 2^SUB_BUCKET_BITS buckets, so a
+ * percentile is reported to within 1/2^SUB_BUCKET_BITS of the recorded value.
+ */
+class Histogram : public Metric
+{
+    public:
+        static const unsigned SUB_BUCKET_BITS = 3;
+        static const unsigned SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+        static const unsigned NUM_BUCKETS = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+        Histogram(const char *name);
+        void Record(uint64_t value);
+        uint64_t GetCount() const { return m_count.load(std::memory_order_relaxed); }
+        /* Returns the highest value of the bucket holding the p-th percentile, 0 < p <= 100. */
+        uint64_t GetPercentile(double p) const;
+        virtual void Get(Snapshot *snapshot) const;
+        virtual void Reset();
+
+        static unsigned GetBucket(uint64_t value);
+        static uint64_t GetBucketMax(unsigned bucket);
+
+    private:
+        std::atomic<uint64_t> m_buckets[NUM_BUCKETS];
+        std::atomic<uint64_t> m_count;
+        std::atomic<uint64_t> m_sum;
+        std::atomic<uint64_t> m_max;
+};
+
+/* Records the lifetime of the object into a histogram in nanoseconds. */
+class ScopedTimer
+{
+    public:
+        ScopedTimer(Histogram &histogram);
+        ~ScopedTimer();
+
+    private:
+        Histogram &m_histogram;
+        uint64_t m_start;
+};
+
+/*
+ * Locks a mutex like std::unique_lock.  When the mutex is contended, the time spent waiting for
+ * it is recorded into a histogram in nanoseconds; uncontended acquisitions are not recorded.
+ */
+class MeteredLock : public std::unique_lock<std::mutex>
+{
+    public:
+        MeteredLock(std::mutex &mutex, Histogram &waits);
+};
+
+/* Monotonic time in nanoseconds, for measuring latencies. */
+uint64_t MetricsNow();
+
+/* Returns all registered metrics, sorted by name. */
+std::vector<Metric::Snapshot> SnapshotMetrics();
+
+/* Clears the counters and histograms.  Gauges are left unchanged. */
+void ResetMetrics();
+
+#endif
@@ -0,0 +1,112 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "MetricsBusObject.h"
+
+#include "Log.h"
+#include "Metrics.h"
+#include <alljoyn/BusAttachment.h>
+#include <assert.h>
+
+const char *MetricsBusObject::PATH = "/Bridge/Metrics";
+const char *MetricsBusObject::INTERFACE_NAME = "org.iotivity.Bridge.Metrics";
+
+static const char *InterfaceXml =
+        "<interface name='org.iotivity.Bridge.Metrics'>"
+        "  <method name='Reset'/>"
+        "  <method name='Snapshot'>"
+        "    <arg name='metrics' type='a{sv}' direction='out'/>"
+        "  </method>"
+        "</interface>";
+
+MetricsBusObject::MetricsBusObject(ajn::BusAttachment *bus)
+    : ajn::BusObject(PATH)
+{
+    LOG(LOG_INFO, "[%p] bus=%p", this, bus);
+    QStatus status;
+    (void)(status); /* Unused in release build */
+    status = bus->CreateInterfacesFromXml(InterfaceXml);
+    assert(status == ER_OK);
+    const ajn::InterfaceDescription *iface = bus->GetInterface(INTERFACE_NAME);
+    assert(iface);
+    AddInterface(*iface);
+    const MethodEntry methodEntries[] =
+    {
+        { iface->GetMember("Reset"), static_cast<MessageReceiver::MethodHandler>(&MetricsBusObject::Reset) },
+        { iface->GetMember("Snapshot"), static_cast<MessageReceiver::MethodHandler>(&MetricsBusObject::Snapshot) },
+    };
+    AddMethodHandlers(methodEntries, sizeof(methodEntries) / sizeof(methodEntries[0]));
+}
+
+MetricsBusObject::~MetricsBusObject()
+{
+    LOG(LOG_INFO, "[%p]", this);
+}
+
+void MetricsBusObject::Snapshot(const ajn::InterfaceDescription::Member *member,
+        ajn::Message &msg)
+{
+    LOG(LOG_INFO, "[%p] member=%p", this, member);
+
+    std::vector<Metric::Snapshot> snapshots = SnapshotMetrics();
+    std::vector<ajn::MsgArg> values(snapshots.size());
+    std::vector<ajn::MsgArg> entries(snapshots.size());
+    for (size_t i = 0; i < snapshots.size(); ++i)
+    {
+        const Metric::Snapshot &snapshot = snapshots[i];
+        if (snapshot.m_type == Metric::HISTOGRAM)
+        {
+            ajn::MsgArg fields[6];
+            fields[0].Set("{st}", "count", snapshot.m_count);
+            fields[1].Set("{st}", "sum", snapshot.m_sum);
+            fields[2].Set("{st}", "max", snapshot.m_max);
+            fields[3].Set("{st}", "p50", snapshot.m_p50);
+            fields[4].Set("{st}", "p90", snapshot.m_p90);
+            fields[5].Set("{st}", "p99", snapshot.m_p99);
+            values[i].Set("a{st}", 6, fields);
+            /* fields goes out of scope before the reply is sent */
+            values[i].Stabilize();
+        }
+        else
+        {
+            values[i].Set("x", snapshot.m_value);
+        }
+        entries[i].Set("{sv}", snapshot.m_name.c_str(), &values[i]);
+    }
+    ajn::MsgArg arg;
+    arg.Set("a{sv}", entries.size(), entries.empty() ? NULL : &entries[0]);
+    QStatus status = MethodReply(msg, &arg, 1);
+    if (status != ER_OK)
+    {
+        LOG(LOG_ERR, "MethodReply - %s", QCC_StatusText(status));
+    }
+}
+
+void MetricsBusObject::Reset(const ajn::InterfaceDescription::Member *member, ajn::Message &msg)
+{
+    LOG(LOG_INFO, "[%p] member=%p", this, member);
+
+    ResetMetrics();
+    QStatus status = MethodReply(msg);
+    if (status != ER_OK)
+    {
+        LOG(LOG_ERR, "MethodReply - %s", QCC_StatusText(status));
+    }
+}
@@ -0,0 +1,45 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#ifndef _METRICSBUSOBJECT_H
+#define _METRICSBUSOBJECT_H
+
+#include <alljoyn/BusObject.h>
+
+/*
+ * Exposes the bridge metrics on the bridge's own bus attachment.  Snapshot returns the same
+ * metrics as the MetricsResource, with histograms as a{st} of count, sum, max, p50, p90, and
+ * p99.
+ */
+class MetricsBusObject : public ajn::BusObject
+{
+    public:
+        static const char *PATH;
+        static const char *INTERFACE_NAME;
+
+        MetricsBusObject(ajn::BusAttachment *bus);
+        virtual ~MetricsBusObject();
+
+    private:
+        void Snapshot(const ajn::InterfaceDescription::Member *member, ajn::Message &msg);
+        void Reset(const ajn::InterfaceDescription::Member *member, ajn::Message &msg);
+};
+
+#endif
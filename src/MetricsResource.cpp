@@ -0,0 +1,137 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "MetricsResource.h"
+
+#include "Log.h"
+#include "Resource.h"
+#include "ocpayload.h"
+#include "ocstack.h"
+
+MetricsResource::MetricsResource()
+    : m_handle(NULL)
+{
+}
+
+MetricsResource::~MetricsResource()
+{
+    DeleteResource(m_handle);
+}
+
+OCStackResult MetricsResource::Create()
+{
+    return CreateResource(&m_handle, OC_RSRVD_BRIDGE_METRICS_URI,
+            OC_RSRVD_RESOURCE_TYPE_BRIDGE_METRICS, OC_RSRVD_INTERFACE_READ_WRITE,
+            MetricsResource::EntityHandlerCB, this, OC_DISCOVERABLE | OC_SECURE);
+}
+
+bool MetricsResource::SetMetrics(OCRepPayload *payload,
+        const std::vector<Metric::Snapshot> &snapshots)
+{
+    bool success = true;
+    for (size_t i = 0; success && i < snapshots.size(); ++i)
+    {
+        const Metric::Snapshot &snapshot = snapshots[i];
+        const char *name = snapshot.m_name.c_str();
+        switch (snapshot.m_type)
+        {
+            case Metric::COUNTER:
+            case Metric::GAUGE:
+                success = OCRepPayloadSetPropInt(payload, name, snapshot.m_value);
+                break;
+            case Metric::HISTOGRAM:
+                {
+                    OCRepPayload *histogram = OCRepPayloadCreate();
+                    success = histogram &&
+                            OCRepPayloadSetPropInt(histogram, "count", snapshot.m_count) &&
+                            OCRepPayloadSetPropInt(histogram, "sum", snapshot.m_sum) &&
+                            OCRepPayloadSetPropInt(histogram, "max", snapshot.m_max) &&
+                            OCRepPayloadSetPropInt(histogram, "p50", snapshot.m_p50) &&
+                            OCRepPayloadSetPropInt(histogram, "p90", snapshot.m_p90) &&
+                            OCRepPayloadSetPropInt(histogram, "p99", snapshot.m_p99) &&
+                            OCRepPayloadSetPropObjectAsOwner(payload, name, histogram);
+                    if (!success)
+                    {
+                        OCRepPayloadDestroy(histogram);
+                    }
+                    break;
+                }
+        }
+    }
+    return success;
+}
+
+OCEntityHandlerResult MetricsResource::EntityHandlerCB(OCEntityHandlerFlag flag,
+        OCEntityHandlerRequest *request, void *ctx)
+{
+    LOG(LOG_INFO, "[%p] flag=%x,request=%p,ctx=%p", ctx, flag, request, ctx);
+    if (!IsValidRequest(request))
+    {
+        LOG(LOG_INFO, "Invalid request received");
+        return OC_EH_BAD_REQ;
+    }
+
+    bool reset = false;
+    OCEntityHandlerResult result;
+    switch (request->method)
+    {
+        case OC_REST_POST:
+            if (!request->payload || request->payload->type != PAYLOAD_TYPE_REPRESENTATION ||
+                    !OCRepPayloadGetPropBool((OCRepPayload *) request->payload, "reset", &reset))
+            {
+                result = OC_EH_BAD_REQ;
+                break;
+            }
+            /* FALLTHROUGH */
+        case OC_REST_GET:
+            {
+                OCEntityHandlerResponse response;
+                memset(&response, 0, sizeof(response));
+                response.requestHandle = request->requestHandle;
+                response.resourceHandle = request->resource;
+                OCRepPayload *payload = CreatePayload(request->resource, request->query);
+                bool success = payload && SetMetrics(payload, SnapshotMetrics());
+                if (reset)
+                {
+                    ResetMetrics();
+                }
+                if (!success)
+                {
+                    OCRepPayloadDestroy(payload);
+                    result = OC_EH_ERROR;
+                    break;
+                }
+                result = OC_EH_OK;
+                response.ehResult = result;
+                response.payload = reinterpret_cast<OCPayload *>(payload);
+                OCStackResult doResult = OCDoResponse(&response);
+                if (doResult != OC_STACK_OK)
+                {
+                    LOG(LOG_ERR, "OCDoResponse - %d", doResult);
+                    OCRepPayloadDestroy(payload);
+                }
+                break;
+            }
+        default:
+            result = OC_EH_METHOD_NOT_ALLOWED;
+            break;
+    }
+    return result;
+}
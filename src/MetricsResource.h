@@ -0,0 +1,56 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#ifndef _METRICSRESOURCE_H
+#define _METRICSRESOURCE_H
+
+#include "Metrics.h"
+#include "octypes.h"
+#include <vector>
+
+#define OC_RSRVD_RESOURCE_TYPE_BRIDGE_METRICS "x.org.iotivity.bridge.metrics"
+
+#define OC_RSRVD_BRIDGE_METRICS_URI "/bridge/metrics"
+
+/*
+ * GET returns a snapshot of the metrics, POST with "reset" set to true resets them and
+ * returns the snapshot taken before the reset.
+ */
+class MetricsResource
+{
+public:
+    MetricsResource();
+    ~MetricsResource();
+    OCStackResult Create();
+
+    /*
+     * Counters and gauges are integer properties named after the metric, histograms are
+     * objects with count, sum, max, p50, p90, and p99 properties.
+     */
+    static bool SetMetrics(OCRepPayload *payload, const std::vector<Metric::Snapshot> &snapshots);
+
+private:
+    OCResourceHandle m_handle;
+
+    static OCEntityHandlerResult EntityHandlerCB(OCEntityHandlerFlag flag,
+            OCEntityHandlerRequest *request, void *ctx);
+};
+
+#endif
@@ -0,0 +1,107 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "ModelCache.h"
+
+#include "Interfaces.h"
+#include "Log.h"
+#include "ocpayload.h"
+#include <algorithm>
+#include <string.h>
+
+static std::string Join(std::vector<std::string> strs)
+{
+    std::sort(strs.begin(), strs.end());
+    std::string joined;
+    for (const std::string &str : strs)
+    {
+        if (!joined.empty())
+        {
+            joined += ",";
+        }
+        joined += str;
+    }
+    return joined;
+}
+
+static void GetResourceKeys(std::vector<std::string> &keys, const std::vector<Resource> &resources)
+{
+    for (const Resource &r : resources)
+    {
+        keys.push_back(r.m_uri + " rt=" + Join(r.m_rts) + " if=" + Join(r.m_ifs));
+        GetResourceKeys(keys, r.m_resources);
+    }
+}
+
+std::string ModelCache::GetFingerprint(const char *dmv, const std::vector<Resource> &resources)
+{
+    std::vector<std::string> keys;
+    GetResourceKeys(keys, resources);
+    std::sort(keys.begin(), keys.end());
+    std::string fingerprint = std::string("dmv=") + (dmv ? dmv : "");
+    for (const std::string &key : keys)
+    {
+        fingerprint += "\n" + key;
+    }
+    return fingerprint;
+}
+
+static const OCRepPayload *GetObject(const OCRepPayload *payload, const char *name)
+{
+    for (OCRepPayloadValue *value = payload ? payload->values : NULL; value; value = value->next)
+    {
+        if ((value->type == OCREP_PROP_OBJECT) && !strcmp(value->name, name))
+        {
+            return value->obj;
+        }
+    }
+    return NULL;
+}
+
+bool ModelCache::Matches(const OCRepPayload *model, const std::vector<Resource> &resources)
+{
+    const OCRepPayload *paths = GetObject(model, "paths");
+    if (!paths || !GetObject(model, "definitions"))
+    {
+        return false;
+    }
+    for (const Resource &r : resources)
+    {
+        bool isVendorDefined = false;
+        for (const std::string &rt : r.m_rts)
+        {
+            if (TranslateResourceType(rt.c_str()) && !IsResourceTypeInWellDefinedSet(rt.c_str()))
+            {
+                isVendorDefined = true;
+                break;
+            }
+        }
+        if (isVendorDefined && !GetObject(paths, r.m_uri.c_str()))
+        {
+            LOG(LOG_INFO, "Missing path %s", r.m_uri.c_str());
+            return false;
+        }
+        if (!Matches(model, r.m_resources))
+        {
+            return false;
+        }
+    }
+    return true;
+}
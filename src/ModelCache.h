@@ -0,0 +1,54 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#ifndef _MODELCACHE_H
+#define _MODELCACHE_H
+
+#include "PayloadStore.h"
+#include "Resource.h"
+#include "octypes.h"
+#include <string>
+#include <vector>
+
+/*
+ * The introspection data of the OC device models seen so far.  Identical devices describe
+ * themselves identically, so a device whose fingerprint matches a cached model can skip
+ * retrieving its introspection data.
+ */
+class ModelCache : public PayloadStore
+{
+    public:
+        typedef Payload Model;
+
+        /*
+         * @param[in] dmv the data model version of the device.
+         * @param[in] resources the resources of the device.
+         *
+         * @return a key identifying all devices of the same model.
+         */
+        static std::string GetFingerprint(const char *dmv, const std::vector<Resource> &resources);
+
+        /*
+         * @return true if model has a path for each translatable resource in resources.
+         */
+        static bool Matches(const OCRepPayload *model, const std::vector<Resource> &resources);
+};
+
+#endif
@@ -20,15 +20,153 @@
 
 #include "Payload.h"
 
+#include "Metrics.h"
 #include "Name.h"
 #include "Plugin.h"
+#define PROBE_SEMAPHORES
+#include "Probes.h"
 #include "Signature.h"
+#include "Trace.h"
 #include "oic_malloc.h"
 #include "oic_string.h"
 #include "ocpayload.h"
 #include <assert.h>
 #include <math.h>
 
+static Histogram sToOCPayloadTime("payload.to_oc_ns");
+static Histogram sToAJMsgArgTime("payload.to_aj_ns");
+
+PROBE_SEMAPHORE(payload_to_oc_begin);
+PROBE_SEMAPHORE(payload_to_oc_end);
+PROBE_SEMAPHORE(payload_to_aj_begin);
+PROBE_SEMAPHORE(payload_to_aj_end);
+
+static size_t GetScalarSize(int typeId)
+{
+    switch (typeId)
+    {
+        case ajn::ALLJOYN_BYTE:
+            return 1;
+        case ajn::ALLJOYN_INT16:
+        case ajn::ALLJOYN_UINT16:
+            return 2;
+        case ajn::ALLJOYN_BOOLEAN:
+        case ajn::ALLJOYN_INT32:
+        case ajn::ALLJOYN_UINT32:
+            return 4;
+        case ajn::ALLJOYN_INT64:
+        case ajn::ALLJOYN_UINT64:
+        case ajn::ALLJOYN_DOUBLE:
+            return 8;
+        default:
+            return 0;
+    }
+}
+
+/* The marshalled size of arg, without padding and the signatures of variants. */
+static size_t GetMarshalledSize(const ajn::MsgArg *arg)
+{
+    size_t size = 0;
+    switch (arg->typeId)
+    {
+        case ajn::ALLJOYN_STRING:
+            return 4 + arg->v_string.len + 1;
+        case ajn::ALLJOYN_OBJECT_PATH:
+            return 4 + arg->v_objPath.len + 1;
+        case ajn::ALLJOYN_SIGNATURE:
+            return 1 + arg->v_signature.len + 1;
+        case ajn::ALLJOYN_ARRAY:
+            size = 4;
+            for (size_t i = 0; i < arg->v_array.GetNumElements(); ++i)
+            {
+                size += GetMarshalledSize(&arg->v_array.GetElements()[i]);
+            }
+            return size;
+        case ajn::ALLJOYN_STRUCT:
+            for (size_t i = 0; i < arg->v_struct.numMembers; ++i)
+            {
+                size += GetMarshalledSize(&arg->v_struct.members[i]);
+            }
+            return size;
+        case ajn::ALLJOYN_DICT_ENTRY:
+            return GetMarshalledSize(arg->v_dictEntry.key) +
+                    GetMarshalledSize(arg->v_dictEntry.val);
+        case ajn::ALLJOYN_VARIANT:
+            return GetMarshalledSize(arg->v_variant.val);
+        case ajn::ALLJOYN_BOOLEAN_ARRAY:
+        case ajn::ALLJOYN_BYTE_ARRAY:
+        case ajn::ALLJOYN_INT16_ARRAY:
+        case ajn::ALLJOYN_UINT16_ARRAY:
+        case ajn::ALLJOYN_INT32_ARRAY:
+        case ajn::ALLJOYN_UINT32_ARRAY:
+        case ajn::ALLJOYN_INT64_ARRAY:
+        case ajn::ALLJOYN_UINT64_ARRAY:
+        case ajn::ALLJOYN_DOUBLE_ARRAY:
+            return 4 + (arg->v_scalarArray.numElements * GetScalarSize(arg->typeId >> 8));
+        default:
+            return GetScalarSize(arg->typeId);
+    }
+}
+
+/*
+ * The conversions are recursive, only the outermost call is timed and fires the probes.  The
+ * size reported by the probes is that of the AllJoyn side of the conversion: the converted
+ * arg for ToOCPayload() and the resulting arg for ToAJMsgArg().
+ */
+static thread_local unsigned sConversionDepth = 0;
+
+class ConversionTimer
+{
+    public:
+        enum Direction { TO_OC, TO_AJ };
+        ConversionTimer(Direction direction, const char *signature, const ajn::MsgArg *arg)
+            : m_direction(direction), m_signature(signature), m_arg(arg),
+              m_isOutermost(sConversionDepth++ == 0), m_start(m_isOutermost ? MetricsNow() : 0),
+              m_span((direction == TO_OC) ? "payload.to_oc" : "payload.to_aj", m_isOutermost)
+        {
+            if (!m_isOutermost)
+            {
+                return;
+            }
+            if (m_direction == TO_OC)
+            {
+                PROBE1(payload_to_oc_begin, m_signature);
+            }
+            else
+            {
+                PROBE1(payload_to_aj_begin, m_signature);
+            }
+        }
+        ~ConversionTimer()
+        {
+            --sConversionDepth;
+            if (!m_isOutermost)
+            {
+                return;
+            }
+            if (m_direction == TO_OC)
+            {
+                sToOCPayloadTime.Record(MetricsNow() - m_start);
+                PROBE2(payload_to_oc_end, m_signature,
+                        PROBE_ENABLED(payload_to_oc_end) ? GetMarshalledSize(m_arg) : 0);
+            }
+            else
+            {
+                sToAJMsgArgTime.Record(MetricsNow() - m_start);
+                PROBE2(payload_to_aj_end, m_signature,
+                        PROBE_ENABLED(payload_to_aj_end) ? GetMarshalledSize(m_arg) : 0);
+            }
+        }
+
+    private:
+        Direction m_direction;
+        const char *m_signature;
+        const ajn::MsgArg *m_arg;
+        bool m_isOutermost;
+        uint64_t m_start;
+        TraceSpan m_span;
+};
+
 std::map<std::string, std::vector<Types::Field>> Types::m_structs;
 std::map<std::string, std::map<std::string, Types::Value>> Types::m_dicts;
 
@@ -880,6 +1018,7 @@ bool ToOCPayload(OCRepPayload *payload, const char *name, const ajn::MsgArg *arg
 bool ToOCPayload(OCRepPayload *payload, const char *name, OCRepPayloadPropType type,
         const ajn::MsgArg *arg, const char *signature)
 {
+    ConversionTimer timer(ConversionTimer::TO_OC, signature, arg);
     bool success = false;
     switch (signature[0])
     {
@@ -2053,6 +2192,7 @@ static bool ToAJMsgArg(ajn::MsgArg *arg, const char *signature, OCRepPayloadValu
 bool ToAJMsgArg(ajn::MsgArg *arg, const char *signature, OCRepPayloadValue *value,
         const char *valueSignature)
 {
+    ConversionTimer timer(ConversionTimer::TO_AJ, signature, arg);
     const char *argSignature = signature;
     ParseCompleteType(signature);
     std::string sig(argSignature, signature - argSignature);
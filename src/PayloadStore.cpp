@@ -0,0 +1,174 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "PayloadStore.h"
+
+#include "Log.h"
+#include "ocpayload.h"
+#include "ocpayloadcbor.h"
+#include "ocstack.h"
+#include "oic_malloc.h"
+#include <vector>
+
+PayloadStore::Payload PayloadStore::Get(const std::string &key)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::map<std::string, Payload>::iterator it = m_payloads.find(key);
+    return (it != m_payloads.end()) ? it->second : Payload();
+}
+
+std::map<std::string, PayloadStore::Payload> PayloadStore::GetAll()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_payloads;
+}
+
+void PayloadStore::Put(const std::string &key, const OCRepPayload *payload)
+{
+    OCRepPayload *clone = OCRepPayloadClone(payload);
+    if (!clone)
+    {
+        LOG(LOG_ERR, "Failed to clone payload");
+        return;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_payloads[key] = Payload(clone, OCRepPayloadDestroy);
+}
+
+void PayloadStore::Erase(const std::string &key)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_payloads.erase(key);
+}
+
+bool PayloadStore::Load(const char *filename)
+{
+    OCPersistentStorage *ps = OCGetPersistentStorageHandler();
+    std::vector<uint8_t> data;
+    uint8_t buf[1024];
+    size_t n;
+    OCPayload *payload = NULL;
+    OCStackResult result;
+    bool success = false;
+    FILE *fp = ps ? ps->open(filename, "rb") : NULL;
+    if (!fp)
+    {
+        LOG(LOG_INFO, "No %s", filename);
+        goto exit;
+    }
+    while ((n = ps->read(buf, 1, sizeof(buf), fp)) > 0)
+    {
+        data.insert(data.end(), buf, buf + n);
+    }
+    if (data.empty())
+    {
+        goto exit;
+    }
+    result = OCParsePayload(&payload, OC_FORMAT_CBOR, PAYLOAD_TYPE_REPRESENTATION, &data[0],
+            data.size());
+    if (result != OC_STACK_OK)
+    {
+        LOG(LOG_ERR, "OCParsePayload() - %d", result);
+        goto exit;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (OCRepPayloadValue *value = ((OCRepPayload *) payload)->values; value;
+             value = value->next)
+        {
+            if (value->type != OCREP_PROP_OBJECT)
+            {
+                continue;
+            }
+            OCRepPayload *clone = OCRepPayloadClone(value->obj);
+            if (clone)
+            {
+                m_payloads[value->name] = Payload(clone, OCRepPayloadDestroy);
+            }
+        }
+        LOG(LOG_INFO, "Loaded %zu entries from %s", m_payloads.size(), filename);
+    }
+    success = true;
+
+exit:
+    OCPayloadDestroy(payload);
+    if (fp)
+    {
+        ps->close(fp);
+    }
+    return success;
+}
+
+bool PayloadStore::Save(const char *filename)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    OCPersistentStorage *ps = OCGetPersistentStorageHandler();
+    OCRepPayload *payload = NULL;
+    uint8_t *out = NULL;
+    size_t outSize = 0;
+    OCStackResult result;
+    FILE *fp = NULL;
+    bool success = false;
+    if (!ps)
+    {
+        goto exit;
+    }
+    payload = OCRepPayloadCreate();
+    if (!payload)
+    {
+        LOG(LOG_ERR, "Failed to create payload");
+        goto exit;
+    }
+    for (auto &entry : m_payloads)
+    {
+        if (!OCRepPayloadSetPropObject(payload, entry.first.c_str(), entry.second.get()))
+        {
+            LOG(LOG_ERR, "Failed to set %s", entry.first.c_str());
+            goto exit;
+        }
+    }
+    result = OCConvertPayload((OCPayload *) payload, OC_FORMAT_CBOR, &out, &outSize);
+    if (result != OC_STACK_OK)
+    {
+        LOG(LOG_ERR, "OCConvertPayload() - %d", result);
+        goto exit;
+    }
+    fp = ps->open(filename, "wb");
+    if (!fp)
+    {
+        LOG(LOG_ERR, "open failed");
+        goto exit;
+    }
+    if (ps->write(out, 1, outSize, fp) != outSize)
+    {
+        LOG(LOG_ERR, "write failed");
+        goto exit;
+    }
+    success = true;
+
+exit:
+    if (fp)
+    {
+        ps->close(fp);
+    }
+    OICFree(out);
+    OCRepPayloadDestroy(payload);
+    return success;
+}
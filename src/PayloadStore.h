@@ -0,0 +1,55 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#ifndef _PAYLOADSTORE_H
+#define _PAYLOADSTORE_H
+
+#include "octypes.h"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+/*
+ * A map of representation payloads that can be persisted using the OC persistent storage
+ * handler.  Each payload is stored as a property of a single CBOR encoded representation.
+ */
+class PayloadStore
+{
+    public:
+        typedef std::shared_ptr<OCRepPayload> Payload;
+
+        /*
+         * @return the payload stored at key, or an empty Payload if none.
+         */
+        Payload Get(const std::string &key);
+        std::map<std::string, Payload> GetAll();
+        void Put(const std::string &key, const OCRepPayload *payload);
+        void Erase(const std::string &key);
+
+        bool Load(const char *filename);
+        bool Save(const char *filename);
+
+    private:
+        std::mutex m_mutex;
+        std::map<std::string, Payload> m_payloads;
+};
+
+#endif
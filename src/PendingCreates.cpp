@@ -0,0 +1,103 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "PendingCreates.h"
+
+void PendingCreates::Add(const std::string &device, const void *resource, TimePoint announced)
+{
+    Pending &pending = m_devices[device];
+    if (pending.m_resources.empty())
+    {
+        pending.m_numPaths = 0;
+        pending.m_announced = announced;
+    }
+    pending.m_resources.insert(resource);
+    ++pending.m_numPaths;
+}
+
+bool PendingCreates::Created(const void *resource)
+{
+    return Erase(resource, false);
+}
+
+bool PendingCreates::Removed(const void *resource)
+{
+    return Erase(resource, true);
+}
+
+bool PendingCreates::IsPending(const std::string &device) const
+{
+    std::map<std::string, Pending>::const_iterator it = m_devices.find(device);
+    return (it != m_devices.end()) && !it->second.m_resources.empty();
+}
+
+size_t PendingCreates::GetNumPending() const
+{
+    size_t n = 0;
+    for (std::map<std::string, Pending>::const_iterator it = m_devices.begin();
+         it != m_devices.end(); ++it)
+    {
+        n += it->second.m_resources.size();
+    }
+    return n;
+}
+
+std::vector<PendingCreates::Batch> PendingCreates::GetCompleted()
+{
+    std::vector<Batch> completed;
+    std::map<std::string, Pending>::iterator it = m_devices.begin();
+    while (it != m_devices.end())
+    {
+        if (it->second.m_resources.empty())
+        {
+            Batch batch;
+            batch.m_device = it->first;
+            batch.m_numPaths = it->second.m_numPaths;
+            batch.m_announced = it->second.m_announced;
+            completed.push_back(batch);
+            it = m_devices.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+    return completed;
+}
+
+bool PendingCreates::Erase(const void *resource, bool removed)
+{
+    for (std::map<std::string, Pending>::iterator it = m_devices.begin(); it != m_devices.end();
+         ++it)
+    {
+        Pending &pending = it->second;
+        if (pending.m_resources.erase(resource))
+        {
+            if (removed && --pending.m_numPaths == 0)
+            {
+                /* Nothing of the batch is left to publish */
+                m_devices.erase(it);
+                return false;
+            }
+            return pending.m_resources.empty();
+        }
+    }
+    return false;
+}
@@ -0,0 +1,88 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#ifndef _PENDINGCREATES_H
+#define _PENDINGCREATES_H
+
+#include <chrono>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+/*
+ * Tracks the virtual resources of each device that are waiting for their Introspect reply, so
+ * that the paths of a device are published to the resource directory together once the last
+ * one is created.  Each device is tracked separately so that a slow device does not hold back
+ * the publication of the others.
+ *
+ * A resource deleted before its reply arrives is never reported as created and must be passed
+ * to Removed() instead.
+ */
+class PendingCreates
+{
+    public:
+        typedef std::chrono::steady_clock::time_point TimePoint;
+
+        struct Batch {
+            std::string m_device;
+            /* The number of paths created in the batch */
+            size_t m_numPaths;
+            /* When the announcement that started the batch was received */
+            TimePoint m_announced;
+        };
+
+        /* Starts a new batch of device if none of its resources are pending. */
+        void Add(const std::string &device, const void *resource, TimePoint announced);
+
+        /*
+         * Called when the creation of resource has completed.
+         *
+         * @return true if resource was the last pending one of its device.
+         */
+        bool Created(const void *resource);
+
+        /*
+         * Called when resource is deleted, whether or not its creation has completed.  A
+         * pending resource no longer counts towards the paths of its batch.
+         *
+         * @return true if resource was the last pending one of its device.
+         */
+        bool Removed(const void *resource);
+
+        bool IsPending(const std::string &device) const;
+        size_t GetNumPending() const;
+
+        /* Returns the batches with no pending resources left and forgets them. */
+        std::vector<Batch> GetCompleted();
+
+    private:
+        struct Pending {
+            std::set<const void *> m_resources;
+            size_t m_numPaths;
+            TimePoint m_announced;
+            Pending() : m_numPaths(0) { }
+        };
+        std::map<std::string, Pending> m_devices;
+
+        bool Erase(const void *resource, bool removed);
+};
+
+#endif
@@ -0,0 +1,151 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "PingSchedule.h"
+
+#include <algorithm>
+
+PingSchedule::PingSchedule(time_t minIntervalSecs, time_t maxIntervalSecs, uint8_t retries)
+    : m_minIntervalSecs(std::max((time_t) 1, minIntervalSecs)),
+      m_maxIntervalSecs(std::min(std::max(m_minIntervalSecs, maxIntervalSecs),
+              (time_t) (WHEEL_SIZE * 2 / 3))),
+      m_retries(retries), m_wheel(WHEEL_SIZE), m_tick(0), m_random(time(NULL)), m_numPings(0)
+{
+}
+
+void PingSchedule::Add(const std::string &name, time_t now)
+{
+    if (m_peers.find(name) != m_peers.end())
+    {
+        return;
+    }
+    Peer &peer = m_peers[name];
+    peer.m_intervalSecs = m_minIntervalSecs;
+    peer.m_dueTick = now;
+    peer.m_misses = 0;
+    peer.m_state = Peer::IDLE;
+    /* Spread peers added at the same time across the first interval */
+    std::uniform_int_distribution<time_t> distribution(1, m_minIntervalSecs);
+    Schedule(name, peer, now + distribution(m_random));
+}
+
+void PingSchedule::Remove(const std::string &name)
+{
+    std::map<std::string, Peer>::iterator it = m_peers.find(name);
+    if (it != m_peers.end())
+    {
+        m_wheel[it->second.m_dueTick % WHEEL_SIZE].erase(name);
+        m_peers.erase(it);
+    }
+}
+
+bool PingSchedule::IsPresent(const std::string &name) const
+{
+    std::map<std::string, Peer>::const_iterator it = m_peers.find(name);
+    return (it == m_peers.end()) || (it->second.m_state != Peer::ABSENT);
+}
+
+void PingSchedule::Seen(const std::string &name, time_t now)
+{
+    std::map<std::string, Peer>::iterator it = m_peers.find(name);
+    if ((it != m_peers.end()) && (it->second.m_state == Peer::IDLE))
+    {
+        it->second.m_misses = 0;
+        Schedule(name, it->second, now + Jitter(it->second.m_intervalSecs));
+    }
+}
+
+std::vector<std::string> PingSchedule::GetDue(time_t now)
+{
+    std::vector<std::string> due;
+    if (!m_tick || (now < m_tick) || ((now - m_tick) > (time_t) WHEEL_SIZE))
+    {
+        m_tick = now - WHEEL_SIZE;
+    }
+    for (; m_tick < now; ++m_tick)
+    {
+        std::set<std::string> &slot = m_wheel[(m_tick + 1) % WHEEL_SIZE];
+        std::set<std::string>::iterator name = slot.begin();
+        while (name != slot.end())
+        {
+            Peer &peer = m_peers[*name];
+            if ((peer.m_state == Peer::IDLE) && (peer.m_dueTick <= now))
+            {
+                peer.m_state = Peer::PENDING;
+                ++m_numPings;
+                due.push_back(*name);
+                name = slot.erase(name);
+            }
+            else
+            {
+                ++name;
+            }
+        }
+    }
+    return due;
+}
+
+void PingSchedule::Pinged(const std::string &name, bool isPresent, time_t now)
+{
+    std::map<std::string, Peer>::iterator it = m_peers.find(name);
+    if ((it == m_peers.end()) || (it->second.m_state != Peer::PENDING))
+    {
+        return;
+    }
+    Peer &peer = it->second;
+    if (isPresent)
+    {
+        peer.m_misses = 0;
+        peer.m_intervalSecs = std::min(peer.m_intervalSecs * 2, m_maxIntervalSecs);
+    }
+    else if (++peer.m_misses > m_retries)
+    {
+        peer.m_state = Peer::ABSENT;
+        return;
+    }
+    else
+    {
+        peer.m_intervalSecs = m_minIntervalSecs;
+    }
+    peer.m_state = Peer::IDLE;
+    Schedule(name, peer, now + Jitter(peer.m_intervalSecs));
+}
+
+time_t PingSchedule::GetInterval(const std::string &name) const
+{
+    std::map<std::string, Peer>::const_iterator it = m_peers.find(name);
+    return (it != m_peers.end()) ? it->second.m_intervalSecs : 0;
+}
+
+/* Returns a time within a quarter of intervalSecs either side of it. */
+time_t PingSchedule::Jitter(time_t intervalSecs)
+{
+    time_t spread = intervalSecs / 4;
+    std::uniform_int_distribution<time_t> distribution(intervalSecs - spread,
+            intervalSecs + spread);
+    return std::max((time_t) 1, distribution(m_random));
+}
+
+void PingSchedule::Schedule(const std::string &name, Peer &peer, time_t dueTick)
+{
+    m_wheel[peer.m_dueTick % WHEEL_SIZE].erase(name);
+    peer.m_dueTick = dueTick;
+    m_wheel[peer.m_dueTick % WHEEL_SIZE].insert(name);
+}
@@ -0,0 +1,94 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#ifndef _PINGSCHEDULE_H
+#define _PINGSCHEDULE_H
+
+#include <inttypes.h>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <time.h>
+#include <vector>
+
+/*
+ * Decides when to ping each peer.  Pending pings are kept in a timer wheel of one second slots.
+ * The interval of a peer doubles after each successful ping up to maxIntervalSecs, drops back to
+ * minIntervalSecs after a missed ping, and is jittered so that peers added together do not stay
+ * in phase.  Any other evidence that a peer is present postpones its next ping.
+ */
+class PingSchedule
+{
+    public:
+        PingSchedule(time_t minIntervalSecs, time_t maxIntervalSecs, uint8_t retries);
+
+        void Add(const std::string &name, time_t now);
+        void Remove(const std::string &name);
+
+        /*
+         * @return false once name has missed retries consecutive pings.
+         */
+        bool IsPresent(const std::string &name) const;
+
+        /*
+         * Called with passive evidence that name is present.
+         */
+        void Seen(const std::string &name, time_t now);
+
+        /*
+         * @return the names to ping at now.  Each name returned is not returned again until
+         *         Pinged() is called for it.
+         */
+        std::vector<std::string> GetDue(time_t now);
+
+        /*
+         * Called with the outcome of a ping returned by GetDue().
+         */
+        void Pinged(const std::string &name, bool isPresent, time_t now);
+
+        time_t GetInterval(const std::string &name) const;
+        size_t GetNumPings() const { return m_numPings; }
+
+    private:
+        static const size_t WHEEL_SIZE = 256;
+
+        struct Peer
+        {
+            time_t m_intervalSecs;
+            time_t m_dueTick;
+            uint8_t m_misses;
+            enum { IDLE, PENDING, ABSENT } m_state;
+        };
+
+        const time_t m_minIntervalSecs;
+        const time_t m_maxIntervalSecs;
+        const uint8_t m_retries;
+        std::map<std::string, Peer> m_peers;
+        std::vector<std::set<std::string>> m_wheel;
+        time_t m_tick;
+        std::minstd_rand m_random;
+        size_t m_numPings;
+
+        time_t Jitter(time_t intervalSecs);
+        void Schedule(const std::string &name, Peer &peer, time_t dueTick);
+};
+
+#endif
@@ -22,91 +22,244 @@
 
 #include "Plugin.h"
 #include "Log.h"
+#include "Metrics.h"
+#include "Resource.h"
+#include <atomic>
+#include <map>
 
-AllJoynPresence::AllJoynPresence(ajn::BusAttachment *bus, const std::string &name)
-    : Presence(name), m_bus(bus), m_lastTick(time(NULL)), m_tries(0), m_state(IDLE)
+static Counter sPings("presence.aj.pings");
+static Counter sPingFailures("presence.aj.ping_failures");
+static Counter sProbes("presence.oc.probes");
+static Counter sProbeFailures("presence.oc.probe_failures");
+
+AllJoynPresenceManager::AllJoynPresenceManager(ajn::BusAttachment *bus)
+    : m_bus(bus), m_schedule(MIN_INTERVAL_SECS, MAX_INTERVAL_SECS, RETRIES),
+      m_rateTick(time(NULL)), m_rateNumPings(0), m_pingRate(0)
 {
     LOG(LOG_INFO, "[%p]", this);
 }
 
-AllJoynPresence::~AllJoynPresence()
+AllJoynPresenceManager::~AllJoynPresenceManager()
 {
     LOG(LOG_INFO, "[%p]", this);
 }
 
-bool AllJoynPresence::IsPresent()
+void AllJoynPresenceManager::Add(const std::string &name)
 {
     std::lock_guard<std::mutex> lock(m_mutex);
-    switch (m_state)
-    {
-        case IDLE:
-            if ((time(NULL) - m_lastTick) > PERIOD_SECS)
-            {
-                QStatus status = m_bus->PingAsync(GetId().c_str(), PERIOD_SECS * 1000, this, NULL);
-                if (status == ER_OK)
-                {
-                    m_state = PENDING;
-                }
-                else
-                {
-                    LOG(LOG_ERR, "PingAsync - %s", QCC_StatusText(status));
-                }
-            }
-            return true;
-        case PENDING:
-            return true;
-        case ABSENT:
-            return false;
-    }
-    return true;
+    m_schedule.Add(name, time(NULL));
 }
 
-void AllJoynPresence::Seen()
+void AllJoynPresenceManager::Remove(const std::string &name)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_schedule.Remove(name);
+}
+
+bool AllJoynPresenceManager::IsPresent(const std::string &name)
 {
     std::lock_guard<std::mutex> lock(m_mutex);
-    m_lastTick = time(NULL);
+    return m_schedule.IsPresent(name);
 }
 
-void AllJoynPresence::PingCB(QStatus status, void *context)
+void AllJoynPresenceManager::Seen(const std::string &name)
 {
-    (void) context;
     std::lock_guard<std::mutex> lock(m_mutex);
-    m_lastTick = time(NULL);
-    if (status == ER_OK)
+    m_schedule.Seen(name, time(NULL));
+}
+
+void AllJoynPresenceManager::Process()
+{
+    std::vector<std::string> due;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        time_t now = time(NULL);
+        due = m_schedule.GetDue(now);
+        if ((now - m_rateTick) >= RATE_PERIOD_SECS)
+        {
+            m_pingRate = (double) (m_schedule.GetNumPings() - m_rateNumPings) / (now - m_rateTick);
+            m_rateTick = now;
+            m_rateNumPings = m_schedule.GetNumPings();
+            LOG(LOG_INFO, "[%p] pingRate=%.2f/s", this, m_pingRate);
+        }
+    }
+    /* Pinged without m_mutex held since PingCB may be called before PingAsync returns */
+    for (const std::string &name : due)
     {
-        m_tries = 0;
-        m_state = IDLE;
+        std::string *context = new std::string(name);
+        QStatus status = m_bus->PingAsync(name.c_str(), PING_TIMEOUT_MS, this, context);
+        sPings.Increment();
+        if (status != ER_OK)
+        {
+            LOG(LOG_ERR, "PingAsync - %s", QCC_StatusText(status));
+            sPingFailures.Increment();
+            delete context;
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_schedule.Pinged(name, false, time(NULL));
+        }
     }
-    else if (m_tries < RETRIES)
+}
+
+double AllJoynPresenceManager::GetPingRate()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_pingRate;
+}
+
+void AllJoynPresenceManager::PingCB(QStatus status, void *ctx)
+{
+    std::string *name = reinterpret_cast<std::string *>(ctx);
+    if (status != ER_OK)
     {
-        ++m_tries;
-        m_state = IDLE;
+        sPingFailures.Increment();
     }
-    else
     {
-        m_state = ABSENT;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_schedule.Pinged(*name, (status == ER_OK), time(NULL));
     }
+    delete name;
+}
+
+AllJoynPresence::AllJoynPresence(AllJoynPresenceManager *manager, const std::string &name)
+    : Presence(name), m_manager(manager)
+{
+    LOG(LOG_INFO, "[%p]", this);
+    m_manager->Add(name);
 }
 
-OCPresence::OCPresence(const char *di, time_t periodSecs)
-    : Presence(di), m_periodSecs(periodSecs), m_lastTick(time(NULL))
+AllJoynPresence::~AllJoynPresence()
 {
     LOG(LOG_INFO, "[%p]", this);
+    m_manager->Remove(GetId());
+}
+
+bool AllJoynPresence::IsPresent()
+{
+    return m_manager->IsPresent(GetId());
+}
+
+void AllJoynPresence::Seen()
+{
+    m_manager->Seen(GetId());
+}
+
+static std::atomic<size_t> sNumProbes(0);
+
+std::mutex OCPresence::sStatesMutex;
+std::map<std::string, std::weak_ptr<OCPresence::State>> OCPresence::sStates;
+
+OCPresence::OCPresence(const char *di, const SharedVector<OCDevAddr> &addrs, time_t periodSecs)
+    : Presence(di), m_addrs(addrs), m_periodSecs(periodSecs), m_state(std::make_shared<State>())
+{
+    LOG(LOG_INFO, "[%p]", this);
+    std::lock_guard<std::mutex> lock(sStatesMutex);
+    sStates[di] = m_state;
 }
 
 OCPresence::~OCPresence()
 {
     LOG(LOG_INFO, "[%p]", this);
+    std::lock_guard<std::mutex> lock(sStatesMutex);
+    std::map<std::string, std::weak_ptr<State>>::iterator it = sStates.find(GetId());
+    if ((it != sStates.end()) && (it->second.lock() == m_state))
+    {
+        sStates.erase(it);
+    }
+}
+
+void OCPresence::Responded(const std::string &di)
+{
+    std::shared_ptr<State> state;
+    {
+        std::lock_guard<std::mutex> lock(sStatesMutex);
+        std::map<std::string, std::weak_ptr<State>>::iterator it = sStates.find(di);
+        if (it != sStates.end())
+        {
+            state = it->second.lock();
+            if (!state)
+            {
+                sStates.erase(it);
+            }
+        }
+    }
+    if (state)
+    {
+        std::lock_guard<std::mutex> lock(state->m_mutex);
+        state->m_lastTick = time(NULL);
+        state->m_misses = 0;
+    }
 }
 
 bool OCPresence::IsPresent()
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    return (time(NULL) - m_lastTick) <= (m_periodSecs * RETRIES);
+    std::lock_guard<std::mutex> lock(m_state->m_mutex);
+    time_t elapsed = time(NULL) - m_state->m_lastTick;
+    if (!m_state->m_isProbing && (elapsed > m_periodSecs) && !m_addrs.empty())
+    {
+        std::shared_ptr<State> *context = new std::shared_ptr<State>(m_state);
+        OCCallbackData cbData;
+        cbData.cb = OCPresence::ProbeCB;
+        cbData.context = context;
+        cbData.cd = NULL;
+        OCStackResult result = SendProbe(&cbData);
+        sProbes.Increment();
+        if (result == OC_STACK_OK)
+        {
+            m_state->m_isProbing = true;
+            ++sNumProbes;
+        }
+        else
+        {
+            LOG(LOG_ERR, "DoResource(" OC_RSRVD_DEVICE_URI ") - %d", result);
+            sProbeFailures.Increment();
+            delete context;
+        }
+    }
+    if (m_addrs.empty())
+    {
+        return elapsed <= (m_periodSecs * RETRIES);
+    }
+    return m_state->m_misses < RETRIES;
 }
 
 void OCPresence::Seen()
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    m_lastTick = time(NULL);
+    std::lock_guard<std::mutex> lock(m_state->m_mutex);
+    m_state->m_lastTick = time(NULL);
+    m_state->m_misses = 0;
+}
+
+size_t OCPresence::GetNumProbes()
+{
+    return sNumProbes;
+}
+
+OCStackResult OCPresence::SendProbe(OCCallbackData *cbData)
+{
+    DoHandle handle;
+    return DoResource(&handle, OC_REST_GET, OC_RSRVD_DEVICE_URI, m_addrs, NULL, cbData, NULL, 0);
+}
+
+OCStackApplicationResult OCPresence::ProbeCB(void *ctx, OCDoHandle handle,
+        OCClientResponse *response)
+{
+    (void) handle;
+    std::shared_ptr<State> *context = reinterpret_cast<std::shared_ptr<State> *>(ctx);
+    {
+        std::shared_ptr<State> &state = *context;
+        std::lock_guard<std::mutex> lock(state->m_mutex);
+        state->m_isProbing = false;
+        if (response && (response->result <= OC_STACK_RESOURCE_CHANGED))
+        {
+            state->m_lastTick = time(NULL);
+            state->m_misses = 0;
+        }
+        else
+        {
+            ++state->m_misses;
+            sProbeFailures.Increment();
+        }
+    }
+    delete context;
+    return OC_STACK_DELETE_TRANSACTION;
 }
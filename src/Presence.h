@@ -21,11 +21,16 @@
 #ifndef _PRESENCE_H
 #define _PRESENCE_H
 
+#include "PingSchedule.h"
+#include "Resource.h"
 #include "cacommon.h"
 #include "octypes.h"
 #include <inttypes.h>
+#include <map>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <vector>
 #include <time.h>
 #include <alljoyn/BusAttachment.h>
 
@@ -41,44 +46,105 @@ class Presence
         std::string m_id;
 };
 
-class AllJoynPresence : public Presence
-    , private ajn::BusAttachment::PingAsyncCB
+/*
+ * Pings the AJ peers of all AllJoynPresence objects from Process() according to a PingSchedule.
+ */
+class AllJoynPresenceManager : private ajn::BusAttachment::PingAsyncCB
 {
     public:
-        AllJoynPresence(ajn::BusAttachment *m_bus, const std::string &name);
-        virtual ~AllJoynPresence();
+        AllJoynPresenceManager(ajn::BusAttachment *bus);
+        virtual ~AllJoynPresenceManager();
 
-        virtual bool IsPresent();
-        virtual void Seen();
+        void Add(const std::string &name);
+        void Remove(const std::string &name);
+        bool IsPresent(const std::string &name);
+        void Seen(const std::string &name);
+        void Process();
+
+        /*
+         * @return the pings per second sent over the last RATE_PERIOD_SECS.
+         */
+        double GetPingRate();
 
     private:
-        static const time_t PERIOD_SECS = 1;
+        static const time_t MIN_INTERVAL_SECS = 2;
+        static const time_t MAX_INTERVAL_SECS = 64;
         static const uint8_t RETRIES = 3;
+        static const uint32_t PING_TIMEOUT_MS = 1000;
+        static const time_t RATE_PERIOD_SECS = 60;
 
         ajn::BusAttachment *m_bus;
         std::mutex m_mutex;
-        time_t m_lastTick;
-        uint8_t m_tries;
-        enum { IDLE, PENDING, ABSENT } m_state;
+        PingSchedule m_schedule;
+        time_t m_rateTick;
+        size_t m_rateNumPings;
+        double m_pingRate;
 
         virtual void PingCB(QStatus status, void *context);
 };
 
+class AllJoynPresence : public Presence
+{
+    public:
+        AllJoynPresence(AllJoynPresenceManager *manager, const std::string &name);
+        virtual ~AllJoynPresence();
+
+        virtual bool IsPresent();
+        virtual void Seen();
+
+    private:
+        AllJoynPresenceManager *m_manager;
+};
+
+/*
+ * Any discovery response from an OC device, and any successful response or notification passed
+ * to Responded(), counts as a sighting.  A device that has not been seen for periodSecs is probed
+ * directly with a unicast GET of its device resource, and is only absent once RETRIES consecutive
+ * probes have failed.
+ */
 class OCPresence : public Presence
 {
     public:
-        OCPresence(const char *di, time_t periodSecs);
+        OCPresence(const char *di, const SharedVector<OCDevAddr> &addrs, time_t periodSecs);
         virtual ~OCPresence();
 
         virtual bool IsPresent();
         virtual void Seen();
 
+        /*
+         * Called with a successful response from the OC device di.
+         */
+        static void Responded(const std::string &di);
+
+        static size_t GetNumProbes();
+
+    protected:
+        /* Sends the GET of the device resource, replaced by the unit tests. */
+        virtual OCStackResult SendProbe(OCCallbackData *cbData);
+
     private:
         static const uint8_t RETRIES = 3;
 
+        /* Shared with outstanding probes, which may complete after this is deleted */
+        struct State
+        {
+            std::mutex m_mutex;
+            time_t m_lastTick;
+            bool m_isProbing;
+            uint8_t m_misses;
+            State() : m_lastTick(time(NULL)), m_isProbing(false), m_misses(0) { }
+        };
+
+        /* The state of each OCPresence by di, for Responded() */
+        static std::mutex sStatesMutex;
+        static std::map<std::string, std::weak_ptr<State>> sStates;
+
+        const SharedVector<OCDevAddr> m_addrs;
         const time_t m_periodSecs;
-        std::mutex m_mutex;
-        time_t m_lastTick;
+        std::shared_ptr<State> m_state;
+
+        static OCStackApplicationResult ProbeCB(void *ctx, OCDoHandle handle,
+                OCClientResponse *response);
 };
 
 #endif
@@ -0,0 +1,66 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#ifndef _PROBES_H
+#define _PROBES_H
+
+/*
+ * Static tracepoints (USDT) of the "ajbridge" provider, for profiling a running bridge with
+ * SystemTap, bpftrace or perf.  Sample bpftrace scripts are in tools/bpftrace.
+ *
+ * The probes are compiled in with the USDT build option, which requires <sys/sdt.h>.  Each is
+ * a nop instruction until a tracer attaches to it.  Otherwise they compile to nothing and their
+ * arguments are not evaluated.
+ *
+ * An argument that is costly to compute may be guarded with PROBE_ENABLED(), which is true only
+ * while a tracer is attached to the probe.  A file doing so must define PROBE_SEMAPHORES before
+ * including this header and declare a PROBE_SEMAPHORE() for every probe it fires.
+ */
+
+#ifdef WITH_USDT
+
+#ifdef PROBE_SEMAPHORES
+#define _SDT_HAS_SEMAPHORES 1
+#define PROBE_SEMAPHORE(name) \
+    __extension__ volatile unsigned short ajbridge_##name##_semaphore \
+    __attribute__((unused)) __attribute__((section(".probes"))) = 0
+#define PROBE_ENABLED(name) __builtin_expect(ajbridge_##name##_semaphore, 0)
+#endif
+
+#include <sys/sdt.h>
+
+#define PROBE(name) DTRACE_PROBE(ajbridge, name)
+#define PROBE1(name, a1) DTRACE_PROBE1(ajbridge, name, a1)
+#define PROBE2(name, a1, a2) DTRACE_PROBE2(ajbridge, name, a1, a2)
+#define PROBE3(name, a1, a2, a3) DTRACE_PROBE3(ajbridge, name, a1, a2, a3)
+
+#else
+
+#define PROBE_SEMAPHORE(name) static_assert(true, #name)
+#define PROBE_ENABLED(name) false
+#define PROBE(name) do { } while (0)
+#define PROBE1(name, a1) do { (void) sizeof(a1); } while (0)
+#define PROBE2(name, a1, a2) do { (void) sizeof(a1); (void) sizeof(a2); } while (0)
+#define PROBE3(name, a1, a2, a3) \
+    do { (void) sizeof(a1); (void) sizeof(a2); (void) sizeof(a3); } while (0)
+
+#endif
+
+#endif
@@ -0,0 +1,72 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "PublishedLinks.h"
+
+PublishedLinks::PublishedLinks(time_t refreshSecs)
+    : m_refreshSecs(refreshSecs), m_isPublished(false), m_refreshTime(0)
+{
+}
+
+PublishedLinks::Publication PublishedLinks::Update(const Links &current, time_t now,
+        std::vector<std::string> &added, std::vector<int64_t> &removed)
+{
+    Publication publication;
+    if (!m_isPublished)
+    {
+        publication = REPLACE;
+    }
+    else if ((now - m_refreshTime) >= m_refreshSecs)
+    {
+        publication = REFRESH;
+    }
+    else
+    {
+        publication = DELTA;
+        for (auto &link : current)
+        {
+            auto it = m_links.find(link.first);
+            if (it == m_links.end())
+            {
+                added.push_back(link.first);
+            }
+            else if (it->second != link.second)
+            {
+                /* Recreated at the same URI */
+                removed.push_back(it->second);
+                added.push_back(link.first);
+            }
+        }
+        for (auto &link : m_links)
+        {
+            if (current.find(link.first) == current.end())
+            {
+                removed.push_back(link.second);
+            }
+        }
+    }
+    if (publication != DELTA)
+    {
+        m_refreshTime = now;
+    }
+    m_isPublished = true;
+    m_links = current;
+    return publication;
+}
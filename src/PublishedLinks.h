@@ -0,0 +1,71 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#ifndef _PUBLISHEDLINKS_H
+#define _PUBLISHEDLINKS_H
+
+#include <inttypes.h>
+#include <map>
+#include <string>
+#include <time.h>
+#include <vector>
+
+/*
+ * Tracks the links published to a resource directory so that only the links added and removed
+ * since the previous publication need to be sent.
+ */
+class PublishedLinks
+{
+    public:
+        /* Resource instance IDs (ins) keyed by URI */
+        typedef std::map<std::string, int64_t> Links;
+
+        enum Publication
+        {
+            /* Delete any links left from a previous run, then publish all links */
+            REPLACE = 0,
+            /* Publish all links again to refresh their lifetime */
+            REFRESH,
+            /* Publish the added links and delete the removed ones */
+            DELTA
+        };
+
+        PublishedLinks(time_t refreshSecs);
+
+        /*
+         * Called with the current links before publishing at now.  For DELTA, added is set to the
+         * URIs to publish and removed to the instance IDs to delete.
+         */
+        Publication Update(const Links &current, time_t now, std::vector<std::string> &added,
+                std::vector<int64_t> &removed);
+
+        /*
+         * Called when a publication fails so that the next one is a REPLACE.
+         */
+        void Reset() { m_isPublished = false; }
+
+    private:
+        const time_t m_refreshSecs;
+        bool m_isPublished;
+        time_t m_refreshTime;
+        Links m_links;
+};
+
+#endif
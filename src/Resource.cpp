@@ -21,14 +21,22 @@
 #include "Resource.h"
 
 #include "Log.h"
+#include "Probes.h"
+#include "ResourceIndex.h"
+#include "Trace.h"
 #include "oic_malloc.h"
 #include "oic_string.h"
 #include "ocpayload.h"
 #include "ocstack.h"
 #include <assert.h>
+#include <atomic>
+#include <mutex>
+#include <set>
 
 #define INTERFACE_DEFAULT_QUERY "if=" OC_RSRVD_INTERFACE_DEFAULT
 
+static std::atomic<uint64_t> sRequestCount(0);
+
 static std::vector<OCDevAddr> GetDevAddrs(OCDevAddr origin, const char *di,
         OCResourcePayload *resource)
 {
@@ -81,18 +89,71 @@ static std::vector<OCDevAddr> GetDevAddrs(OCDevAddr origin, const char *di,
     return addrs;
 }
 
-Resource::Resource(OCDevAddr origin, const char *di, OCResourcePayload *resource)
-    : m_uri(resource->uri), m_isObservable(resource->bitmap & OC_OBSERVABLE)
+static bool IsSameDevAddrs(const std::vector<OCDevAddr> &a, const std::vector<OCDevAddr> &b)
+{
+    if (a.size() != b.size())
+    {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i)
+    {
+        if ((a[i].adapter != b[i].adapter) || (a[i].flags != b[i].flags) ||
+                (a[i].port != b[i].port) || (a[i].ifindex != b[i].ifindex) ||
+                strncmp(a[i].addr, b[i].addr, MAX_ADDR_STR_SIZE) ||
+                strncmp(a[i].remoteId, b[i].remoteId, MAX_IDENTITY_SIZE))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static std::vector<std::string> GetStrings(OCStringLL *ll)
+{
+    std::vector<std::string> strs;
+    for (; ll; ll = ll->next)
+    {
+        strs.push_back(ll->value);
+    }
+    return strs;
+}
+
+/* The number of distinct lists interned is bounded in case of misbehaving devices. */
+static const size_t MAX_INTERNED = 1024;
+
+struct InternedLess
+{
+    bool operator()(const SharedVector<std::string> &lhs,
+            const SharedVector<std::string> &rhs) const
+    {
+        return lhs.Get() < rhs.Get();
+    }
+};
+
+SharedVector<std::string> Intern(std::vector<std::string> &&strs)
 {
-    for (OCStringLL *ifc = resource->interfaces; ifc; ifc = ifc->next)
+    static std::mutex sMutex;
+    static std::set<SharedVector<std::string>, InternedLess> sInterned;
+    SharedVector<std::string> shared(std::move(strs));
+    std::lock_guard<std::mutex> lock(sMutex);
+    auto it = sInterned.find(shared);
+    if (it != sInterned.end())
     {
-        m_ifs.push_back(ifc->value);
+        return *it;
     }
-    for (OCStringLL *type = resource->types; type; type = type->next)
+    if (sInterned.size() < MAX_INTERNED)
     {
-        m_rts.push_back(type->value);
+        sInterned.insert(shared);
     }
-    m_addrs = GetDevAddrs(origin, di, resource);
+    return shared;
+}
+
+Resource::Resource(OCDevAddr origin, const char *di, OCResourcePayload *resource)
+    : m_uri(resource->uri), m_ifs(Intern(GetStrings(resource->interfaces))),
+      m_rts(Intern(GetStrings(resource->types))),
+      m_isObservable(resource->bitmap & OC_OBSERVABLE),
+      m_addrs(GetDevAddrs(origin, di, resource))
+{
 }
 
 bool Resource::IsSecure()
@@ -107,6 +168,51 @@ bool Resource::IsSecure()
     return false;
 }
 
+static size_t GetSize(const std::string &str)
+{
+    return sizeof(str) + str.size();
+}
+
+static size_t GetSize(const OCDevAddr &addr)
+{
+    return sizeof(addr);
+}
+
+/*
+ * Approximate bytes not allocated because the resources of a device share storage.  Lists shared
+ * with other devices through the interned set are not included.
+ */
+template <typename T>
+static void CountShared(std::map<const void *, std::pair<size_t, size_t>> &counts,
+        const SharedVector<T> &v)
+{
+    size_t size = sizeof(std::vector<T>);
+    for (const T &t : v)
+    {
+        size += GetSize(t);
+    }
+    std::pair<size_t, size_t> &count = counts[v.Storage()];
+    ++count.first;
+    count.second = size;
+}
+
+static size_t GetSharedBytes(const std::vector<Resource> &resources)
+{
+    std::map<const void *, std::pair<size_t, size_t>> counts;
+    for (const Resource &r : resources)
+    {
+        CountShared(counts, r.m_ifs);
+        CountShared(counts, r.m_rts);
+        CountShared(counts, r.m_addrs);
+    }
+    size_t saved = 0;
+    for (auto &count : counts)
+    {
+        saved += (count.second.first - 1) * count.second.second;
+    }
+    return saved;
+}
+
 Device::Device(OCDevAddr origin, OCDiscoveryPayload *payload)
     : m_di(payload->sid)
 {
@@ -114,7 +220,18 @@ Device::Device(OCDevAddr origin, OCDiscoveryPayload *payload)
          resource = resource->next)
     {
         m_resources.push_back(Resource(origin, payload->sid, resource));
+        Resource &r = m_resources.back();
+        for (size_t i = 0; i < m_resources.size() - 1; ++i)
+        {
+            if (IsSameDevAddrs(m_resources[i].m_addrs, r.m_addrs))
+            {
+                r.m_addrs = m_resources[i].m_addrs;
+                break;
+            }
+        }
     }
+    LOG(LOG_INFO, "%s: %zu resources, ~%zu bytes shared", m_di.c_str(), m_resources.size(),
+            GetSharedBytes(m_resources));
 }
 
 Resource *Device::GetResourceUri(const char *uri)
@@ -233,9 +350,13 @@ std::vector<Resource>::iterator FindResourceFromType(std::vector<Resource> &reso
             [rt](Resource &r) -> bool {return HasResourceType(r.m_rts, rt);});
 }
 
+static ResourceIndex sResourceIndex;
+/* The stack's own resources added to sResourceIndex by the last IndexStackResources() */
+static std::vector<OCResourceHandle> sStackHandles;
+
 OCStackResult CreateResource(OCResourceHandle *handle, const char *uri, const char *typeName,
         const char *interfaceName, OCEntityHandler entityHandler, void *callbackParam,
-        uint8_t properties)
+        uint8_t properties, const char *device)
 {
     OCStackResult result;
     *handle = OCGetResourceHandleAtUri(uri);
@@ -247,10 +368,62 @@ OCStackResult CreateResource(OCResourceHandle *handle, const char *uri, const ch
     {
         result = OCCreateResource(handle, typeName, interfaceName, uri, entityHandler,
                 callbackParam, properties);
+        if (result == OC_STACK_OK)
+        {
+            sResourceIndex.Add(*handle, device ? device : "");
+        }
     }
     return result;
 }
 
+OCStackResult DeleteResource(OCResourceHandle handle)
+{
+    sResourceIndex.Remove(handle);
+    return OCDeleteResource(handle);
+}
+
+void IndexStackResources()
+{
+    for (OCResourceHandle handle : sStackHandles)
+    {
+        sResourceIndex.Remove(handle);
+    }
+    sStackHandles.clear();
+    /*
+     * Only the first 255 resources can be reached this way, which is enough for the handful the
+     * stack creates when it starts.
+     */
+    uint8_t nr;
+    if (OCGetNumberOfResources(&nr) != OC_STACK_OK)
+    {
+        return;
+    }
+    for (size_t i = 0; i < nr; ++i)
+    {
+        OCResourceHandle handle = OCGetResourceHandle((uint8_t) i);
+        if (handle && !sResourceIndex.Contains(handle))
+        {
+            sResourceIndex.Add(handle, "");
+            sStackHandles.push_back(handle);
+        }
+    }
+}
+
+std::vector<OCResourceHandle> GetResourceHandles()
+{
+    return sResourceIndex.GetHandles();
+}
+
+std::vector<OCResourceHandle> GetResourceHandles(const std::string &device)
+{
+    return sResourceIndex.GetHandles(device);
+}
+
+std::string GetResourceDevice(OCResourceHandle handle)
+{
+    return sResourceIndex.GetDevice(handle);
+}
+
 static const char *MethodText(OCMethod method)
 {
     static const char *text[] = {
@@ -277,6 +450,9 @@ struct DoContext
     uint8_t m_numOptions;
 
     std::vector<OCDevAddr>::iterator m_destination;
+    /* The trace of the request this is made for, with a span for each endpoint tried */
+    std::shared_ptr<Trace> m_trace;
+    size_t m_hop;
     ~DoContext()
     {
         OCPayloadDestroy(m_payload);
@@ -305,6 +481,11 @@ static OCStackApplicationResult DoResourceCB(void *ctx, OCDoHandle handle,
     DoContext *context = (DoContext *) ctx;
     LOG(LOG_INFO, "%sCB(ctx=%p,handle=%p,response=%p) result=%d",
             MethodText(context->m_method), ctx, handle, response, response ? response->result : -1);
+    PROBE2(oc_request_complete, context, response ? (int) response->result : -1);
+    if (context->m_trace)
+    {
+        context->m_trace->End(context->m_hop);
+    }
 
     /* Retry with other endpoints when they are available */
     if (response && (context->m_destination != context->m_destinations.end()))
@@ -320,6 +501,7 @@ static OCStackApplicationResult DoResourceCB(void *ctx, OCDoHandle handle,
             }
         }
     }
+    TraceScope scope(context->m_trace);
     OCStackApplicationResult result = context->m_cbData.cb(context->m_cbData.context, context,
             response);
     if ((result == OC_STACK_DELETE_TRANSACTION) && !context->m_cbData.cd)
@@ -332,18 +514,33 @@ static OCStackApplicationResult DoResourceCB(void *ctx, OCDoHandle handle,
 static OCStackResult DoResource(DoContext *context)
 {
     const OCDevAddr *destination = NULL;
+    bool isRetry = (context->m_destination != context->m_destinations.begin());
     if (context->m_destination != context->m_destinations.end())
     {
         destination = &(*context->m_destination);
         ++context->m_destination;
     }
+    if (context->m_trace)
+    {
+        std::string detail = std::string(MethodText(context->m_method)) + " " + context->m_uri;
+        if (destination)
+        {
+            detail = detail + " " + destination->addr + ":" + std::to_string(destination->port);
+        }
+        context->m_hop = context->m_trace->Begin(isRetry ? "oc.retry" : "oc.request", detail);
+    }
     OCCallbackData cbData;
     cbData.cb = DoResourceCB;
     cbData.context = context;
     cbData.cd = context->m_cbData.cd ? DoContextDeleter : NULL;
+    PROBE3(oc_request_send, context, MethodText(context->m_method), context->m_uri.c_str());
     OCStackResult result = OCDoRequest(&context->m_handle, context->m_method,
             context->m_uri.c_str(), destination, context->m_payload, CT_DEFAULT, OC_HIGH_QOS,
             &cbData, context->m_options, context->m_numOptions);
+    if (context->m_trace && (result != OC_STACK_OK))
+    {
+        context->m_trace->End(context->m_hop);
+    }
     int severity = (result == OC_STACK_OK) ? LOG_INFO : LOG_ERR;
     LOG(severity, "%s(uri=%s,destination={adapter=%d,flags=0x%x,addr=%s,port=%d}) handle=%p - %d",
             MethodText(context->m_method), context->m_uri.c_str(),
@@ -357,6 +554,7 @@ OCStackResult DoResource(DoHandle *handle, OCMethod method, const char *uri,
         const std::vector<OCDevAddr> &destinations, OCPayload *payload, OCCallbackData *cbData,
         OCHeaderOption *options, uint8_t numOptions)
 {
+    ++sRequestCount;
     DoContext *context = new DoContext();
     context->m_method = method;
     context->m_uri = uri;
@@ -372,6 +570,12 @@ OCStackResult DoResource(DoHandle *handle, OCMethod method, const char *uri,
     }
 
     context->m_destination = context->m_destinations.begin();
+    /* Observations outlive the request that starts them */
+    if (method != OC_REST_OBSERVE)
+    {
+        context->m_trace = Trace::GetCurrent();
+    }
+    context->m_hop = 0;
     *handle = context;
 
     return DoResource(context);
@@ -665,6 +869,8 @@ bool IsValidRequest(OCEntityHandlerRequest *request)
     OCStackResult result;
     uint8_t n;
 
+    ++sRequestCount;
+
     auto queryMap = ParseQuery(request->resource, request->query);
     auto itf = queryMap.find("if");
     bool hasItf = false;
@@ -810,6 +1016,11 @@ error:
     return false;
 }
 
+uint64_t GetRequestCount()
+{
+    return sRequestCount;
+}
+
 OCRepPayload *CreatePayload(OCResourceHandle resource, const char *query)
 {
     OCRepPayload *payload = NULL;
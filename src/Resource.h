@@ -25,21 +25,69 @@
 #include "octypes.h"
 #include <algorithm>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
 /** Device Data Model version.*/
 #define DEVICE_DATA_MODEL_VERSION            "ocf.res.1.1.0"
 
+/*
+ * A copy-on-write vector.  Copies share the same storage until one of them is modified through
+ * a non-const accessor, so the lists common to many resources are stored once.
+ */
+template <typename T>
+class SharedVector
+{
+public:
+    typedef typename std::vector<T>::const_iterator const_iterator;
+    SharedVector() { }
+    SharedVector(const std::vector<T> &v) : m_v(std::make_shared<std::vector<T>>(v)) { }
+    SharedVector(std::vector<T> &&v) : m_v(std::make_shared<std::vector<T>>(std::move(v))) { }
+    operator const std::vector<T>&() const { return Get(); }
+    const std::vector<T> &Get() const { return m_v ? *m_v : Empty(); }
+    size_t size() const { return Get().size(); }
+    bool empty() const { return Get().empty(); }
+    const_iterator begin() const { return Get().begin(); }
+    const_iterator end() const { return Get().end(); }
+    const T &operator[](size_t i) const { return Get()[i]; }
+    T &operator[](size_t i) { return Mutable()[i]; }
+    void push_back(const T &v) { Mutable().push_back(v); }
+    bool IsSharedWith(const SharedVector &rhs) const { return m_v && (m_v == rhs.m_v); }
+    const void *Storage() const { return m_v.get(); }
+private:
+    std::shared_ptr<std::vector<T>> m_v;
+    static const std::vector<T> &Empty()
+    {
+        static const std::vector<T> empty;
+        return empty;
+    }
+    std::vector<T> &Mutable()
+    {
+        if (!m_v)
+        {
+            m_v = std::make_shared<std::vector<T>>();
+        }
+        else if (!m_v.unique())
+        {
+            m_v = std::make_shared<std::vector<T>>(*m_v);
+        }
+        return *m_v;
+    }
+};
+
 class Resource
 {
 public:
     std::string m_uri;
-    std::vector<std::string> m_ifs;
-    std::vector<std::string> m_rts;
+    /* Interned: resources advertising the same list share its storage. */
+    SharedVector<std::string> m_ifs;
+    SharedVector<std::string> m_rts;
     bool m_isObservable;
-    std::vector<OCDevAddr> m_addrs;
+    /* Shared by the resources of a device reachable at the same endpoints. */
+    SharedVector<OCDevAddr> m_addrs;
     std::vector<Resource> m_resources;
+    Resource() : m_isObservable(false) { }
     Resource(OCDevAddr origin, const char *di, OCResourcePayload *resource);
     bool IsSecure();
 };
@@ -49,6 +97,7 @@ class Device
 public:
     std::string m_di;
     std::vector<Resource> m_resources;
+    Device() { }
     Device(OCDevAddr origin, OCDiscoveryPayload *payload);
     Resource *GetResourceUri(const char *uri);
     Resource *GetResourceType(const char *rt);
@@ -57,20 +106,47 @@ public:
 };
 
 template <typename T>
-bool HasResourceType(std::vector<std::string> &rts, T rt)
+bool HasResourceType(const std::vector<std::string> &rts, T rt)
 {
     return std::find(rts.begin(), rts.end(), rt) != rts.end();
 }
 
+/*
+ * Returns an interned copy of strs.
+ */
+SharedVector<std::string> Intern(std::vector<std::string> &&strs);
+
 std::vector<Resource>::iterator FindResourceFromUri(std::vector<Resource> &resources,
         std::string uri);
 
 std::vector<Resource>::iterator FindResourceFromType(std::vector<Resource> &resources,
         std::string rt);
 
+/*
+ * Creates the resource at uri unless one already exists.  A created resource is added to the
+ * bridge's index of resources under device and must be deleted with DeleteResource().
+ */
 OCStackResult CreateResource(OCResourceHandle *handle, const char *uri, const char *typeName,
         const char *interfaceName, OCEntityHandler entityHandler, void *callbackParam,
-        uint8_t properties);
+        uint8_t properties, const char *device = NULL);
+OCStackResult DeleteResource(OCResourceHandle handle);
+
+/*
+ * Adds the stack's own resources to the bridge's index of resources, under the empty device
+ * name, replacing those added by an earlier call.  Called once the stack has been initialized
+ * and has created its resources, so that the index can be used without enumerating the stack.
+ */
+void IndexStackResources();
+
+/*
+ * Returns the indexed resources, all of them or only those of device, in the order they were
+ * added.  Unlike enumerating with OCGetResourceHandle(), this is not limited to 255 resources.
+ */
+std::vector<OCResourceHandle> GetResourceHandles();
+std::vector<OCResourceHandle> GetResourceHandles(const std::string &device);
+
+/* Returns the device a resource was indexed under. */
+std::string GetResourceDevice(OCResourceHandle handle);
 
 typedef void *DoHandle;
 OCStackResult DoResource(DoHandle *handle, OCMethod method, const char *uri,
@@ -83,6 +159,13 @@ OCStackResult Cancel(DoHandle handle, OCQualityOfService qos, OCHeaderOption *op
         uint8_t numOptions);
 
 bool IsValidRequest(OCEntityHandlerRequest *request);
+
+/*
+ * Returns the number of requests sent with DoResource() and received by the resources that
+ * check them with IsValidRequest().
+ */
+uint64_t GetRequestCount();
+
 std::map<std::string, std::string> ParseQuery(OCResourceHandle resource, const char *query);
 OCResourcePayload *ParseLink(OCRepPayload *payload);
 
@@ -0,0 +1,107 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "ResourceIndex.h"
+
+ResourceIndex::ResourceIndex()
+    : m_seq(0)
+{
+}
+
+void ResourceIndex::Add(OCResourceHandle handle, const std::string &device)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_entries.find(handle) != m_entries.end())
+    {
+        return;
+    }
+    Entry &entry = m_entries[handle];
+    entry.m_seq = m_seq++;
+    entry.m_device = device;
+    m_handles[entry.m_seq] = handle;
+    m_devices[device][entry.m_seq] = handle;
+}
+
+void ResourceIndex::Remove(OCResourceHandle handle)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::unordered_map<OCResourceHandle, Entry>::iterator it = m_entries.find(handle);
+    if (it == m_entries.end())
+    {
+        return;
+    }
+    m_handles.erase(it->second.m_seq);
+    std::map<std::string, Handles>::iterator device = m_devices.find(it->second.m_device);
+    if (device != m_devices.end())
+    {
+        device->second.erase(it->second.m_seq);
+        if (device->second.empty())
+        {
+            m_devices.erase(device);
+        }
+    }
+    m_entries.erase(it);
+}
+
+bool ResourceIndex::Contains(OCResourceHandle handle)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_entries.find(handle) != m_entries.end();
+}
+
+size_t ResourceIndex::Size()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_entries.size();
+}
+
+std::vector<OCResourceHandle> ResourceIndex::GetHandles()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<OCResourceHandle> handles;
+    handles.reserve(m_handles.size());
+    for (auto &handle : m_handles)
+    {
+        handles.push_back(handle.second);
+    }
+    return handles;
+}
+
+std::vector<OCResourceHandle> ResourceIndex::GetHandles(const std::string &device)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<OCResourceHandle> handles;
+    std::map<std::string, Handles>::iterator it = m_devices.find(device);
+    if (it != m_devices.end())
+    {
+        for (auto &handle : it->second)
+        {
+            handles.push_back(handle.second);
+        }
+    }
+    return handles;
+}
+
+std::string ResourceIndex::GetDevice(OCResourceHandle handle)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::unordered_map<OCResourceHandle, Entry>::iterator it = m_entries.find(handle);
+    return (it != m_entries.end()) ? it->second.m_device : std::string();
+}
@@ -0,0 +1,69 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#ifndef _RESOURCEINDEX_H
+#define _RESOURCEINDEX_H
+
+#include "octypes.h"
+#include <inttypes.h>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * The handles of the bridge's resources, grouped by the device they belong to.
+ *
+ * The stack can only enumerate its first 255 resources (OCGetResourceHandle() takes a uint8_t
+ * index) and finding each one walks its list of resources, so anything that needs all of the
+ * bridge's resources iterates this index instead.
+ */
+class ResourceIndex
+{
+    public:
+        ResourceIndex();
+
+        /* Adds handle to device, or does nothing if handle is already present. */
+        void Add(OCResourceHandle handle, const std::string &device);
+        void Remove(OCResourceHandle handle);
+        bool Contains(OCResourceHandle handle);
+        size_t Size();
+
+        /* Returns the handles in the order they were added. */
+        std::vector<OCResourceHandle> GetHandles();
+        std::vector<OCResourceHandle> GetHandles(const std::string &device);
+        /* Returns the device of handle, or the empty string if handle is not present. */
+        std::string GetDevice(OCResourceHandle handle);
+
+    private:
+        struct Entry {
+            uint64_t m_seq;
+            std::string m_device;
+        };
+        typedef std::map<uint64_t, OCResourceHandle> Handles;
+        std::mutex m_mutex;
+        uint64_t m_seq;
+        std::unordered_map<OCResourceHandle, Entry> m_entries;
+        Handles m_handles;
+        std::map<std::string, Handles> m_devices;
+};
+
+#endif
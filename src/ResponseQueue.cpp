@@ -0,0 +1,78 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "ResponseQueue.h"
+
+#include "Log.h"
+#include "ocpayload.h"
+#include "ocstack.h"
+#include <deque>
+#include <mutex>
+
+static std::mutex sMutex;
+static std::deque<OCEntityHandlerResponse> sResponses;
+
+static OCPayload *ClonePayload(OCPayload *payload)
+{
+    switch (payload->type)
+    {
+        case PAYLOAD_TYPE_REPRESENTATION:
+            return (OCPayload *) OCRepPayloadClone((OCRepPayload *) payload);
+        case PAYLOAD_TYPE_DIAGNOSTIC:
+            return (OCPayload *) OCDiagnosticPayloadCreate(((OCDiagnosticPayload *) payload)->message);
+        default:
+            LOG(LOG_ERR, "Unexpected payload type %d", payload->type);
+            return NULL;
+    }
+}
+
+OCStackResult QueueResponse(OCEntityHandlerResponse *response)
+{
+    OCEntityHandlerResponse queued = *response;
+    if (response->payload)
+    {
+        queued.payload = ClonePayload(response->payload);
+        if (!queued.payload)
+        {
+            return OC_STACK_NO_MEMORY;
+        }
+    }
+    std::lock_guard<std::mutex> lock(sMutex);
+    sResponses.push_back(queued);
+    return OC_STACK_OK;
+}
+
+void ProcessResponses()
+{
+    std::deque<OCEntityHandlerResponse> responses;
+    {
+        std::lock_guard<std::mutex> lock(sMutex);
+        responses.swap(sResponses);
+    }
+    for (OCEntityHandlerResponse &response : responses)
+    {
+        OCStackResult result = OCDoResponse(&response);
+        if (result != OC_STACK_OK)
+        {
+            LOG(LOG_ERR, "OCDoResponse - %d", result);
+        }
+        OCPayloadDestroy(response.payload);
+    }
+}
@@ -0,0 +1,41 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#ifndef _RESPONSEQUEUE_H
+#define _RESPONSEQUEUE_H
+
+#include "octypes.h"
+
+/*
+ * Responses to requests handled off of the thread calling OCProcess() are queued with
+ * QueueResponse() and sent by that thread from ProcessResponses().
+ */
+
+/*
+ * Queues a copy of response and its payload.  The caller retains ownership of response.
+ */
+OCStackResult QueueResponse(OCEntityHandlerResponse *response);
+
+/*
+ * Called from the thread calling OCProcess().
+ */
+void ProcessResponses();
+
+#endif
@@ -32,7 +32,7 @@ SecureModeResource::SecureModeResource(std::mutex &mutex, bool secureMode)
 
 SecureModeResource::~SecureModeResource()
 {
-    OCDeleteResource(m_handle);
+    DeleteResource(m_handle);
 }
 
 OCStackResult SecureModeResource::Create()
@@ -0,0 +1,153 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "SeenStates.h"
+
+#include "Log.h"
+#include "PayloadStore.h"
+#include "ocpayload.h"
+
+SeenStates::SeenStates(const char *filename)
+    : m_filename(filename), m_isDirty(false)
+{
+}
+
+Bridge::SeenState SeenStates::Get(const std::string &piid)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Entries::iterator it = m_entries.find(piid);
+    return (it != m_entries.end()) ? it->second.m_state : Bridge::NOT_SEEN;
+}
+
+void SeenStates::Set(const std::string &piid, Bridge::SeenState state)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (state == Bridge::NOT_SEEN)
+    {
+        m_entries.erase(piid);
+    }
+    else
+    {
+        Entry &entry = m_entries[piid];
+        entry.m_state = state;
+        entry.m_pid = 0;
+    }
+    m_isDirty = true;
+}
+
+void SeenStates::SetPid(const std::string &piid, int64_t pid)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Entries::iterator it = m_entries.find(piid);
+    if (it != m_entries.end())
+    {
+        it->second.m_pid = pid;
+        m_isDirty = true;
+    }
+}
+
+void SeenStates::Exited(const std::string &piid, int64_t pid)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Entries::iterator it = m_entries.find(piid);
+    if ((it != m_entries.end()) && (it->second.m_pid == pid))
+    {
+        m_entries.erase(it);
+        m_isDirty = true;
+    }
+}
+
+bool SeenStates::Load(bool (*isAlive)(int64_t pid))
+{
+    if (!m_filename)
+    {
+        return false;
+    }
+    PayloadStore store;
+    if (!store.Load(m_filename))
+    {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto &stored : store.GetAll())
+    {
+        int64_t state;
+        int64_t pid;
+        if (OCRepPayloadGetPropInt(stored.second.get(), "state", &state) &&
+                OCRepPayloadGetPropInt(stored.second.get(), "pid", &pid) &&
+                (state != Bridge::NOT_SEEN) && pid && isAlive(pid))
+        {
+            Entry &entry = m_entries[stored.first];
+            entry.m_state = (Bridge::SeenState) state;
+            entry.m_pid = pid;
+        }
+    }
+    LOG(LOG_INFO, "[%p] Restored %zu of %zu entries", this, m_entries.size(),
+            store.GetAll().size());
+    return true;
+}
+
+void SeenStates::Flush()
+{
+    Entries entries;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_isDirty)
+        {
+            return;
+        }
+        m_isDirty = false;
+        entries = m_entries;
+    }
+    /* Writing the file does not hold up the callers of Get() and Set() */
+    if (!Save(entries))
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_isDirty = true;
+    }
+}
+
+bool SeenStates::Save(const Entries &entries)
+{
+    if (!m_filename)
+    {
+        return true;
+    }
+    PayloadStore store;
+    for (auto &entry : entries)
+    {
+        OCRepPayload *payload = OCRepPayloadCreate();
+        if (!payload)
+        {
+            LOG(LOG_ERR, "Failed to create payload");
+            return false;
+        }
+        OCRepPayloadSetPropInt(payload, "state", entry.second.m_state);
+        OCRepPayloadSetPropInt(payload, "pid", entry.second.m_pid);
+        store.Put(entry.first, payload);
+        OCRepPayloadDestroy(payload);
+    }
+    if (!store.Save(m_filename))
+    {
+        LOG(LOG_ERR, "[%p] Save %s failed", this, m_filename);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,82 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#ifndef _SEENSTATES_H
+#define _SEENSTATES_H
+
+#include "Bridge.h"
+#include <inttypes.h>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+/*
+ * The seen state of each device that a bridge process has been started for, kept in memory by
+ * the bridge that starts them.  The table is saved by Flush() after it changes so that it can
+ * be restored after a crash, and is not read back otherwise.
+ */
+class SeenStates
+{
+    public:
+        /*
+         * @param[in] filename where the table is saved using the OC persistent storage
+         *                     handler, or NULL to keep it only in memory.
+         */
+        SeenStates(const char *filename);
+
+        Bridge::SeenState Get(const std::string &piid);
+
+        /*
+         * Sets the state of piid when its bridge process is started.  The process is unknown
+         * until SetPid() is called.
+         */
+        void Set(const std::string &piid, Bridge::SeenState state);
+        void SetPid(const std::string &piid, int64_t pid);
+
+        /*
+         * Called when process pid has exited.  piid is set to NOT_SEEN unless another process
+         * has been started for it since.
+         */
+        void Exited(const std::string &piid, int64_t pid);
+
+        /*
+         * Restores the table saved before a crash.  Only the entries whose process is still
+         * running according to isAlive() are kept.
+         */
+        bool Load(bool (*isAlive)(int64_t pid));
+
+        /* Saves the table if it has changed since it was last saved. */
+        void Flush();
+
+    private:
+        struct Entry {
+            Bridge::SeenState m_state;
+            int64_t m_pid;
+        };
+        typedef std::unordered_map<std::string, Entry> Entries;
+        std::mutex m_mutex;
+        const char *m_filename;
+        Entries m_entries;
+        bool m_isDirty;
+
+        bool Save(const Entries &entries);
+};
+
+#endif
@@ -0,0 +1,100 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "Strand.h"
+
+const size_t Strand::MAX_BATCH;
+
+Strand::Strand(WorkerPool *pool, size_t maxQueued)
+    : m_pool(pool), m_maxQueued(maxQueued), m_isRunning(false), m_isDestroyed(false)
+{
+}
+
+Strand::~Strand()
+{
+    std::deque<Item> discarded;
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_isDestroyed = true;
+        discarded.swap(m_queue);
+        while (m_isRunning)
+        {
+            m_cond.wait(lock);
+        }
+    }
+    for (Item &item : discarded)
+    {
+        if (item.m_discard)
+        {
+            item.m_discard();
+        }
+    }
+}
+
+bool Strand::Post(WorkerPool::Work work, WorkerPool::Work discard)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_isDestroyed || (m_queue.size() >= m_maxQueued))
+    {
+        return false;
+    }
+    Item item;
+    item.m_work = work;
+    item.m_discard = discard;
+    m_queue.push_back(item);
+    if (!m_isRunning)
+    {
+        /* Only one item of this strand is ever queued to or running in the pool */
+        if (!m_pool->Post(std::bind(&Strand::Run, this)))
+        {
+            m_queue.pop_back();
+            return false;
+        }
+        m_isRunning = true;
+    }
+    return true;
+}
+
+void Strand::Run()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (size_t n = 0; !m_queue.empty(); ++n)
+    {
+        if (n == MAX_BATCH)
+        {
+            /*
+             * Give the other work queued to the pool a turn.  If the pool is full, carry on here
+             * rather than leave the queued items without a job to run them.
+             */
+            if (m_pool->Post(std::bind(&Strand::Run, this)))
+            {
+                return;
+            }
+            n = 0;
+        }
+        WorkerPool::Work work = m_queue.front().m_work;
+        m_queue.pop_front();
+        lock.unlock();
+        work();
+        lock.lock();
+    }
+    m_isRunning = false;
+    m_cond.notify_all();
+}
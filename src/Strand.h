@@ -0,0 +1,74 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#ifndef _STRAND_H
+#define _STRAND_H
+
+#include "WorkerPool.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+/*
+ * Runs work posted to it one item at a time, in order, on the threads of a WorkerPool.
+ */
+class Strand
+{
+    public:
+        /* The most items run by one job of the pool before the strand yields its worker */
+        static const size_t MAX_BATCH = 8;
+
+        /*
+         * @param[in] pool the pool the work is run on
+         * @param[in] maxQueued the most items queued to the strand and not yet running
+         */
+        Strand(WorkerPool *pool, size_t maxQueued);
+
+        /*
+         * Discards any queued work, calling the discard function it was posted with, and waits
+         * for running work to complete.
+         */
+        ~Strand();
+
+        /*
+         * @param[in] work the work to run
+         * @param[in] discard called instead of work if the strand is destroyed first
+         *
+         * @return false if the strand is full or the work could not be queued to the pool.
+         */
+        bool Post(WorkerPool::Work work, WorkerPool::Work discard = WorkerPool::Work());
+
+    private:
+        struct Item {
+            WorkerPool::Work m_work;
+            WorkerPool::Work m_discard;
+        };
+        WorkerPool *m_pool;
+        size_t m_maxQueued;
+        std::mutex m_mutex;
+        std::condition_variable m_cond;
+        std::deque<Item> m_queue;
+        bool m_isRunning;
+        bool m_isDestroyed;
+
+        void Run();
+};
+
+#endif
@@ -0,0 +1,287 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "Supervisor.h"
+
+#include "Log.h"
+#include <algorithm>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+const time_t Supervisor::MIN_BACKOFF_SECS;
+const time_t Supervisor::MAX_BACKOFF_SECS;
+const time_t Supervisor::STABLE_SECS;
+const unsigned Supervisor::MAX_RESTARTS;
+
+Supervisor::Supervisor(const Limits &limits, time_t heartbeatTimeoutSecs,
+        time_t startupGraceSecs)
+    : m_limits(limits), m_heartbeatTimeoutSecs(heartbeatTimeoutSecs),
+    m_startupGraceSecs(startupGraceSecs), m_totalRestarts(0)
+{
+}
+
+static bool SetLimit(int resource, rlim_t value, rlim_t hardValue)
+{
+    if (value == RLIM_INFINITY)
+    {
+        return true;
+    }
+    struct rlimit limit;
+    limit.rlim_cur = value;
+    limit.rlim_max = hardValue;
+    return setrlimit(resource, &limit) == 0;
+}
+
+bool Supervisor::ApplyLimits(const Limits &limits)
+{
+    /* The soft CPU limit sends SIGXCPU, the hard one a second later SIGKILL */
+    return SetLimit(RLIMIT_CPU, limits.m_cpuSecs,
+            (limits.m_cpuSecs == RLIM_INFINITY) ? RLIM_INFINITY : limits.m_cpuSecs + 1) &&
+            SetLimit(RLIMIT_AS, limits.m_addressSpaceBytes, limits.m_addressSpaceBytes) &&
+            SetLimit(RLIMIT_NOFILE, limits.m_files, limits.m_files);
+}
+
+time_t Supervisor::GetBackoff(unsigned restarts)
+{
+    time_t backoff = MIN_BACKOFF_SECS;
+    for (unsigned i = 0; (i < restarts) && (backoff < MAX_BACKOFF_SECS); ++i)
+    {
+        backoff *= 2;
+    }
+    return std::min(backoff, MAX_BACKOFF_SECS);
+}
+
+bool Supervisor::ReadProcStats(pid_t pid, uint64_t *cpuMs, uint64_t *rssBytes)
+{
+    char path[64];
+    char buf[1024];
+    uint64_t utime, stime, resident;
+    bool success = false;
+    const char *p;
+
+    snprintf(path, sizeof(path), "/proc/%d/stat", (int) pid);
+    FILE *fp = fopen(path, "r");
+    if (!fp)
+    {
+        return false;
+    }
+    p = fgets(buf, sizeof(buf), fp);
+    fclose(fp);
+    /* The command name may contain spaces and parentheses, so start after the last ')' */
+    p = p ? strrchr(buf, ')') : NULL;
+    if (!p || (sscanf(p + 1, " %*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %" SCNu64 " %" SCNu64,
+            &utime, &stime) != 2))
+    {
+        goto exit;
+    }
+    snprintf(path, sizeof(path), "/proc/%d/statm", (int) pid);
+    fp = fopen(path, "r");
+    if (!fp)
+    {
+        goto exit;
+    }
+    success = (fscanf(fp, "%*u %" SCNu64, &resident) == 1);
+    fclose(fp);
+    if (success)
+    {
+        *cpuMs = ((utime + stime) * 1000) / sysconf(_SC_CLK_TCK);
+        *rssBytes = resident * sysconf(_SC_PAGESIZE);
+    }
+
+exit:
+    return success;
+}
+
+void Supervisor::Add(pid_t pid, const std::string &uuid, const std::vector<std::string> &args,
+        time_t now)
+{
+    Child &child = m_children[uuid];
+    unsigned restarts = child.m_restarts;
+    child = Child();
+    child.m_pid = pid;
+    child.m_args = args;
+    child.m_started = now;
+    child.m_restarts = restarts;
+}
+
+bool Supervisor::Heartbeat(pid_t pid, uint64_t requests, time_t now)
+{
+    std::map<std::string, Child>::iterator it = Find(pid);
+    if (it == m_children.end())
+    {
+        return false;
+    }
+    Child &child = it->second;
+    if (child.m_lastHeartbeat && (now > child.m_lastHeartbeat))
+    {
+        child.m_requestRate = (requests > child.m_requests) ?
+                (double) (requests - child.m_requests) / (now - child.m_lastHeartbeat) : 0;
+    }
+    child.m_requests = requests;
+    child.m_lastHeartbeat = now;
+    return true;
+}
+
+bool Supervisor::Remove(const std::string &uuid)
+{
+    return m_children.erase(uuid) > 0;
+}
+
+bool Supervisor::Exited(pid_t pid, int status, time_t now, std::string *uuid, bool *restart)
+{
+    std::map<std::string, Child>::iterator it = Find(pid);
+    if (it == m_children.end())
+    {
+        return false;
+    }
+    *uuid = it->first;
+    *restart = false;
+    Child &child = it->second;
+    if (WIFSIGNALED(status) && !child.m_args.empty())
+    {
+        if ((now - child.m_started) >= STABLE_SECS)
+        {
+            child.m_restarts = 0;
+        }
+        if (child.m_restarts < MAX_RESTARTS)
+        {
+            time_t backoff = GetBackoff(child.m_restarts);
+            LOG(LOG_INFO, "uuid=%s pid=%d signal=%d restart=%u in %lld s", uuid->c_str(),
+                    (int) pid, WTERMSIG(status), child.m_restarts + 1, (long long) backoff);
+            child.m_restartTick = now + backoff;
+            ++child.m_restarts;
+            *restart = true;
+            return true;
+        }
+        LOG(LOG_ERR, "uuid=%s pid=%d signal=%d not restarted after %u restarts",
+                uuid->c_str(), (int) pid, WTERMSIG(status), child.m_restarts);
+    }
+    m_children.erase(it);
+    return true;
+}
+
+std::vector<pid_t> Supervisor::Sample()
+{
+    std::vector<pid_t> over;
+    for (auto &kv : m_children)
+    {
+        Child &child = kv.second;
+        if (child.m_restartTick ||
+                !ReadProcStats(child.m_pid, &child.m_cpuMs, &child.m_rssBytes))
+        {
+            continue;
+        }
+        if (!child.m_args.empty() && m_limits.m_rssBytes &&
+                (child.m_rssBytes > m_limits.m_rssBytes))
+        {
+            LOG(LOG_ERR, "uuid=%s pid=%d rss=%" PRIu64 " over limit", kv.first.c_str(),
+                    (int) child.m_pid, child.m_rssBytes);
+            over.push_back(child.m_pid);
+        }
+    }
+    return over;
+}
+
+std::vector<pid_t> Supervisor::GetWedged(time_t now)
+{
+    std::vector<pid_t> wedged;
+    for (auto &kv : m_children)
+    {
+        Child &child = kv.second;
+        if (child.m_restartTick || child.m_args.empty())
+        {
+            continue;
+        }
+        time_t deadline = child.m_lastHeartbeat ? (child.m_lastHeartbeat + m_heartbeatTimeoutSecs)
+                : (child.m_started + m_startupGraceSecs);
+        if (now > deadline)
+        {
+            LOG(LOG_ERR, "uuid=%s pid=%d no heartbeat since %lld s", kv.first.c_str(),
+                    (int) child.m_pid, (long long) (now - (child.m_lastHeartbeat ?
+                            child.m_lastHeartbeat : child.m_started)));
+            wedged.push_back(child.m_pid);
+        }
+    }
+    return wedged;
+}
+
+std::vector<Supervisor::Restart> Supervisor::GetRestarts(time_t now)
+{
+    std::vector<Restart> restarts;
+    for (auto &kv : m_children)
+    {
+        Child &child = kv.second;
+        if (child.m_restartTick && (child.m_restartTick <= now))
+        {
+            Restart restart;
+            restart.m_pid = child.m_pid;
+            restart.m_uuid = kv.first;
+            restart.m_args = child.m_args;
+            restarts.push_back(restart);
+            child.m_pid = 0;
+            child.m_restartTick = 0;
+            ++m_totalRestarts;
+        }
+    }
+    return restarts;
+}
+
+void Supervisor::Dump(FILE *fp, time_t now)
+{
+    size_t running = 0;
+    uint64_t cpuMs = 0;
+    uint64_t rssBytes = 0;
+    double requestRate = 0;
+    fprintf(fp, "%-36s %8s %10s %10s %8s %8s %8s\n", "uuid", "pid", "cpu_ms", "rss_kb", "req/s",
+            "restarts", "idle_s");
+    for (auto &kv : m_children)
+    {
+        Child &child = kv.second;
+        fprintf(fp, "%-36s %8d %10" PRIu64 " %10" PRIu64 " %8.1f %8u %8lld\n",
+                kv.first.empty() ? "-" : kv.first.c_str(), (int) child.m_pid, child.m_cpuMs,
+                child.m_rssBytes / 1024, child.m_requestRate, child.m_restarts,
+                child.m_lastHeartbeat ? (long long) (now - child.m_lastHeartbeat) : -1LL);
+        if (!child.m_restartTick)
+        {
+            ++running;
+            cpuMs += child.m_cpuMs;
+            rssBytes += child.m_rssBytes;
+            requestRate += child.m_requestRate;
+        }
+    }
+    fprintf(fp, "total processes=%zu cpu_ms=%" PRIu64 " rss_kb=%" PRIu64
+            " req/s=%.1f restarts=%u\n", running, cpuMs, rssBytes / 1024, requestRate,
+            m_totalRestarts);
+    fflush(fp);
+}
+
+std::map<std::string, Supervisor::Child>::iterator Supervisor::Find(pid_t pid)
+{
+    std::map<std::string, Child>::iterator it;
+    for (it = m_children.begin(); it != m_children.end(); ++it)
+    {
+        if ((it->second.m_pid == pid) && !it->second.m_restartTick)
+        {
+            break;
+        }
+    }
+    return it;
+}
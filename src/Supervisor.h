@@ -0,0 +1,137 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#ifndef _SUPERVISOR_H
+#define _SUPERVISOR_H
+
+#include <inttypes.h>
+#include <map>
+#include <stdio.h>
+#include <string>
+#include <sys/resource.h>
+#include <sys/types.h>
+#include <time.h>
+#include <vector>
+
+/*
+ * Keeps the accounting of the bridge processes started by the PluginManager: CPU time and RSS
+ * sampled from /proc, request rates from the HEALTH messages of each process, and when to
+ * restart the processes that have crashed or stopped sending HEALTH messages.
+ *
+ * A process that is killed by a signal is restarted with the same arguments after a delay that
+ * doubles with each consecutive restart.  A process that exits on its own is not restarted.
+ */
+class Supervisor
+{
+    public:
+        static const time_t MIN_BACKOFF_SECS = 1;
+        static const time_t MAX_BACKOFF_SECS = 300;
+        /* A process that runs this long before crashing starts over with the shortest backoff */
+        static const time_t STABLE_SECS = 60;
+        static const unsigned MAX_RESTARTS = 8;
+
+        struct Limits {
+            /* Enforced by the kernel with setrlimit() in the child */
+            rlim_t m_cpuSecs;
+            rlim_t m_addressSpaceBytes;
+            rlim_t m_files;
+            /* Enforced by Sample(), since RLIMIT_RSS is not */
+            uint64_t m_rssBytes;
+            Limits() : m_cpuSecs(RLIM_INFINITY), m_addressSpaceBytes(RLIM_INFINITY),
+                m_files(RLIM_INFINITY), m_rssBytes(0) { }
+        };
+
+        struct Restart {
+            /* The process that exited */
+            pid_t m_pid;
+            std::string m_uuid;
+            std::vector<std::string> m_args;
+        };
+
+        /*
+         * @param[in] heartbeatTimeoutSecs how long a process may go without a HEALTH message
+         *                                 before it is considered wedged.
+         * @param[in] startupGraceSecs how long a process may take to send its first HEALTH
+         *                             message.
+         */
+        Supervisor(const Limits &limits, time_t heartbeatTimeoutSecs, time_t startupGraceSecs);
+
+        /* Called in the child between fork() and exec(). */
+        static bool ApplyLimits(const Limits &limits);
+        static time_t GetBackoff(unsigned restarts);
+        /* Reads the CPU time in milliseconds and the RSS in bytes of pid from /proc. */
+        static bool ReadProcStats(pid_t pid, uint64_t *cpuMs, uint64_t *rssBytes);
+
+        /*
+         * Starts supervising pid.  Replaces any process or pending restart of uuid, but keeps
+         * its restart count.  An empty args means the process is only accounted for: it is not
+         * restarted, and neither the limits nor the heartbeat timeout are enforced on it.
+         */
+        void Add(pid_t pid, const std::string &uuid, const std::vector<std::string> &args,
+                time_t now);
+        bool Heartbeat(pid_t pid, uint64_t requests, time_t now);
+
+        /*
+         * Stops supervising uuid, which is about to be stopped on purpose, or cancels its
+         * pending restart.  Returns false if uuid was not supervised.
+         */
+        bool Remove(const std::string &uuid);
+
+        /*
+         * Called when pid has exited with status from waitpid().  Returns true and sets uuid if
+         * the process was supervised, and sets restart if it will be restarted later.
+         */
+        bool Exited(pid_t pid, int status, time_t now, std::string *uuid, bool *restart);
+
+        /* Samples /proc for each process.  Returns the processes over the RSS limit. */
+        std::vector<pid_t> Sample();
+        /* Returns the processes that have stopped sending HEALTH messages. */
+        std::vector<pid_t> GetWedged(time_t now);
+        /* Returns the restarts that are due and forgets them. */
+        std::vector<Restart> GetRestarts(time_t now);
+
+        void Dump(FILE *fp, time_t now);
+
+    private:
+        struct Child {
+            pid_t m_pid;
+            std::vector<std::string> m_args;
+            time_t m_started;
+            time_t m_lastHeartbeat;
+            uint64_t m_requests;
+            double m_requestRate;
+            uint64_t m_cpuMs;
+            uint64_t m_rssBytes;
+            unsigned m_restarts;
+            /* When to restart m_pid once it has exited, 0 if it is running */
+            time_t m_restartTick;
+            Child() : m_pid(0), m_started(0), m_lastHeartbeat(0), m_requests(0),
+                m_requestRate(0), m_cpuMs(0), m_rssBytes(0), m_restarts(0), m_restartTick(0) { }
+        };
+        Limits m_limits;
+        time_t m_heartbeatTimeoutSecs;
+        time_t m_startupGraceSecs;
+        std::map<std::string, Child> m_children;
+        unsigned m_totalRestarts;
+
+        std::map<std::string, Child>::iterator Find(pid_t pid);
+};
+
+#endif
@@ -0,0 +1,199 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "Trace.h"
+
+#include "Log.h"
+#include "Metrics.h"
+#include <atomic>
+#include <stdio.h>
+
+static std::atomic<unsigned> sSampleOneIn(0);
+static std::atomic<uint64_t> sNumCreated(0);
+static std::atomic<uint64_t> sNextId(0);
+static std::mutex sFileMutex;
+static FILE *sFile = NULL;
+static bool sIsFirstEvent = true;
+static thread_local Trace *sCurrent = NULL;
+
+bool Trace::Start(const char *path, unsigned sampleOneIn)
+{
+    std::lock_guard<std::mutex> lock(sFileMutex);
+    if (sFile)
+    {
+        fclose(sFile);
+    }
+    sFile = fopen(path, "w");
+    if (!sFile)
+    {
+        LOG(LOG_ERR, "fopen(%s) failed", path);
+        sSampleOneIn = 0;
+        return false;
+    }
+    fputs("[\n", sFile);
+    fflush(sFile);
+    sIsFirstEvent = true;
+    sSampleOneIn = sampleOneIn;
+    return true;
+}
+
+void Trace::Stop()
+{
+    sSampleOneIn = 0;
+    std::lock_guard<std::mutex> lock(sFileMutex);
+    if (sFile)
+    {
+        fputs("\n]\n", sFile);
+        fclose(sFile);
+        sFile = NULL;
+    }
+}
+
+std::shared_ptr<Trace> Trace::Create(const char *name, const char *detail)
+{
+    unsigned sampleOneIn = sSampleOneIn.load(std::memory_order_relaxed);
+    if (!sampleOneIn || (sNumCreated.fetch_add(1, std::memory_order_relaxed) % sampleOneIn))
+    {
+        return std::shared_ptr<Trace>();
+    }
+    return std::make_shared<Trace>(name, detail);
+}
+
+std::shared_ptr<Trace> Trace::GetCurrent()
+{
+    return sCurrent ? sCurrent->shared_from_this() : std::shared_ptr<Trace>();
+}
+
+Trace::Trace(const char *name, const char *detail)
+    : m_id(++sNextId)
+{
+    Begin(name, detail ? detail : "");
+}
+
+static void WriteEscaped(FILE *fp, const std::string &str)
+{
+    for (char c : str)
+    {
+        if ((c == '"') || (c == '\\'))
+        {
+            fprintf(fp, "\\%c", c);
+        }
+        else if ((unsigned char) c < 0x20)
+        {
+            fprintf(fp, "\\u%04x", c);
+        }
+        else
+        {
+            fputc(c, fp);
+        }
+    }
+}
+
+Trace::~Trace()
+{
+    End(0);
+    std::lock_guard<std::mutex> lock(sFileMutex);
+    if (!sFile)
+    {
+        return;
+    }
+    uint64_t end = m_spans[0].m_end;
+    for (const Span &span : m_spans)
+    {
+        /* A span that was never ended, e.g. a request that timed out, lasts as long as the trace */
+        uint64_t dur = (span.m_end ? span.m_end : end) - span.m_begin;
+        fprintf(sFile, "%s{\"name\":\"%s\",\"cat\":\"bridge\",\"ph\":\"X\",\"pid\":0,"
+                "\"tid\":%" PRIu64 ",\"ts\":%" PRIu64 ".%03u,\"dur\":%" PRIu64 ".%03u,"
+                "\"args\":{\"detail\":\"", sIsFirstEvent ? "" : ",\n", span.m_name, m_id,
+                span.m_begin / 1000, (unsigned) (span.m_begin % 1000), dur / 1000,
+                (unsigned) (dur % 1000));
+        WriteEscaped(sFile, span.m_detail);
+        fputs("\"}}", sFile);
+        sIsFirstEvent = false;
+    }
+    fflush(sFile);
+}
+
+size_t Trace::Begin(const char *name, const std::string &detail)
+{
+    Span span;
+    span.m_name = name;
+    span.m_detail = detail;
+    span.m_begin = MetricsNow();
+    span.m_end = 0;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_spans.push_back(span);
+    return m_spans.size() - 1;
+}
+
+void Trace::End(size_t span)
+{
+    uint64_t now = MetricsNow();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if ((span < m_spans.size()) && !m_spans[span].m_end)
+    {
+        m_spans[span].m_end = now;
+    }
+}
+
+TraceScope::TraceScope(const std::shared_ptr<Trace> &trace)
+    : m_trace(trace), m_previous(sCurrent)
+{
+    sCurrent = m_trace.get();
+}
+
+TraceScope::~TraceScope()
+{
+    sCurrent = m_previous;
+}
+
+TraceSpan::TraceSpan(const char *name, bool isEnabled)
+    : m_trace(isEnabled ? sCurrent : NULL), m_span(0)
+{
+    if (m_trace)
+    {
+        m_span = m_trace->Begin(name);
+    }
+}
+
+TraceSpan::~TraceSpan()
+{
+    if (m_trace)
+    {
+        m_trace->End(m_span);
+    }
+}
+
+void TraceCall::Begin(const char *name, const char *detail)
+{
+    m_trace = Trace::GetCurrent();
+    if (m_trace)
+    {
+        m_span = m_trace->Begin(name, detail ? detail : "");
+    }
+}
+
+void TraceCall::End()
+{
+    if (m_trace)
+    {
+        m_trace->End(m_span);
+    }
+}
@@ -0,0 +1,124 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#ifndef _TRACE_H
+#define _TRACE_H
+
+#include <inttypes.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/*
+ * A sampled trace of one request through the bridge, made of spans that record when each
+ * stage started and ended.  A trace is created where a request enters the bridge and is
+ * carried along with the request's context across the asynchronous calls made for it.  It is
+ * written out when the last reference to it is released.
+ *
+ * Traces are written in the Chrome trace event format (load them in chrome://tracing or
+ * https://ui.perfetto.dev), one row per trace, so that each request shows as a flame chart of
+ * its stages.
+ *
+ * When tracing is disabled Create() returns NULL and the spans do nothing.
+ */
+class Trace : public std::enable_shared_from_this<Trace>
+{
+    public:
+        /*
+         * Starts writing one of every sampleOneIn traces to path.
+         *
+         * @return false if path could not be opened.
+         */
+        static bool Start(const char *path, unsigned sampleOneIn);
+        static void Stop();
+
+        /*
+         * @param[in] name a string literal naming the request, e.g. "oc.get".
+         * @param[in] detail the target of the request, e.g. a URI or member name.
+         *
+         * @return NULL if tracing is disabled or this request is not sampled.
+         */
+        static std::shared_ptr<Trace> Create(const char *name, const char *detail);
+
+        /* The trace of the request being handled by the calling thread, or NULL. */
+        static std::shared_ptr<Trace> GetCurrent();
+
+        Trace(const char *name, const char *detail);
+        ~Trace();
+
+        /* Spans may be ended on a different thread from the one they were begun on. */
+        size_t Begin(const char *name, const std::string &detail = std::string());
+        void End(size_t span);
+
+    private:
+        struct Span {
+            const char *m_name;
+            std::string m_detail;
+            uint64_t m_begin;
+            uint64_t m_end;
+        };
+        uint64_t m_id;
+        std::mutex m_mutex;
+        std::vector<Span> m_spans;
+};
+
+/* Makes trace the current trace of the calling thread for the lifetime of the object. */
+class TraceScope
+{
+    public:
+        TraceScope(const std::shared_ptr<Trace> &trace);
+        ~TraceScope();
+
+    private:
+        std::shared_ptr<Trace> m_trace;
+        Trace *m_previous;
+};
+
+/* A span of the current trace, if any, for the lifetime of the object. */
+class TraceSpan
+{
+    public:
+        TraceSpan(const char *name, bool isEnabled = true);
+        ~TraceSpan();
+
+    private:
+        Trace *m_trace;
+        size_t m_span;
+};
+
+/*
+ * A span of the current trace, if any, around an asynchronous call.  It is begun where the call
+ * is made and ended in the reply handler, and keeps the trace alive in between.
+ */
+class TraceCall
+{
+    public:
+        TraceCall() : m_span(0) { }
+        void Begin(const char *name, const char *detail = NULL);
+        void End();
+        const std::shared_ptr<Trace> &GetTrace() const { return m_trace; }
+
+    private:
+        std::shared_ptr<Trace> m_trace;
+        size_t m_span;
+};
+
+#endif
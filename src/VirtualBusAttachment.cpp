@@ -75,7 +75,8 @@ exit:
 
 VirtualBusAttachment::VirtualBusAttachment(const char *di, const char *piid, bool isVirtual)
     : ajn::BusAttachment(di), m_di(di), m_isVirtual(isVirtual), m_aboutData(NULL),
-    m_port(ajn::SESSION_PORT_ANY), m_numSessions(0), m_aboutObj(NULL)
+    m_port(ajn::SESSION_PORT_ANY), m_numSessions(0), m_isObserving(false),
+    m_cancelObserveTick(0), m_aboutObj(NULL)
 {
     LOG(LOG_INFO, "[%p] di=%s,piid=%s,isVirtual=%d", this, di, piid, isVirtual);
 
@@ -110,6 +111,32 @@ void VirtualBusAttachment::Stop()
     }
 }
 
+/*
+ * OC observations are only held open while there are AJ consumers in a session with this
+ * attachment.  When the last session is lost the observations are kept for OBSERVE_HOLD_SECS
+ * before being cancelled here.
+ *
+ * Session membership is the only interest signal available: the routing node does not report
+ * the match rules (such as one for PropertiesChanged) added by consumers to the producer, and
+ * PropertiesChanged is only sent to hosted sessions, so a consumer without a session would not
+ * receive the notifications of an observation anyway.
+ */
+void VirtualBusAttachment::Process()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_isObserving && !m_numSessions && m_cancelObserveTick &&
+            (time(NULL) >= m_cancelObserveTick))
+    {
+        LOG(LOG_INFO, "[%p] Cancel observe", this);
+        for (VirtualBusObject *busObj : m_virtualBusObjects)
+        {
+            busObj->CancelObserve();
+        }
+        m_isObserving = false;
+        m_cancelObserveTick = 0;
+    }
+}
+
 void VirtualBusAttachment::SetAboutData(OCRepPayload *payload)
 {
     LOG(LOG_INFO, "[%p]", this);
@@ -138,6 +165,11 @@ QStatus VirtualBusAttachment::RegisterBusObject(VirtualBusObject *busObject, boo
     if (status == ER_OK)
     {
         m_virtualBusObjects.push_back(busObject);
+        if (m_isObserving)
+        {
+            /* Registered after a consumer joined, so not observed by SessionJoined() */
+            busObject->Observe();
+        }
     }
     else
     {
@@ -193,9 +225,14 @@ void VirtualBusAttachment::SessionJoined(ajn::SessionPort port, ajn::SessionId i
     }
     if (m_numSessions++ == 0)
     {
-        for (VirtualBusObject *busObj : m_virtualBusObjects)
+        m_cancelObserveTick = 0;
+        if (!m_isObserving)
         {
-            busObj->Observe();
+            for (VirtualBusObject *busObj : m_virtualBusObjects)
+            {
+                busObj->Observe();
+            }
+            m_isObserving = true;
         }
     }
 }
@@ -209,10 +246,8 @@ void VirtualBusAttachment::SessionLost(ajn::SessionId id,
     assert(m_numSessions > 0);
     if (--m_numSessions == 0)
     {
-        for (VirtualBusObject *busObj : m_virtualBusObjects)
-        {
-            busObj->CancelObserve();
-        }
+        /* Cancellation is deferred to Process() */
+        m_cancelObserveTick = time(NULL) + OBSERVE_HOLD_SECS;
     }
 }
 
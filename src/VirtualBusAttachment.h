@@ -28,6 +28,7 @@
 #include <alljoyn/AboutObj.h>
 #include <alljoyn/BusAttachment.h>
 #include <mutex>
+#include <time.h>
 #include <vector>
 
 class AllJoynSecurity;
@@ -49,8 +50,15 @@ class VirtualBusAttachment : public ajn::BusAttachment
         VirtualBusObject *GetConfigBusObject();
         QStatus Announce();
         void Stop();
+        void Process();
 
     private:
+        /*
+         * Time to keep OC observations open after the last AJ session is lost, so that a consumer
+         * that leaves and rejoins does not cause a cancel and re-register with the OC device.
+         */
+        static const time_t OBSERVE_HOLD_SECS = 10;
+
         std::string m_di;
         std::string m_piid;
         bool m_isVirtual;
@@ -58,6 +66,8 @@ class VirtualBusAttachment : public ajn::BusAttachment
         AboutData m_aboutData;
         ajn::SessionPort m_port;
         uint32_t m_numSessions;
+        bool m_isObserving;
+        time_t m_cancelObserveTick;
         std::vector<VirtualBusObject *> m_virtualBusObjects;
         ajn::AboutObj *m_aboutObj;
         AllJoynSecurity *m_ajSecurity;
@@ -21,9 +21,13 @@
 #include "VirtualBusObject.h"
 
 #include "Log.h"
+#include "Metrics.h"
 #include "Name.h"
 #include "Payload.h"
 #include "Plugin.h"
+#include "Presence.h"
+#include "Probes.h"
+#include "Trace.h"
 #include "VirtualBusAttachment.h"
 #include "ocpayload.h"
 #include "ocstack.h"
@@ -31,6 +35,19 @@
 #include "oic_string.h"
 #include <algorithm>
 #include <assert.h>
+#include <map>
+
+static Counter sGetRequests("aj_to_oc.requests.get");
+static Counter sPostRequests("aj_to_oc.requests.post");
+static Counter sObserveRequests("aj_to_oc.requests.observe");
+static Counter sOtherRequests("aj_to_oc.requests.other");
+static Counter sFailedRequests("aj_to_oc.requests.failed");
+/* Number of OC observe relationships currently held open by all virtual bus objects */
+static Gauge sActiveObserves("aj_to_oc.observes");
+static Histogram sLatency("aj_to_oc.latency_ns");
+static Gauge sPending("aj_to_oc.pending");
+static Counter sSignalsSent("aj.signals.sent");
+static Counter sSignalsDropped("aj.signals.dropped");
 
 struct VirtualBusObject::ObserveContext
 {
@@ -43,15 +60,69 @@ public:
         ObserveContext *context = reinterpret_cast<ObserveContext *>(ctx);
         {
             std::lock_guard<std::mutex> lock(context->m_obj->m_mutex);
-            context->m_obj->m_observes.erase(context);
+            if (context->m_obj->m_observes.erase(context))
+            {
+                sActiveObserves.Decrement();
+            }
             context->m_obj->m_cond.notify_one();
         }
         delete context;
     }
+    /*
+     * Removes the entries of the a{sv} dict that are unchanged since the last emitted values, and
+     * collects the names of the emitted properties missing from the dict as invalidated.
+     * Returns the number of remaining entries and invalidated names.
+     */
+    size_t RemoveUnchanged(ajn::MsgArg *dict, std::vector<ajn::MsgArg> &changed,
+            std::vector<std::string> &invalidated)
+    {
+        size_t numEntries = dict->v_array.GetNumElements();
+        const ajn::MsgArg *entries = dict->v_array.GetElements();
+        std::set<std::string> keys;
+        for (size_t i = 0; i < numEntries; ++i)
+        {
+            const char *key = entries[i].v_dictEntry.key->v_string.str;
+            const ajn::MsgArg *val = entries[i].v_dictEntry.val;
+            keys.insert(key);
+            std::map<std::string, ajn::MsgArg>::iterator it = m_values.find(key);
+            if ((it == m_values.end()) || !(it->second == *val))
+            {
+                changed.push_back(entries[i]);
+            }
+        }
+        for (std::map<std::string, ajn::MsgArg>::iterator it = m_values.begin();
+             it != m_values.end(); ++it)
+        {
+            if (keys.find(it->first) == keys.end())
+            {
+                invalidated.push_back(it->first);
+            }
+        }
+        if (changed.size() != numEntries)
+        {
+            dict->Set("a{sv}", changed.size(), changed.empty() ? NULL : &changed[0]);
+        }
+        return changed.size() + invalidated.size();
+    }
+    /* Records the values of a PropertiesChanged signal once it has been emitted. */
+    void Emitted(const std::vector<ajn::MsgArg> &changed,
+            const std::vector<std::string> &invalidated)
+    {
+        for (const ajn::MsgArg &entry : changed)
+        {
+            m_values[entry.v_dictEntry.key->v_string.str] = *entry.v_dictEntry.val;
+        }
+        for (const std::string &name : invalidated)
+        {
+            m_values.erase(name);
+        }
+    }
     VirtualBusObject *m_obj;
     std::string m_iface;
     DoHandle m_handle;
     OCStackApplicationResult m_result;
+    /* Last emitted value of each property, keyed by AJ property name */
+    std::map<std::string, ajn::MsgArg> m_values;
 };
 
 struct VirtualBusObject::DoResourceContext
@@ -59,12 +130,14 @@ struct VirtualBusObject::DoResourceContext
 public:
     DoResourceContext(VirtualBusObject *obj, VirtualBusObject::DoResourceHandler cb, void *context,
             ajn::Message &msg)
-        : m_obj(obj), m_cb(cb), m_context(context), m_msg(msg), m_handle(NULL) { }
+        : m_obj(obj), m_cb(cb), m_context(context), m_msg(msg), m_handle(NULL),
+          m_started(MetricsNow()) { }
     VirtualBusObject *m_obj;
     VirtualBusObject::DoResourceHandler m_cb;
     void *m_context;
     ajn::Message m_msg;
     DoHandle m_handle;
+    uint64_t m_started;
 };
 
 VirtualBusObject::VirtualBusObject(VirtualBusAttachment *bus, Resource &resource)
@@ -179,11 +252,17 @@ void VirtualBusObject::Observe(Resource &resource)
         cbData.context = context;
         cbData.cd = ObserveContext::Deleter;
         LOG(LOG_INFO, "[%p] Observe uri=%s", this, uri.c_str());
+        sObserveRequests.Increment();
         OCStackResult result = ::DoResource(&context->m_handle, OC_REST_OBSERVE, uri.c_str(),
                 resource.m_addrs, NULL, &cbData, NULL, 0);
         if (result == OC_STACK_OK)
         {
             m_observes.insert(context);
+            sActiveObserves.Increment();
+        }
+        else
+        {
+            delete context;
         }
     }
 }
@@ -192,11 +271,24 @@ void VirtualBusObject::CancelObserve()
 {
     LOG(LOG_INFO, "[%p]", this);
 
-    std::lock_guard<std::mutex> lock(m_mutex);
-    for (ObserveContext *context : m_observes)
+    /* Cancel outside of m_mutex since the deleter of a cancelled observe takes it. */
+    std::vector<DoHandle> handles;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (ObserveContext *context : m_observes)
+        {
+            if (context->m_result == OC_STACK_DELETE_TRANSACTION)
+            {
+                /* Already cancelled */
+                continue;
+            }
+            context->m_result = OC_STACK_DELETE_TRANSACTION;
+            handles.push_back(context->m_handle);
+        }
+    }
+    for (DoHandle handle : handles)
     {
-        context->m_result = OC_STACK_DELETE_TRANSACTION;
-        OCStackResult result = Cancel(context->m_handle, OC_HIGH_QOS, NULL, 0);
+        OCStackResult result = Cancel(handle, OC_HIGH_QOS, NULL, 0);
         if (result != OC_STACK_OK)
         {
             LOG(LOG_ERR, "Cancel - %d", result);
@@ -223,8 +315,13 @@ OCStackApplicationResult VirtualBusObject::ObserveCB(void *ctx, OCDoHandle handl
     ObserveContext *context = reinterpret_cast<ObserveContext *>(ctx);
     LOG(LOG_INFO, "[%p] ctx=%p,handle=%p,response=%p,{payload=%p,result=%d}", context->m_obj, ctx,
             handle, response, response ? response->payload : 0, response ? response->result : 0);
+    PROBE2(oc_observe, context, response ? (int) response->result : -1);
 
     std::lock_guard<std::mutex> lock(context->m_obj->m_mutex);
+    if (response && response->result == OC_STACK_OK)
+    {
+        OCPresence::Responded(context->m_obj->m_bus->GetDi());
+    }
     if (response && response->result == OC_STACK_OK && response->payload)
     {
         OCRepPayloadValue value;
@@ -236,7 +333,20 @@ OCStackApplicationResult VirtualBusObject::ObserveCB(void *ctx, OCDoHandle handl
         args[0].Set("s", context->m_iface.c_str());
         std::string valueType = std::string("[") + context->m_iface + ".Properties" + "]";
         ToAJMsgArg(&args[1], "a{sv}", &value, valueType.c_str());
-        args[2].Set("as", 0, NULL);
+        /* OC servers commonly send the full representation, only signal what has changed */
+        std::vector<ajn::MsgArg> changed;
+        std::vector<std::string> invalidated;
+        if (!context->RemoveUnchanged(&args[1], changed, invalidated))
+        {
+            LOG(LOG_INFO, "[%p] No properties changed", context->m_obj);
+            return context->m_result;
+        }
+        std::vector<const char *> names;
+        for (const std::string &name : invalidated)
+        {
+            names.push_back(name.c_str());
+        }
+        args[2].Set("as", names.size(), names.empty() ? NULL : &names[0]);
         const ajn::InterfaceDescription *iface = context->m_obj->m_bus->GetInterface(
                     ajn::org::freedesktop::DBus::Properties::InterfaceName);
         assert(iface);
@@ -245,9 +355,16 @@ OCStackApplicationResult VirtualBusObject::ObserveCB(void *ctx, OCDoHandle handl
         QStatus status = context->m_obj->Signal(NULL, ajn::SESSION_ID_ALL_HOSTED,
                                                 *member,
                                                 args, 3);
-        if (status != ER_OK)
+        if (status == ER_OK)
+        {
+            /* Only what was signalled is recorded, so a dropped change is sent again */
+            context->Emitted(changed, invalidated);
+            sSignalsSent.Increment();
+        }
+        else
         {
             LOG(LOG_ERR, "Signal - %s", QCC_StatusText(status));
+            sSignalsDropped.Increment();
         }
     }
     return context->m_result;
@@ -257,6 +374,7 @@ void VirtualBusObject::GetProp(const ajn::InterfaceDescription::Member *member,
 {
     LOG(LOG_INFO, "[%p] member=%p", this, member);
 
+    TraceScope scope(Trace::Create("aj.GetProp", GetPath()));
     std::lock_guard<std::mutex> lock(m_mutex);
     std::vector<Resource>::iterator resource;
     std::string uri;
@@ -337,6 +455,7 @@ void VirtualBusObject::SetProp(const ajn::InterfaceDescription::Member *member,
 {
     LOG(LOG_INFO, "[%p] member=%p", this, member);
 
+    TraceScope scope(Trace::Create("aj.SetProp", GetPath()));
     std::lock_guard<std::mutex> lock(m_mutex);
     std::vector<Resource>::iterator resource;
     std::string uri;
@@ -410,6 +529,7 @@ void VirtualBusObject::GetAllProps(const ajn::InterfaceDescription::Member *memb
 {
     LOG(LOG_INFO, "[%p] member=%p", this, member);
 
+    TraceScope scope(Trace::Create("aj.GetAllProps", GetPath()));
     std::lock_guard<std::mutex> lock(m_mutex);
     std::vector<Resource>::iterator resource;
     std::string uri;
@@ -470,11 +590,24 @@ void VirtualBusObject::GetAllPropsCB(ajn::Message &msg, OCRepPayload *payload, v
 }
 
 /* This must be called with m_mutex held. */
-void VirtualBusObject::DoResource(OCMethod method, std::string uri, std::vector<OCDevAddr> addrs,
-        OCRepPayload *payload, ajn::Message &msg, DoResourceHandler cb, void *ctx)
+void VirtualBusObject::DoResource(OCMethod method, std::string uri,
+        const std::vector<OCDevAddr> &addrs, OCRepPayload *payload, ajn::Message &msg,
+        DoResourceHandler cb, void *ctx)
 {
     LOG(LOG_INFO, "[%p] method=%d,uri=%s,payload=%p", this, method, uri.c_str(), payload);
 
+    switch (method)
+    {
+        case OC_REST_GET:
+            sGetRequests.Increment();
+            break;
+        case OC_REST_POST:
+            sPostRequests.Increment();
+            break;
+        default:
+            sOtherRequests.Increment();
+            break;
+    }
     DoResourceContext *context = new DoResourceContext(this, cb, ctx, msg);
     OCCallbackData cbData;
     cbData.cb = VirtualBusObject::DoResourceCB;
@@ -485,9 +618,11 @@ void VirtualBusObject::DoResource(OCMethod method, std::string uri, std::vector<
     if (result == OC_STACK_OK)
     {
         ++m_pending;
+        sPending.Increment();
     }
     else
     {
+        sFailedRequests.Increment();
         delete context;
         QStatus status = MethodReply(msg, ER_FAIL);
         if (status != ER_OK)
@@ -504,7 +639,12 @@ OCStackApplicationResult VirtualBusObject::DoResourceCB(void *ctx, OCDoHandle ha
     LOG(LOG_INFO, "[%p] ctx=%p,handle=%p,response=%p,{payload=%p,result=%d}", context->m_obj, ctx,
             handle, response, response ? response->payload : 0, response ? response->result : 0);
 
+    TraceSpan span("aj.reply");
     std::lock_guard<std::mutex> lock(context->m_obj->m_mutex);
+    if (response && (response->result <= OC_STACK_RESOURCE_CHANGED))
+    {
+        OCPresence::Responded(context->m_obj->m_bus->GetDi());
+    }
     if (response && (response->result > OC_STACK_RESOURCE_CHANGED))
     {
         QStatus status;
@@ -585,7 +725,13 @@ OCStackApplicationResult VirtualBusObject::DoResourceCB(void *ctx, OCDoHandle ha
         OCRepPayload *payload = (OCRepPayload *) response->payload;
         (context->m_obj->*(context->m_cb))(context->m_msg, payload, context->m_context);
     }
+    if (!response || (response->result > OC_STACK_RESOURCE_CHANGED))
+    {
+        sFailedRequests.Increment();
+    }
+    sLatency.Record(MetricsNow() - context->m_started);
     --context->m_obj->m_pending;
+    sPending.Decrement();
     context->m_obj->m_cond.notify_one();
     delete context;
     return OC_STACK_DELETE_TRANSACTION;
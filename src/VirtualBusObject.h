@@ -57,7 +57,7 @@ class VirtualBusObject : public ajn::BusObject
         virtual void SetProp(const ajn::InterfaceDescription::Member *member, ajn::Message &msg);
         virtual void GetAllProps(const ajn::InterfaceDescription::Member *member,
                 ajn::Message &msg);
-        void DoResource(OCMethod method, std::string uri, std::vector<OCDevAddr> addrs,
+        void DoResource(OCMethod method, std::string uri, const std::vector<OCDevAddr> &addrs,
                 OCRepPayload *payload, ajn::Message &msg, DoResourceHandler cb,
                 void *context = NULL);
 
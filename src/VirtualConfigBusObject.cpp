@@ -28,6 +28,7 @@
 #include "PlatformConfigurationResource.h"
 #include "Plugin.h"
 #include "Signature.h"
+#include "Trace.h"
 #include "VirtualBusAttachment.h"
 #include "ocpayload.h"
 #include "oic_malloc.h"
@@ -127,6 +128,7 @@ void VirtualConfigBusObject::GetConfigurations(const ajn::InterfaceDescription::
 {
     LOG(LOG_INFO, "[%p] member=%p", this, member);
 
+    TraceScope scope(Trace::Create("aj.GetConfigurations", GetPath()));
     std::lock_guard<std::mutex> lock(m_mutex);
     std::vector<Resource>::iterator resource;
     ConfigurationsContext *context = new ConfigurationsContext(msg->GetArg(0)->v_string.str);
@@ -224,6 +226,7 @@ void VirtualConfigBusObject::UpdateConfigurations(const ajn::InterfaceDescriptio
 {
     LOG(LOG_INFO, "[%p] member=%p", this, member);
 
+    TraceScope scope(Trace::Create("aj.UpdateConfigurations", GetPath()));
     std::lock_guard<std::mutex> lock(m_mutex);
     OCStackResult result = OC_STACK_ERROR;
     const char *lang;
@@ -338,6 +341,7 @@ void VirtualConfigBusObject::FactoryReset(const ajn::InterfaceDescription::Membe
     (void) msg;
     LOG(LOG_INFO, "[%p] member=%p", this, member);
 
+    TraceScope scope(Trace::Create("aj.FactoryReset", GetPath()));
     std::lock_guard<std::mutex> lock(m_mutex);
     auto resource = FindResourceFromType(m_resources, "oic.wk.mnt");
     if (resource == m_resources.end())
@@ -383,6 +387,7 @@ void VirtualConfigBusObject::Restart(const ajn::InterfaceDescription::Member *me
     (void) msg;
     LOG(LOG_INFO, "[%p] member=%p", this, member);
 
+    TraceScope scope(Trace::Create("aj.Restart", GetPath()));
     std::lock_guard<std::mutex> lock(m_mutex);
     auto resource = FindResourceFromType(m_resources, "oic.wk.mnt");
     if (resource == m_resources.end())
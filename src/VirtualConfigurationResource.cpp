@@ -71,13 +71,14 @@ VirtualConfigurationResource::~VirtualConfigurationResource()
 {
     LOG(LOG_INFO, "[%p] name=%s,path=%s", this, GetUniqueName().c_str(), GetPath().c_str());
 
-    OCDeleteResource(m_deviceConfigurationHandle);
-    OCDeleteResource(m_platformConfigurationHandle);
-    OCDeleteResource(m_maintenanceHandle);
+    DeleteResource(m_deviceConfigurationHandle);
+    DeleteResource(m_platformConfigurationHandle);
+    DeleteResource(m_maintenanceHandle);
 }
 
 void VirtualConfigurationResource::SetAboutData(ajn::AboutData *aboutData)
 {
+    std::lock_guard<std::mutex> lock(m_mutex);
     m_aboutData = *aboutData;
 }
 
@@ -107,13 +108,14 @@ void VirtualConfigurationResource::IntrospectCB(QStatus status, ProxyBusObject *
         if (status != ER_OK)
         {
             LOG(LOG_ERR, "IntrospectCB - %s", QCC_StatusText(status));
-            return;
+            result = OC_STACK_ERROR;
+            goto exit;
         }
 
         result = ::CreateResource(&m_deviceConfigurationHandle, "/con",
                 OC_RSRVD_RESOURCE_TYPE_DEVICE_CONFIGURATION, OC_RSRVD_INTERFACE_READ_WRITE,
                 VirtualConfigurationResource::ConfigurationHandlerCB, this,
-                OC_DISCOVERABLE | OC_OBSERVABLE);
+                OC_DISCOVERABLE | OC_OBSERVABLE, GetUniqueName().c_str());
         if (result == OC_STACK_OK)
         {
             LOG(LOG_INFO, "[%p] Created VirtualConfigurationResource uri=%s", this,
@@ -122,7 +124,7 @@ void VirtualConfigurationResource::IntrospectCB(QStatus status, ProxyBusObject *
         result = ::CreateResource(&m_platformConfigurationHandle, "/con/p",
                 OC_RSRVD_RESOURCE_TYPE_PLATFORM_CONFIGURATION, OC_RSRVD_INTERFACE_READ_WRITE,
                 VirtualConfigurationResource::ConfigurationHandlerCB, this,
-                OC_DISCOVERABLE | OC_OBSERVABLE);
+                OC_DISCOVERABLE | OC_OBSERVABLE, GetUniqueName().c_str());
         if (result == OC_STACK_OK)
         {
             LOG(LOG_INFO, "[%p] Created VirtualConfigurationResource uri=%s", this,
@@ -131,7 +133,7 @@ void VirtualConfigurationResource::IntrospectCB(QStatus status, ProxyBusObject *
         result = ::CreateResource(&m_maintenanceHandle, OC_RSRVD_MAINTENANCE_URI,
                 OC_RSRVD_RESOURCE_TYPE_MAINTENANCE, OC_RSRVD_INTERFACE_READ_WRITE,
                 VirtualConfigurationResource::MaintenanceHandlerCB, this,
-                OC_DISCOVERABLE | OC_OBSERVABLE);
+                OC_DISCOVERABLE | OC_OBSERVABLE, GetUniqueName().c_str());
         if (result == OC_STACK_OK)
         {
             LOG(LOG_INFO, "[%p] Created VirtualConfigurationResource uri=%s", this,
@@ -142,10 +144,8 @@ void VirtualConfigurationResource::IntrospectCB(QStatus status, ProxyBusObject *
             LOG(LOG_ERR, "[%p] Create VirtualConfigurationResource - %d", this, result);
         }
     }
-    if (result == OC_STACK_OK)
-    {
-        m_createCb(m_createContext);
-    }
+exit:
+    m_createCb(m_createContext, this, result);
 }
 
 struct VirtualConfigurationResource::MethodCallContext
@@ -323,7 +323,11 @@ void VirtualConfigurationResource::GetConfigurationsCB(ajn::Message &msg, void *
                 char *appName = NULL;
                 if (context->m_configData->GetAppName(&appName, lang) != ER_OK)
                 {
-                    m_aboutData.GetAppName(&appName, lang);
+                    if (m_aboutData.GetAppName(&appName, lang) != ER_OK)
+                    {
+                        /* The other languages may not have been loaded yet */
+                        m_aboutData.GetAppName(&appName);
+                    }
                     context->m_configData->SetAppName(appName, lang);
                 }
                 if (context->m_lang != context->m_langs.end() &&
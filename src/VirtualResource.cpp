@@ -24,10 +24,15 @@
 #include "Interfaces.h"
 #include "Introspection.h"
 #include "Log.h"
+#include "Metrics.h"
 #include "Name.h"
 #include "Payload.h"
 #include "Plugin.h"
+#include "Probes.h"
 #include "Resource.h"
+#include "ResponseQueue.h"
+#include "Strand.h"
+#include "Trace.h"
 #include <alljoyn/AllJoynStd.h>
 #include <alljoyn/BusAttachment.h>
 #include "Signature.h"
@@ -38,12 +43,28 @@
 #include <algorithm>
 #include <assert.h>
 
+static Counter sGetRequests("oc_to_aj.requests.get");
+static Counter sPostRequests("oc_to_aj.requests.post");
+static Counter sOtherRequests("oc_to_aj.requests.other");
+static Counter sObserveRequests("oc_to_aj.requests.observe");
+static Counter sFailedRequests("oc_to_aj.requests.failed");
+/* From the entity handler to the response to the AllJoyn calls made for it */
+static Histogram sLatency("oc_to_aj.latency_ns");
+static Counter sNotificationsSent("oc.notifications.sent");
+static Counter sNotificationsDropped("oc.notifications.dropped");
+
+/*
+ * The most requests queued to one resource.  Past this the request is handled in place so a
+ * single busy resource cannot hold all the pool's queue.
+ */
+static const size_t MAX_QUEUED_REQUESTS = 32;
+
 VirtualResource *VirtualResource::Create(ajn::BusAttachment *bus, const char *name,
         ajn::SessionId sessionId, const char *path, const char *ajSoftwareVersion,
-        CreateCB createCb, void *createContext)
+        CreateCB createCb, void *createContext, WorkerPool *pool)
 {
     VirtualResource *resource = new VirtualResource(bus, name, sessionId, path, ajSoftwareVersion,
-            createCb, createContext);
+            createCb, createContext, pool);
     OCStackResult result = resource->Create();
     if (result != OC_STACK_OK)
     {
@@ -55,26 +76,33 @@ VirtualResource *VirtualResource::Create(ajn::BusAttachment *bus, const char *na
 
 VirtualResource::VirtualResource(ajn::BusAttachment *bus, const char *name,
         ajn::SessionId sessionId, const char *path, const char *ajSoftwareVersion,
-        CreateCB createCb, void *createContext)
+        CreateCB createCb, void *createContext, WorkerPool *pool)
     : ajn::ProxyBusObject(*bus, name, path, sessionId), m_bus(bus), m_createCb(createCb),
     m_createContext(createContext), m_ajSoftwareVersion(ajSoftwareVersion),
-    m_hasSessionlessSignals(false)
+    m_hasSessionlessSignals(false), m_strand(NULL)
 {
-    LOG(LOG_INFO, "[%p] bus=%p,name=%s,sessionId=%d,path=%s,ajSoftwareVersion=%s", this, bus, name,
-            sessionId, path, ajSoftwareVersion);
+    LOG(LOG_INFO, "[%p] bus=%p,name=%s,sessionId=%d,path=%s,ajSoftwareVersion=%s,pool=%p", this,
+            bus, name, sessionId, path, ajSoftwareVersion, pool);
+    if (pool)
+    {
+        m_strand = new Strand(pool, MAX_QUEUED_REQUESTS);
+    }
 }
 
 VirtualResource::~VirtualResource()
 {
     LOG(LOG_INFO, "[%p] name=%s,path=%s", this, GetUniqueName().c_str(), GetPath().c_str());
 
+    /* Fail any queued requests and wait for the one being handled, if any */
+    delete m_strand;
+
     OCResourceHandle handle;
     while ((handle = OCGetResourceHandleFromCollection(m_handle, 0)))
     {
         OCUnBindResource(m_handle, handle);
-        OCDeleteResource(handle);
+        DeleteResource(handle);
     }
-    OCDeleteResource(m_handle);
+    DeleteResource(m_handle);
 }
 
 OCStackResult VirtualResource::Create()
@@ -103,7 +131,7 @@ void VirtualResource::IntrospectCB(ajn::Message &msg, void *ctx)
     (void) ctx;
     LOG(LOG_INFO, "[%p]", this);
 
-    OCStackResult result;
+    OCStackResult result = OC_STACK_ERROR;
     {
         std::lock_guard<std::mutex> lock(m_mutex);
         switch (msg->GetType())
@@ -115,8 +143,9 @@ void VirtualResource::IntrospectCB(ajn::Message &msg, void *ctx)
                     if (status != ER_OK)
                     {
                         LOG(LOG_ERR, "ParseXml - %s", QCC_StatusText(status));
-                        return;
+                        break;
                     }
+                    result = CreateResources();
                     break;
                 }
             case ajn::MESSAGE_ERROR:
@@ -124,18 +153,14 @@ void VirtualResource::IntrospectCB(ajn::Message &msg, void *ctx)
                     qcc::String errorMsg;
                     const char *errorName = msg->GetErrorName(&errorMsg);
                     LOG(LOG_ERR, "[%p] IntrospectCB %s %s", this, errorName, errorMsg.c_str());
-                    return;
+                    break;
                 }
             default:
                 assert(0);
                 break;
         }
-        result = CreateResources();
-    }
-    if (result == OC_STACK_OK)
-    {
-        m_createCb(m_createContext);
     }
+    m_createCb(m_createContext, this, result);
 }
 
 OCStackResult VirtualResource::CreateResource(OCResourceHandle *handle, std::string path,
@@ -167,7 +192,7 @@ OCStackResult VirtualResource::CreateResource(OCResourceHandle *handle, std::str
     }
     OCStackResult result = ::CreateResource(handle, ToUri(path).c_str(), rt->first.c_str(),
             (access & READ) ? OC_RSRVD_INTERFACE_READ : OC_RSRVD_INTERFACE_READ_WRITE,
-            VirtualResource::EntityHandlerCB, this, props);
+            VirtualResource::EntityHandlerCB, this, props, GetUniqueName().c_str());
     /*
      * Note that rt is not incremented before calling OCBindResourceTypeToResource.  This is to
      * enable binding new resource types to existing resources (such as binding "oic.d.foo" to
@@ -351,7 +376,7 @@ OCStackResult VirtualResource::CreateResources()
     else
     {
         result = ::CreateResource(&m_handle, ToUri(GetPath()).c_str(), "oic.r.alljoynobject", OC_RSRVD_INTERFACE_LL,
-                NULL, this, OC_DISCOVERABLE | OC_OBSERVABLE);
+                NULL, this, OC_DISCOVERABLE | OC_OBSERVABLE, GetUniqueName().c_str());
         if (result == OC_STACK_OK)
         {
             result = OCBindResourceTypeToResource(m_handle, OC_RSRVD_RESOURCE_TYPE_COLLECTION);
@@ -480,11 +505,13 @@ struct MethodCallContext
     uint8_t m_access;
     const ajn::InterfaceDescription::Member *m_member;
     OCEntityHandlerResponse *m_response;
+    uint64_t m_started;
+    TraceCall m_call;
     MethodCallContext(std::string ajSoftwareVersion, std::string &rt, uint8_t access,
                       const ajn::InterfaceDescription::Member *member,
                       OCEntityHandlerRequest *request)
         : m_ajSoftwareVersion(ajSoftwareVersion), m_rt(rt), m_access(access), m_member(member),
-          m_response(NULL)
+          m_response(NULL), m_started(MetricsNow())
     {
         m_response = (OCEntityHandlerResponse *) calloc(1, sizeof(OCEntityHandlerResponse));
         m_response->requestHandle = request->requestHandle;
@@ -492,6 +519,7 @@ struct MethodCallContext
     }
     ~MethodCallContext()
     {
+        sLatency.Record(MetricsNow() - m_started);
         free(m_response);
     }
 };
@@ -502,10 +530,12 @@ struct VirtualResource::SetContext
     OCRepPayload *m_payload;
     OCRepPayloadValue *m_value;
     OCEntityHandlerResponse *m_response;
+    uint64_t m_started;
+    TraceCall m_call;
     SetContext(std::string ajSoftwareVersion, OCEntityHandlerRequest *request)
         : m_ajSoftwareVersion(ajSoftwareVersion),
           m_payload(OCRepPayloadClone((OCRepPayload *) request->payload)), m_value(m_payload->values),
-          m_response(NULL)
+          m_response(NULL), m_started(MetricsNow())
     {
         m_response = (OCEntityHandlerResponse *) calloc(1, sizeof(OCEntityHandlerResponse));
         m_response->requestHandle = request->requestHandle;
@@ -513,6 +543,7 @@ struct VirtualResource::SetContext
     }
     ~SetContext()
     {
+        sLatency.Record(MetricsNow() - m_started);
         free(m_response);
         OCPayloadDestroy((OCPayload *) m_payload);
     }
@@ -527,11 +558,14 @@ struct VirtualResource::GetAllContext
     size_t m_iface;
     OCRepPayload *m_payload;
     OCEntityHandlerResponse *m_response;
+    uint64_t m_started;
+    TraceCall m_call;
     GetAllContext(std::string ajSoftwareVersion, uint8_t access,
             const ajn::InterfaceDescription **ifaces, size_t numIfaces, OCRepPayload *payload,
             OCEntityHandlerRequest *request)
         : m_ajSoftwareVersion(ajSoftwareVersion), m_access(access), m_ifaces(ifaces),
-          m_numIfaces(numIfaces), m_iface(0), m_payload(payload), m_response(NULL)
+          m_numIfaces(numIfaces), m_iface(0), m_payload(payload), m_response(NULL),
+          m_started(MetricsNow())
     {
         m_response = (OCEntityHandlerResponse *) calloc(1, sizeof(OCEntityHandlerResponse));
         m_response->requestHandle = request->requestHandle;
@@ -539,12 +573,50 @@ struct VirtualResource::GetAllContext
     }
     ~GetAllContext()
     {
+        sLatency.Record(MetricsNow() - m_started);
         delete[] m_ifaces;
         OCRepPayloadDestroy(m_payload);
         free(m_response);
     }
 };
 
+/* A copy of an OCEntityHandlerRequest that outlives the call to the entity handler. */
+struct VirtualResource::Request
+{
+    OCEntityHandlerFlag m_flag;
+    OCEntityHandlerRequest m_request;
+    std::string m_query;
+    /* The time spent waiting for a worker */
+    TraceCall m_queued;
+    Request(OCEntityHandlerFlag flag, OCEntityHandlerRequest *request)
+        : m_flag(flag), m_request(*request), m_query(request->query ? request->query : "")
+    {
+        m_queued.Begin("oc.queued");
+        m_request.query = request->query ? &m_query[0] : NULL;
+        m_request.numRcvdVendorSpecificHeaderOptions = 0;
+        m_request.rcvdVendorSpecificHeaderOptions = NULL;
+        m_request.payload = NULL;
+        if (request->payload && (request->payload->type == PAYLOAD_TYPE_REPRESENTATION))
+        {
+            m_request.payload = (OCPayload *) OCRepPayloadClone((OCRepPayload *) request->payload);
+        }
+    }
+    ~Request()
+    {
+        OCPayloadDestroy(m_request.payload);
+    }
+};
+
+/*
+ * When requests are handled by a worker pool, responses are sent from the thread calling
+ * OCProcess() instead of the calling thread.
+ */
+OCStackResult VirtualResource::DoResponse(OCEntityHandlerResponse *response)
+{
+    TraceSpan span("oc.response");
+    return m_strand ? QueueResponse(response) : OCDoResponse(response);
+}
+
 OCDiagnosticPayload *VirtualResource::CreatePayload(ajn::Message &msg,
         OCEntityHandlerResult *ehResult)
 {
@@ -619,19 +691,102 @@ OCStackResult VirtualResource::SetMemberPayload(OCRepPayload *payload,
     return OC_STACK_OK;
 }
 
+static const char *GetTraceName(OCMethod method)
+{
+    switch (method)
+    {
+        case OC_REST_GET:
+            return "oc.get";
+        case OC_REST_POST:
+            return "oc.post";
+        default:
+            return "oc.request";
+    }
+}
+
 OCEntityHandlerResult VirtualResource::EntityHandlerCB(OCEntityHandlerFlag flag,
         OCEntityHandlerRequest *request,
         void *ctx)
 {
     LOG(LOG_INFO, "[%p] flag=%x,request=%p,ctx=%p", ctx, flag, request, ctx);
+    PROBE2(oc_entity_handler_entry, request, (int) request->method);
     if (!IsValidRequest(request))
     {
         LOG(LOG_INFO, "Invalid request received");
+        PROBE2(oc_entity_handler_exit, request, (int) OC_EH_BAD_REQ);
         return OC_EH_BAD_REQ;
     }
 
     VirtualResource *resource = reinterpret_cast<VirtualResource *>(ctx);
+    TraceScope scope(Trace::Create(GetTraceName(request->method),
+            OCGetResourceUri(request->resource)));
+    if (resource->m_strand)
+    {
+        std::shared_ptr<Request> queued(new Request(flag, request));
+        if (resource->m_strand->Post(std::bind(&VirtualResource::HandleQueuedRequest, resource,
+                queued), std::bind(&VirtualResource::DiscardQueuedRequest, queued)))
+        {
+            PROBE2(oc_entity_handler_exit, request, (int) OC_EH_SLOW);
+            return OC_EH_SLOW;
+        }
+        LOG(LOG_INFO, "[%p] Queue full, handling request in place", resource);
+    }
     std::lock_guard<std::mutex> lock(resource->m_mutex);
+    OCEntityHandlerResult result = HandleRequest(resource, flag, request);
+    PROBE2(oc_entity_handler_exit, request, (int) result);
+    return result;
+}
+
+void VirtualResource::HandleQueuedRequest(std::shared_ptr<Request> request)
+{
+    LOG(LOG_INFO, "[%p] request=%p", this, request.get());
+
+    TraceScope scope(request->m_queued.GetTrace());
+    request->m_queued.End();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    OCEntityHandlerResult result = HandleRequest(this, request->m_flag, &request->m_request);
+    if (result != OC_EH_OK)
+    {
+        /* The stack was told OC_EH_SLOW so it will not send the error response itself */
+        OCEntityHandlerResponse response;
+        memset(&response, 0, sizeof(response));
+        response.requestHandle = request->m_request.requestHandle;
+        response.resourceHandle = request->m_request.resource;
+        response.ehResult = result;
+        OCStackResult doResult = DoResponse(&response);
+        if (doResult != OC_STACK_OK)
+        {
+            LOG(LOG_ERR, "DoResponse - %d", doResult);
+        }
+    }
+}
+
+/*
+ * Called when the resource is destroyed before a queued request is handled.  The stack was told
+ * OC_EH_SLOW so the request is answered here rather than left to time out.
+ */
+void VirtualResource::DiscardQueuedRequest(std::shared_ptr<Request> request)
+{
+    LOG(LOG_INFO, "request=%p", request.get());
+
+    OCEntityHandlerResponse response;
+    memset(&response, 0, sizeof(response));
+    response.requestHandle = request->m_request.requestHandle;
+    /* The resource handle is deleted before the response is sent */
+    response.resourceHandle = NULL;
+    response.ehResult = OC_EH_SERVICE_UNAVAILABLE;
+    OCStackResult doResult = QueueResponse(&response);
+    if (doResult != OC_STACK_OK)
+    {
+        LOG(LOG_ERR, "QueueResponse - %d", doResult);
+    }
+}
+
+/* Called with resource->m_mutex held. */
+OCEntityHandlerResult VirtualResource::HandleRequest(VirtualResource *resource,
+        OCEntityHandlerFlag flag, OCEntityHandlerRequest *request)
+{
+    TraceSpan span("oc.handle");
     const char *uri = OCGetResourceUri(request->resource);
     std::map<std::string, std::string> queryMap = ParseQuery(request->resource, request->query);
     std::string rt = GetResourceType(request->resource, queryMap);
@@ -642,6 +797,7 @@ OCEntityHandlerResult VirtualResource::EntityHandlerCB(OCEntityHandlerFlag flag,
     {
         if (request->obsInfo.action == OC_OBSERVE_REGISTER)
         {
+            sObserveRequests.Increment();
             Observation key(request->resource, request->query);
             std::vector<OCObservationId>::iterator it = std::find(resource->m_observers[key].begin(),
                     resource->m_observers[key].end(), request->obsInfo.obsId);
@@ -727,6 +883,7 @@ handleRequest:
     {
         case OC_REST_GET:
             {
+                sGetRequests.Increment();
                 std::string ifaceName = ::GetInterface(rt);
                 std::string memberName = GetMember(rt);
                 if (queryMap[OC_RSRVD_INTERFACE] == OC_RSRVD_INTERFACE_DEFAULT)
@@ -769,6 +926,7 @@ handleRequest:
                     assert(member);
                     MethodCallContext *context = new MethodCallContext(resource->m_ajSoftwareVersion,
                             rt, access, member, request);
+                    context->m_call.Begin("aj.GetAll", ifaceName.c_str());
                     QStatus status = resource->MethodCallAsync(*member, resource,
                             static_cast<ajn::MessageReceiver::ReplyHandler>(&VirtualResource::MethodReturnCB),
                             &arg, 1, context, DefaultCallTimeout,
@@ -799,10 +957,10 @@ handleRequest:
                     result = OC_EH_OK;
                     response.ehResult = result;
                     response.payload = reinterpret_cast<OCPayload *>(payload);
-                    OCStackResult doResult = OCDoResponse(&response);
+                    OCStackResult doResult = resource->DoResponse(&response);
                     if (doResult != OC_STACK_OK)
                     {
-                        LOG(LOG_ERR, "OCDoResponse - %d", doResult);
+                        LOG(LOG_ERR, "DoResponse - %d", doResult);
                         OCRepPayloadDestroy(payload);
                     }
                 }
@@ -810,6 +968,7 @@ handleRequest:
             }
         case OC_REST_POST:
             {
+                sPostRequests.Increment();
                 if ((access & READWRITE) == 0)
                 {
                     LOG(LOG_INFO, "Read only access");
@@ -924,6 +1083,7 @@ handleRequest:
                     {
                         MethodCallContext *context = new MethodCallContext(resource->m_ajSoftwareVersion, rt, access,
                                 member, request);
+                        context->m_call.Begin("aj.call", member->name.c_str());
                         QStatus status = resource->MethodCallAsync(*member, resource,
                                 static_cast<ajn::MessageReceiver::ReplyHandler>(&VirtualResource::MethodReturnCB),
                                 args, numArgs, context);
@@ -947,9 +1107,14 @@ handleRequest:
                 break;
             }
         default:
+            sOtherRequests.Increment();
             result = OC_EH_METHOD_NOT_ALLOWED;
             break;
     }
+    if (result != OC_EH_OK)
+    {
+        sFailedRequests.Increment();
+    }
     return result;
 }
 
@@ -959,6 +1124,8 @@ void VirtualResource::MethodReturnCB(ajn::Message &msg, void *ctx)
 
     std::lock_guard<std::mutex> lock(m_mutex);
     MethodCallContext *context = reinterpret_cast<MethodCallContext *>(ctx);
+    TraceScope scope(context->m_call.GetTrace());
+    context->m_call.End();
     const char *uri = OCGetResourceUri(context->m_response->resourceHandle);
     OCStackResult result = OC_STACK_ERROR;
     OCPayload *payload = NULL;
@@ -1029,10 +1196,10 @@ void VirtualResource::MethodReturnCB(ajn::Message &msg, void *ctx)
             break;
     }
     context->m_response->payload = payload;
-    result = OCDoResponse(context->m_response);
+    result = DoResponse(context->m_response);
     if (result != OC_STACK_OK)
     {
-        LOG(LOG_ERR, "OCDoResponse - %d", result);
+        LOG(LOG_ERR, "DoResponse - %d", result);
         OCPayloadDestroy(payload);
     }
     delete context;
@@ -1109,6 +1276,7 @@ QStatus VirtualResource::Set(SetContext *context)
         return ER_FAIL;
     }
     args[2].Set("v", &value);
+    context->m_call.Begin("aj.Set", context->m_value->name);
     return MethodCallAsync(::ajn::org::freedesktop::DBus::Properties::InterfaceName, "Set", this,
             static_cast<ajn::MessageReceiver::ReplyHandler>(&VirtualResource::SetCB), args, numArgs,
             context, DefaultCallTimeout, GetMethodCallFlags(iface->GetName()));
@@ -1120,6 +1288,8 @@ void VirtualResource::SetCB(ajn::Message &msg, void *ctx)
 
     std::lock_guard<std::mutex> lock(m_mutex);
     SetContext *context = reinterpret_cast<SetContext *>(ctx);
+    TraceScope scope(context->m_call.GetTrace());
+    context->m_call.End();
     const char *uri = OCGetResourceUri(context->m_response->resourceHandle);
     OCStackResult result = OC_STACK_ERROR;
     OCRepPayload *payload = NULL;
@@ -1132,7 +1302,7 @@ void VirtualResource::SetCB(ajn::Message &msg, void *ctx)
                 payload = CreatePayload(uri);
                 context->m_response->ehResult = OC_EH_OK;
                 context->m_response->payload = reinterpret_cast<OCPayload *>(payload);
-                result = OCDoResponse(context->m_response);
+                result = DoResponse(context->m_response);
                 delete context;
                 break;
             }
@@ -1149,7 +1319,7 @@ void VirtualResource::SetCB(ajn::Message &msg, void *ctx)
         case ajn::MESSAGE_ERROR:
             context->m_response->payload = (OCPayload *) CreatePayload(msg,
                     &context->m_response->ehResult);
-            result = OCDoResponse(context->m_response);
+            result = DoResponse(context->m_response);
             delete context;
             break;
         default:
@@ -1158,7 +1328,7 @@ void VirtualResource::SetCB(ajn::Message &msg, void *ctx)
     }
     if (result != OC_STACK_OK)
     {
-        LOG(LOG_ERR, "OCDoResponse - %d", result);
+        LOG(LOG_ERR, "DoResponse - %d", result);
         OCRepPayloadDestroy(payload);
     }
 }
@@ -1174,6 +1344,7 @@ void VirtualResource::SignalCB(const ajn::InterfaceDescription::Member *member,
                                ajn::Message &msg)
 {
     LOG(LOG_INFO, "[%p] member=%p,path=%s", this, member, path);
+    PROBE3(aj_signal, this, path, member->name.c_str());
 
     std::lock_guard<std::mutex> lock(m_mutex);
     if (m_observers.empty())
@@ -1255,10 +1426,12 @@ void VirtualResource::SignalCB(const ajn::InterfaceDescription::Member *member,
                 if (result == OC_STACK_OK)
                 {
                     LOG(LOG_INFO, "[%p] Notify observers rt=%s", this, it->first.m_query.c_str());
+                    sNotificationsSent.Increment();
                 }
                 else
                 {
                     LOG(LOG_ERR, "[%p] Notify observers - %d", this, result);
+                    sNotificationsDropped.Increment();
                     OCRepPayloadDestroy(payload);
                 }
             }
@@ -1314,10 +1487,12 @@ void VirtualResource::NotifyPropertiesChangedObservers(const ajn::InterfaceDescr
             if (result == OC_STACK_OK)
             {
                 LOG(LOG_INFO, "[%p] Notify observers rt=%s", this, it->first.m_query.c_str());
+                sNotificationsSent.Increment();
             }
             else
             {
                 LOG(LOG_ERR, "[%p] Notify observers - %d", this, result);
+                sNotificationsDropped.Increment();
                 OCRepPayloadDestroy(payload);
             }
         }
@@ -1345,6 +1520,7 @@ QStatus VirtualResource::GetAll(GetAllContext *context)
         if (numProps)
         {
             ajn::MsgArg arg("s", ifaceName);
+            context->m_call.Begin("aj.GetAll", ifaceName);
             QStatus status = MethodCallAsync(::ajn::org::freedesktop::DBus::Properties::InterfaceName,
                     "GetAll", this, static_cast<ajn::MessageReceiver::ReplyHandler>(&VirtualResource::GetAllCB),
                     &arg, 1, context, DefaultCallTimeout, GetMethodCallFlags(ifaceName));
@@ -1402,10 +1578,10 @@ exit:
         {
             context->m_response->payload = reinterpret_cast<OCPayload *>(context->m_payload);
         }
-        OCStackResult doResult = OCDoResponse(context->m_response);
+        OCStackResult doResult = DoResponse(context->m_response);
         if (doResult != OC_STACK_OK)
         {
-            LOG(LOG_ERR, "OCDoResponse - %d", doResult);
+            LOG(LOG_ERR, "DoResponse - %d", doResult);
         }
         delete context;
     }
@@ -1418,6 +1594,8 @@ void VirtualResource::GetAllCB(ajn::Message &msg, void *ctx)
 
     std::lock_guard<std::mutex> lock(m_mutex);
     GetAllContext *context = reinterpret_cast<GetAllContext *>(ctx);
+    TraceScope scope(context->m_call.GetTrace());
+    context->m_call.End();
     switch (msg->GetType())
     {
         case ajn::MESSAGE_METHOD_RET:
@@ -26,10 +26,13 @@
 #include <inttypes.h>
 #include <alljoyn/BusAttachment.h>
 #include <alljoyn/ProxyBusObject.h>
+#include <memory>
 #include <mutex>
 #include <vector>
 
 class Bridge;
+class Strand;
+class WorkerPool;
 
 class VirtualResource : public ajn::ProxyBusObject
     , protected ajn::ProxyBusObject::Listener
@@ -37,10 +40,11 @@ class VirtualResource : public ajn::ProxyBusObject
     , private ajn::BusAttachment::RemoveMatchAsyncCB
 {
     public:
-        typedef void (*CreateCB)(void *context);
+        /* Called once the resources have been created, or creation has failed. */
+        typedef void (*CreateCB)(void *context, VirtualResource *resource, OCStackResult result);
         static VirtualResource *Create(ajn::BusAttachment *bus, const char *name,
                 ajn::SessionId sessionId, const char *path, const char *ajSoftwareVersion,
-                CreateCB createCb, void *createContext);
+                CreateCB createCb, void *createContext, WorkerPool *pool = NULL);
         virtual ~VirtualResource();
 
     protected:
@@ -51,7 +55,7 @@ class VirtualResource : public ajn::ProxyBusObject
 
         VirtualResource(ajn::BusAttachment *bus, const char *name, ajn::SessionId sessionId,
                 const char *path, const char *ajSoftwareVersion, CreateCB createCb,
-                void *createContext);
+                void *createContext, WorkerPool *pool = NULL);
 
     private:
         std::string m_ajSoftwareVersion;
@@ -77,6 +81,7 @@ class VirtualResource : public ajn::ProxyBusObject
         std::map<OCObservationId, std::string> m_matchRules;
         OCResourceHandle m_handle;
         bool m_hasSessionlessSignals;
+        Strand *m_strand;
 
         OCStackResult Create();
         uint8_t GetMethodCallFlags(const char *ifaceName);
@@ -102,6 +107,12 @@ class VirtualResource : public ajn::ProxyBusObject
         OCRepPayload *CreatePayload(const char *uri);
         OCStackResult SetMemberPayload(OCRepPayload *payload, const char *ifaceName,
                 const char *memberName);
+        OCStackResult DoResponse(OCEntityHandlerResponse *response);
+        struct Request;
+        void HandleQueuedRequest(std::shared_ptr<Request> request);
+        static void DiscardQueuedRequest(std::shared_ptr<Request> request);
+        static OCEntityHandlerResult HandleRequest(VirtualResource *resource,
+                OCEntityHandlerFlag flag, OCEntityHandlerRequest *request);
         static OCEntityHandlerResult EntityHandlerCB(OCEntityHandlerFlag flag,
                 OCEntityHandlerRequest *request, void *context);
 };
@@ -0,0 +1,111 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "WorkerPool.h"
+
+WorkerPool::WorkerPool(size_t numThreads, size_t maxQueued)
+    : m_maxQueued(maxQueued), m_numQueued(0), m_maxQueueDepth(0), m_numRejected(0),
+      m_isStopped(false)
+{
+    for (size_t i = 0; i < numThreads; ++i)
+    {
+        m_threads.push_back(std::thread(&WorkerPool::Run, this));
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    Stop();
+}
+
+bool WorkerPool::Post(Work work, Priority priority)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_isStopped || (m_numQueued >= m_maxQueued))
+    {
+        ++m_numRejected;
+        return false;
+    }
+    m_queues[priority].push_back(work);
+    if (++m_numQueued > m_maxQueueDepth)
+    {
+        m_maxQueueDepth = m_numQueued;
+    }
+    m_cond.notify_one();
+    return true;
+}
+
+void WorkerPool::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_isStopped = true;
+        m_cond.notify_all();
+    }
+    for (std::thread &thread : m_threads)
+    {
+        if (thread.joinable())
+        {
+            thread.join();
+        }
+    }
+}
+
+size_t WorkerPool::GetQueueDepth()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_numQueued;
+}
+
+size_t WorkerPool::GetMaxQueueDepth()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_maxQueueDepth;
+}
+
+size_t WorkerPool::GetNumRejected()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_numRejected;
+}
+
+void WorkerPool::Run()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;)
+    {
+        while (!m_isStopped && !m_numQueued)
+        {
+            m_cond.wait(lock);
+        }
+        if (!m_numQueued)
+        {
+            /* Stopped and drained */
+            break;
+        }
+        std::deque<Work> *queue = !m_queues[HIGH].empty() ? &m_queues[HIGH] : &m_queues[LOW];
+        Work work = queue->front();
+        queue->pop_front();
+        --m_numQueued;
+        lock.unlock();
+        work();
+        lock.lock();
+    }
+}
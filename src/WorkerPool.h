@@ -0,0 +1,84 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#ifndef _WORKERPOOL_H
+#define _WORKERPOOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ * A fixed number of threads servicing a bounded, two-level priority queue of work.
+ */
+class WorkerPool
+{
+    public:
+        typedef std::function<void()> Work;
+        enum Priority
+        {
+            HIGH = 0,
+            LOW,
+        };
+
+        /*
+         * @param[in] numThreads the number of worker threads.
+         * @param[in] maxQueued the maximum number of queued, not yet running, work items.
+         */
+        WorkerPool(size_t numThreads, size_t maxQueued);
+        ~WorkerPool();
+
+        /*
+         * Queues work to be run by one of the worker threads.
+         *
+         * @return false if the queue is full or the pool is stopped, in which case work is not
+         *         queued.
+         */
+        bool Post(Work work, Priority priority = LOW);
+
+        /*
+         * Runs any queued work and joins the worker threads.  Further calls to Post() fail.
+         */
+        void Stop();
+
+        size_t GetNumThreads() const { return m_threads.size(); }
+        size_t GetMaxQueued() const { return m_maxQueued; }
+        size_t GetQueueDepth();
+        size_t GetMaxQueueDepth();
+        size_t GetNumRejected();
+
+    private:
+        std::mutex m_mutex;
+        std::condition_variable m_cond;
+        std::vector<std::thread> m_threads;
+        std::deque<Work> m_queues[LOW + 1];
+        size_t m_maxQueued;
+        size_t m_numQueued;
+        size_t m_maxQueueDepth;
+        size_t m_numRejected;
+        bool m_isStopped;
+
+        void Run();
+};
+
+#endif
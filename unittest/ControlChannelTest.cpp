@@ -0,0 +1,127 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "UnitTest.h"
+
+#include "ControlChannel.h"
+#include <sys/socket.h>
+
+TEST(ControlChannelTest, EncodeDecode)
+{
+    ControlMessage msg(ControlMessage::EXEC, 7, { "--uuid", "", std::string(300, 'x') });
+    std::vector<uint8_t> frame;
+    EXPECT_TRUE(ControlChannel::Encode(frame, msg));
+
+    ControlMessage decoded;
+    size_t consumed;
+    for (size_t len = 0; len < frame.size(); ++len)
+    {
+        EXPECT_TRUE(ControlChannel::Decode(&frame[0], len, decoded, &consumed));
+        EXPECT_EQ(0u, consumed);
+    }
+    EXPECT_TRUE(ControlChannel::Decode(&frame[0], frame.size(), decoded, &consumed));
+    EXPECT_EQ(frame.size(), consumed);
+    EXPECT_EQ(ControlMessage::EXEC, decoded.m_type);
+    EXPECT_EQ(7u, decoded.m_seq);
+    EXPECT_EQ(msg.m_args, decoded.m_args);
+}
+
+TEST(ControlChannelTest, RejectsMalformedFrames)
+{
+    ControlMessage msg(ControlMessage::KILL, 1, { "uuid" });
+    std::vector<uint8_t> frame;
+    EXPECT_TRUE(ControlChannel::Encode(frame, msg));
+    ControlMessage decoded;
+    size_t consumed;
+
+    std::vector<uint8_t> overrun = frame;
+    overrun[12] = 0xff;
+    EXPECT_FALSE(ControlChannel::Decode(&overrun[0], overrun.size(), decoded, &consumed));
+
+    std::vector<uint8_t> tooLarge = frame;
+    tooLarge[0] = 0xff;
+    EXPECT_FALSE(ControlChannel::Decode(&tooLarge[0], tooLarge.size(), decoded, &consumed));
+}
+
+TEST(ControlChannelTest, RejectsOversizedMessages)
+{
+    std::vector<uint8_t> frame;
+    ControlMessage longArg(ControlMessage::EXEC, 1, { std::string(0x10000, 'x') });
+    EXPECT_FALSE(ControlChannel::Encode(frame, longArg));
+    ControlMessage manyArgs(ControlMessage::EXEC, 1, std::vector<std::string>(0x10000));
+    EXPECT_FALSE(ControlChannel::Encode(frame, manyArgs));
+    ControlMessage tooLarge(ControlMessage::EXEC, 1,
+            std::vector<std::string>(2, std::string(ControlChannel::MAX_FRAME_SIZE / 2, 'x')));
+    EXPECT_FALSE(ControlChannel::Encode(frame, tooLarge));
+    EXPECT_TRUE(frame.empty());
+
+    int fds[2];
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+    ControlChannel bridge(fds[0]);
+    ControlChannel manager(fds[1]);
+    EXPECT_EQ(0u, bridge.Send(ControlMessage::EXEC, longArg.m_args));
+    EXPECT_FALSE(manager.Ack(1, true, longArg.m_args));
+}
+
+TEST(ControlChannelTest, SendReceiveAndAck)
+{
+    int fds[2];
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+    ControlChannel bridge(fds[0]);
+    ControlChannel manager(fds[1]);
+
+    uint32_t exec = bridge.Send(ControlMessage::EXEC, { "--uuid", "a" });
+    uint32_t kill = bridge.Send(ControlMessage::KILL, { "a" });
+    EXPECT_NE(0u, exec);
+    EXPECT_NE(exec, kill);
+
+    std::vector<ControlMessage> messages;
+    while (messages.size() < 2)
+    {
+        ASSERT_TRUE(manager.Receive(messages));
+    }
+    ASSERT_EQ(2u, messages.size());
+    EXPECT_EQ(ControlMessage::EXEC, messages[0].m_type);
+    EXPECT_EQ(exec, messages[0].m_seq);
+    EXPECT_EQ(std::vector<std::string>({ "--uuid", "a" }), messages[0].m_args);
+    EXPECT_EQ(ControlMessage::KILL, messages[1].m_type);
+    EXPECT_EQ(kill, messages[1].m_seq);
+
+    EXPECT_TRUE(manager.Ack(exec, true, { "1234" }));
+    messages.clear();
+    while (messages.empty())
+    {
+        ASSERT_TRUE(bridge.Receive(messages));
+    }
+    EXPECT_EQ(ControlMessage::ACK, messages[0].m_type);
+    EXPECT_EQ(exec, messages[0].m_seq);
+    EXPECT_EQ(std::vector<std::string>({ ControlChannel::ACK_OK, "1234" }), messages[0].m_args);
+}
+
+TEST(ControlChannelTest, ReceiveFailsOnceClosed)
+{
+    int fds[2];
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+    ControlChannel *bridge = new ControlChannel(fds[0]);
+    ControlChannel manager(fds[1]);
+    delete bridge;
+    std::vector<ControlMessage> messages;
+    EXPECT_FALSE(manager.Receive(messages));
+}
@@ -0,0 +1,94 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "UnitTest.h"
+
+#include "DiscoveryScheduler.h"
+
+TEST(DiscoverySchedulerTest, BacksOffWhileStable)
+{
+    DiscoveryScheduler scheduler(5, 60);
+    time_t now = 1000;
+    EXPECT_TRUE(scheduler.IsDue(now));
+    scheduler.Sent(now);
+    EXPECT_FALSE(scheduler.IsDue(now + 4));
+    EXPECT_TRUE(scheduler.IsDue(now + 5));
+    now += 5;
+    scheduler.Sent(now);
+    EXPECT_FALSE(scheduler.IsDue(now + 9));
+    EXPECT_TRUE(scheduler.IsDue(now + 10));
+    for (int i = 0; i < 8; ++i)
+    {
+        scheduler.Sent(now);
+    }
+    EXPECT_EQ(60, scheduler.GetPeriod());
+    EXPECT_EQ(10u, scheduler.GetNumRequests());
+}
+
+TEST(DiscoverySchedulerTest, SpeedsUpAfterChange)
+{
+    DiscoveryScheduler scheduler(5, 60);
+    time_t now = 1000;
+    for (int i = 0; i < 8; ++i)
+    {
+        scheduler.Sent(now);
+    }
+    EXPECT_FALSE(scheduler.IsDue(now + 5));
+    scheduler.Changed(now);
+    EXPECT_EQ(5, scheduler.GetPeriod());
+    EXPECT_TRUE(scheduler.IsDue(now + 5));
+    EXPECT_EQ(1u, scheduler.GetNumChanges());
+}
+
+/*
+ * Simulates an hour of a network of stable responders with one arrival every ten minutes and
+ * compares the number of responses to those of a fixed five second period.
+ */
+TEST(DiscoverySchedulerTest, SimulatedResponders)
+{
+    const size_t numResponders[] = { 10, 100, 1000 };
+    for (size_t n : numResponders)
+    {
+        DiscoveryScheduler scheduler(5, 300);
+        size_t responders = n;
+        size_t fixedResponses = 0;
+        for (time_t now = 0; now < 3600; ++now)
+        {
+            if ((now % 600) == 599)
+            {
+                ++responders;
+                scheduler.Changed(now);
+            }
+            if ((now % 5) == 0)
+            {
+                fixedResponses += responders;
+            }
+            if (scheduler.IsDue(now))
+            {
+                scheduler.Sent(now);
+                for (size_t i = 0; i < responders; ++i)
+                {
+                    scheduler.Responded();
+                }
+            }
+        }
+        EXPECT_LT(scheduler.GetNumResponses() * 10, fixedResponses);
+    }
+}
@@ -21,9 +21,13 @@
 #include "UnitTest.h"
 
 #include "Introspection.h"
+#include "DeviceSnapshots.h"
+#include "ModelCache.h"
+#include "Resource.h"
 #include "VirtualBusAttachment.h"
 #include "ocpayloadcbor.h"
 #include "ocstack.h"
+#include <algorithm>
 
 /*
  * 7.2.2.1 Translation of the introspection itself
@@ -39,7 +43,7 @@ public:
     virtual void SetUp()
     {
         AJOCSetUp::SetUp();
-        EXPECT_EQ(OC_STACK_OK, OCCreateResource(&m_handle, "x.org.iotivity.rt", NULL, "/resource",
+        EXPECT_EQ(OC_STACK_OK, CreateResource(&m_handle, "/resource", "x.org.iotivity.rt", NULL,
                 NULL, NULL, OC_DISCOVERABLE));
 
         m_context = new DiscoverContext();
@@ -54,7 +58,7 @@ public:
     {
         delete m_bus;
         delete m_context;
-        OCDeleteResource(m_handle);
+        DeleteResource(m_handle);
         AJOCSetUp::TearDown();
     }
 };
@@ -1225,3 +1229,279 @@ TEST_F(Introspection, WellDefinedResourceTypesIgnored)
     const ajn::InterfaceDescription *iface = m_bus->GetInterface("oic.r.switch.binary");
     EXPECT_TRUE(iface == NULL);
 }
+
+TEST_F(Introspection, CachedIntrospectionMatchesIntrospection)
+{
+    const char *introspectionXml =
+            "<interface name='org.iotivity.-interface'>"
+            "  <property name='byte' type='y' access='read'/>"
+            "  <method name='Method'>"
+            "    <arg name='in' type='s' direction='in'/>"
+            "    <arg name='out' type='s' direction='out'/>"
+            "  </method>"
+            "</interface>";
+    EXPECT_EQ(ER_OK, m_bus->CreateInterfacesFromXml(introspectionXml));
+    uint8_t expected[8192];
+    size_t expectedSize = 8192;
+    EXPECT_EQ(CborNoError, Introspect(m_bus, "v16.10.00", "TITLE", "VERSION", expected,
+            &expectedSize));
+
+    IntrospectionCache cache;
+    size_t outSize = cache.Update(m_bus, "v16.10.00", "TITLE", "VERSION");
+    EXPECT_LE(expectedSize, outSize);
+    EXPECT_LT(0u, cache.GetNumEncoded());
+    std::vector<uint8_t> out(outSize);
+    EXPECT_EQ(CborNoError, cache.Introspect(&out[0], &outSize));
+    EXPECT_EQ(std::vector<uint8_t>(expected, expected + expectedSize),
+            std::vector<uint8_t>(&out[0], &out[0] + outSize));
+
+    cache.Update(m_bus, "v16.10.00", "TITLE", "VERSION");
+    EXPECT_EQ(0u, cache.GetNumEncoded());
+
+    OCResourceHandle handle;
+    EXPECT_EQ(OC_STACK_OK, CreateResource(&handle, "/resource/2", "x.org.iotivity.rt", NULL,
+            NULL, NULL, OC_DISCOVERABLE));
+    expectedSize = 8192;
+    EXPECT_EQ(CborNoError, Introspect(m_bus, "v16.10.00", "TITLE", "VERSION", expected,
+            &expectedSize));
+    outSize = cache.Update(m_bus, "v16.10.00", "TITLE", "VERSION");
+    EXPECT_EQ(1u, cache.GetNumEncoded());
+    out.resize(outSize);
+    EXPECT_EQ(CborNoError, cache.Introspect(&out[0], &outSize));
+    EXPECT_EQ(std::vector<uint8_t>(expected, expected + expectedSize),
+            std::vector<uint8_t>(&out[0], &out[0] + outSize));
+    DeleteResource(handle);
+}
+
+TEST_F(Introspection, IntrospectionIncludesMoreThan255Resources)
+{
+    std::vector<OCResourceHandle> handles;
+    for (size_t i = 0; i < 300; ++i)
+    {
+        OCResourceHandle handle;
+        std::string uri = "/resource/many/" + std::to_string(i);
+        EXPECT_EQ(OC_STACK_OK, CreateResource(&handle, uri.c_str(), "x.org.iotivity.rt", NULL,
+                NULL, NULL, OC_DISCOVERABLE));
+        handles.push_back(handle);
+    }
+    EXPECT_LT(300u, GetResourceHandles().size());
+
+    IntrospectionCache cache;
+    size_t outSize = cache.Update(m_bus, "v16.10.00", "TITLE", "VERSION");
+    std::vector<uint8_t> out(outSize);
+    EXPECT_EQ(CborNoError, cache.Introspect(&out[0], &outSize));
+    OCPayload *p;
+    EXPECT_EQ(OC_STACK_OK, OCParsePayload(&p, OC_FORMAT_CBOR, PAYLOAD_TYPE_REPRESENTATION,
+            &out[0], outSize));
+    OCRepPayload *payload = (OCRepPayload *) p;
+    OCRepPayload *paths;
+    EXPECT_TRUE(OCRepPayloadGetPropObject(payload, "paths", &paths));
+    OCRepPayload *path = NULL;
+    EXPECT_TRUE(OCRepPayloadGetPropObject(paths, "/resource/many/0", &path));
+    OCRepPayloadDestroy(path);
+    path = NULL;
+    EXPECT_TRUE(OCRepPayloadGetPropObject(paths, "/resource/many/299", &path));
+    OCRepPayloadDestroy(path);
+    OCRepPayloadDestroy(paths);
+    OCPayloadDestroy(p);
+
+    for (OCResourceHandle handle : handles)
+    {
+        DeleteResource(handle);
+    }
+    EXPECT_GT(outSize, cache.Update(m_bus, "v16.10.00", "TITLE", "VERSION"));
+}
+
+TEST_F(Introspection, ResourceHandlesIncludeStackResources)
+{
+    /* Not created with CreateResource(), so only found once the stack is indexed */
+    OCResourceHandle handle;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle, "x.org.iotivity.rt", NULL, "/resource/stack",
+            NULL, NULL, OC_DISCOVERABLE));
+    std::vector<OCResourceHandle> handles = GetResourceHandles();
+    EXPECT_EQ(handles.end(), std::find(handles.begin(), handles.end(), handle));
+    IndexStackResources();
+    handles = GetResourceHandles("");
+    EXPECT_NE(handles.end(), std::find(handles.begin(), handles.end(), handle));
+    EXPECT_NE(handles.end(), std::find(handles.begin(), handles.end(),
+            OCGetResourceHandleAtUri(OC_RSRVD_DEVICE_URI)));
+    handles = GetResourceHandles();
+    EXPECT_NE(handles.end(), std::find(handles.begin(), handles.end(), m_handle));
+    DeleteResource(handle);
+}
+
+TEST_F(Introspection, ModelFingerprintIgnoresResourceOrder)
+{
+    std::vector<Resource> resources = m_context->m_device.m_resources;
+    EXPECT_LT(1u, resources.size());
+    std::string fingerprint = ModelCache::GetFingerprint("ocf.res.1.1.0", resources);
+    std::reverse(resources.begin(), resources.end());
+    EXPECT_EQ(fingerprint, ModelCache::GetFingerprint("ocf.res.1.1.0", resources));
+    EXPECT_NE(fingerprint, ModelCache::GetFingerprint("ocf.res.1.3.0", resources));
+    resources.back().m_rts.push_back("x.org.iotivity.rt2");
+    EXPECT_NE(fingerprint, ModelCache::GetFingerprint("ocf.res.1.1.0", resources));
+}
+
+TEST_F(Introspection, DiscoveredResourcesShareStorage)
+{
+    Resource *d = m_context->m_device.GetResourceUri(OC_RSRVD_DEVICE_URI);
+    Resource *p = m_context->m_device.GetResourceUri(OC_RSRVD_PLATFORM_URI);
+    ASSERT_TRUE(d != NULL);
+    ASSERT_TRUE(p != NULL);
+    EXPECT_TRUE(d->m_addrs.IsSharedWith(p->m_addrs));
+
+    std::vector<std::string> rts = { "x.org.iotivity.rt" };
+    SharedVector<std::string> interned = Intern(std::vector<std::string>(rts));
+    EXPECT_TRUE(interned.IsSharedWith(Intern(std::vector<std::string>(rts))));
+
+    Resource copy = *d;
+    EXPECT_TRUE(copy.m_rts.IsSharedWith(d->m_rts));
+    copy.m_rts.push_back("x.org.iotivity.rt2");
+    EXPECT_FALSE(copy.m_rts.IsSharedWith(d->m_rts));
+    EXPECT_EQ(d->m_rts.size() + 1, copy.m_rts.size());
+}
+
+TEST_F(Introspection, CachedModelMustHaveAPathForEachResource)
+{
+    const char *introspectionJson =
+            "{"
+            "  \"swagger\": \"2.0\","
+            "  \"info\": { \"title\": \"TITLE\", \"version\": \"VERSION\" },"
+            "  \"paths\": {"
+            "    \"/resource\": {"
+            "      \"get\": {"
+            "        \"parameters\": [ { \"name\": \"if\", \"in\": \"query\", \"type\": \"string\", \"enum\": [ \"oic.if.baseline\" ] } ],"
+            "        \"responses\": { \"200\": { \"description\": \"\", \"schema\": { \"oneOf\": [ { \"$ref\": \"#/definitions/x.org.iotivity.rt\" } ] } } }"
+            "      }"
+            "    }"
+            "  },"
+            "  \"definitions\": {"
+            "    \"x.org.iotivity.rt\": {"
+            "      \"type\": \"object\","
+            "      \"properties\": {"
+            "        \"rt\": { \"readOnly\": true, \"type\": \"array\", \"default\": [ \"x.org.iotivity.rt\" ] },"
+            "        \"if\": { \"readOnly\": true, \"type\": \"array\", \"items\": { \"type\": \"string\", \"enum\": [ \"oic.if.baseline\" ] } }"
+            "      }"
+            "    }"
+            "  }"
+            "}";
+    OCRepPayload *introspectionData;
+    EXPECT_EQ(OC_STACK_OK, ParseJsonPayload(&introspectionData, introspectionJson));
+    std::vector<Resource> &resources = m_context->m_device.m_resources;
+    std::string fingerprint = ModelCache::GetFingerprint("ocf.res.1.1.0", resources);
+
+    ModelCache cache;
+    EXPECT_FALSE(cache.Get(fingerprint));
+    cache.Put(fingerprint, introspectionData);
+    ModelCache::Model model = cache.Get(fingerprint);
+    EXPECT_TRUE(model.get() != NULL);
+    EXPECT_TRUE(ModelCache::Matches(model.get(), resources));
+
+    std::vector<Resource>::iterator it = FindResourceFromUri(resources, "/resource");
+    EXPECT_TRUE(it != resources.end());
+    it->m_uri = "/other";
+    EXPECT_FALSE(ModelCache::Matches(model.get(), resources));
+    it->m_uri = "/resource";
+
+    cache.Erase(fingerprint);
+    EXPECT_FALSE(cache.Get(fingerprint));
+    OCRepPayloadDestroy(introspectionData);
+}
+
+TEST_F(Introspection, DeviceSnapshotRestoresDevice)
+{
+    Device &device = m_context->m_device;
+    EXPECT_LT(0u, device.m_resources.size());
+    OCRepPayload *introspectionData = OCRepPayloadCreate();
+    EXPECT_TRUE(OCRepPayloadSetPropString(introspectionData, "swagger", "2.0"));
+    OCRepPayload *deviceData = OCRepPayloadCreate();
+    EXPECT_TRUE(OCRepPayloadSetPropString(deviceData, OC_RSRVD_DEVICE_NAME, "NAME"));
+    std::vector<OCRepPayload *> aboutData;
+    aboutData.push_back(deviceData);
+
+    OCRepPayload *snapshot = DeviceSnapshots::Create(device, "PIID", "ocf.res.1.1.0", aboutData,
+            introspectionData);
+    ASSERT_TRUE(snapshot != NULL);
+    Device restored;
+    std::string piid;
+    std::string dmv;
+    std::vector<const OCRepPayload *> restoredAboutData;
+    const OCRepPayload *restoredIntrospectionData = NULL;
+    EXPECT_TRUE(DeviceSnapshots::Parse(snapshot, restored, piid, dmv, restoredAboutData,
+            &restoredIntrospectionData));
+    EXPECT_EQ(device.m_di, restored.m_di);
+    EXPECT_STREQ("PIID", piid.c_str());
+    EXPECT_STREQ("ocf.res.1.1.0", dmv.c_str());
+    EXPECT_EQ(1u, restoredAboutData.size());
+    EXPECT_TRUE(restoredIntrospectionData != NULL);
+    EXPECT_EQ(ModelCache::GetFingerprint(dmv.c_str(), device.m_resources),
+            ModelCache::GetFingerprint(dmv.c_str(), restored.m_resources));
+    ASSERT_EQ(device.m_resources.size(), restored.m_resources.size());
+    ASSERT_EQ(device.m_resources[0].m_addrs.size(), restored.m_resources[0].m_addrs.size());
+    EXPECT_EQ(device.m_resources[0].m_addrs[0].port, restored.m_resources[0].m_addrs[0].port);
+    EXPECT_STREQ(device.m_resources[0].m_addrs[0].addr, restored.m_resources[0].m_addrs[0].addr);
+
+    DeviceSnapshots snapshots;
+    EXPECT_FALSE(snapshots.Matches(device.m_di, snapshot));
+    snapshots.Put(device.m_di, snapshot);
+    EXPECT_TRUE(snapshots.Matches(device.m_di, snapshot));
+    ++restored.m_resources[0].m_addrs[0].port;
+    OCRepPayload *moved = DeviceSnapshots::Create(restored, "PIID", "ocf.res.1.1.0", aboutData,
+            introspectionData);
+    EXPECT_FALSE(snapshots.Matches(device.m_di, moved));
+
+    OCRepPayloadDestroy(moved);
+    OCRepPayloadDestroy(snapshot);
+    OCRepPayloadDestroy(deviceData);
+    OCRepPayloadDestroy(introspectionData);
+}
+
+TEST_F(Introspection, LargeIntrospectionData)
+{
+    const size_t numDefinitions = 256;
+    const size_t numProperties = 16;
+    OCRepPayload *definitions = OCRepPayloadCreate();
+    for (size_t i = 0; i < numDefinitions; ++i)
+    {
+        std::string rt = "x.org.iotivity.rt" + std::to_string(i);
+        OCRepPayload *properties = OCRepPayloadCreate();
+        for (size_t j = 0; j < numProperties; ++j)
+        {
+            OCRepPayload *property = OCRepPayloadCreate();
+            EXPECT_TRUE(OCRepPayloadSetPropString(property, "type", "integer"));
+            EXPECT_TRUE(OCRepPayloadSetPropInt(property, "minimum", 0));
+            EXPECT_TRUE(OCRepPayloadSetPropInt(property, "maximum", 255));
+            EXPECT_TRUE(OCRepPayloadSetPropObjectAsOwner(properties,
+                    ("property" + std::to_string(j)).c_str(), property));
+        }
+        OCRepPayload *rtProperty = OCRepPayloadCreate();
+        EXPECT_TRUE(OCRepPayloadSetPropBool(rtProperty, "readOnly", true));
+        EXPECT_TRUE(OCRepPayloadSetPropString(rtProperty, "type", "array"));
+        size_t dim[MAX_REP_ARRAY_DEPTH] = { 1, 0, 0 };
+        const char *rts[] = { rt.c_str() };
+        EXPECT_TRUE(OCRepPayloadSetStringArray(rtProperty, "default", rts, dim));
+        EXPECT_TRUE(OCRepPayloadSetPropObjectAsOwner(properties, "rt", rtProperty));
+        OCRepPayload *definition = OCRepPayloadCreate();
+        EXPECT_TRUE(OCRepPayloadSetPropString(definition, "type", "object"));
+        EXPECT_TRUE(OCRepPayloadSetPropObjectAsOwner(definition, "properties", properties));
+        EXPECT_TRUE(OCRepPayloadSetPropObjectAsOwner(definitions, rt.c_str(), definition));
+    }
+    OCRepPayload *introspectionData = OCRepPayloadCreate();
+    EXPECT_TRUE(OCRepPayloadSetPropObjectAsOwner(introspectionData, "paths", OCRepPayloadCreate()));
+    EXPECT_TRUE(OCRepPayloadSetPropObjectAsOwner(introspectionData, "definitions", definitions));
+    EXPECT_TRUE(ParseIntrospectionPayload(m_context->m_device, m_bus, introspectionData));
+    for (size_t i = 0; i < numDefinitions; ++i)
+    {
+        std::string ifaceName = "org.iotivity.rt" + std::to_string(i);
+        const ajn::InterfaceDescription *iface = m_bus->GetInterface(ifaceName.c_str());
+        EXPECT_TRUE(iface != NULL);
+        if (iface)
+        {
+            EXPECT_EQ(numProperties, iface->GetProperties());
+            const ajn::InterfaceDescription::Property *prop = iface->GetProperty("property0");
+            EXPECT_TRUE(prop != NULL);
+            EXPECT_STREQ("y", prop ? prop->signature.c_str() : NULL);
+        }
+    }
+    OCRepPayloadDestroy(introspectionData);
+}
@@ -0,0 +1,220 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "UnitTest.h"
+
+#include "Log.h"
+#include <chrono>
+#include <stdlib.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+class LogTest : public testing::Test
+{
+protected:
+    FILE *m_fp;
+    virtual void SetUp()
+    {
+        m_fp = tmpfile();
+        LogSetOutput(m_fp);
+    }
+    virtual void TearDown()
+    {
+        LogStopAsync();
+        LogSetOutput(NULL);
+        LogSetLevel(LOG_INFO);
+        fclose(m_fp);
+    }
+    std::vector<std::string> GetLines()
+    {
+        std::vector<std::string> lines;
+        char buf[4096];
+        fflush(m_fp);
+        rewind(m_fp);
+        while (fgets(buf, sizeof(buf), m_fp))
+        {
+            lines.push_back(buf);
+        }
+        return lines;
+    }
+};
+
+static size_t sEvaluated = 0;
+static const char *Evaluate()
+{
+    ++sEvaluated;
+    return "evaluated";
+}
+
+TEST_F(LogTest, ArgumentsAreNotEvaluatedBelowLevel)
+{
+    LogSetLevel(LOG_ERR);
+    LOG(LOG_INFO, "%s", Evaluate());
+    EXPECT_EQ(0u, sEvaluated);
+    EXPECT_TRUE(GetLines().empty());
+
+    LOG(LOG_ERR, "%s", Evaluate());
+    EXPECT_EQ(1u, sEvaluated);
+    std::vector<std::string> lines = GetLines();
+    ASSERT_EQ(1u, lines.size());
+    EXPECT_NE(std::string::npos, lines[0].find("ERR  LogTest.cpp:"));
+    EXPECT_NE(std::string::npos, lines[0].find(" - evaluated\n"));
+}
+
+TEST_F(LogTest, LongLinesAreNotTruncated)
+{
+    std::string value(2000, 'x');
+    LOG(LOG_ERR, "%s", value.c_str());
+    LogStartAsync();
+    LOG(LOG_ERR, "%s", value.c_str());
+    LogStopAsync();
+    std::vector<std::string> lines = GetLines();
+    ASSERT_EQ(2u, lines.size());
+    EXPECT_NE(std::string::npos, lines[0].find(" - " + value + "\n"));
+    EXPECT_NE(std::string::npos, lines[1].find(" - " + value + "\n"));
+}
+
+TEST_F(LogTest, AsyncKeepsTheOrderOfEachThread)
+{
+    const size_t numThreads = 4;
+    const size_t numLines = 200;
+    LogStartAsync();
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < numThreads; ++t)
+    {
+        threads.push_back(std::thread([t, numLines]() {
+            for (size_t i = 0; i < numLines; ++i)
+            {
+                LOG(LOG_ERR, "thread=%zu line=%zu", t, i);
+            }
+        }));
+    }
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+    LogStopAsync();
+
+    std::vector<std::string> lines = GetLines();
+    ASSERT_EQ(numThreads * numLines, lines.size());
+    std::vector<size_t> next(numThreads, 0);
+    for (std::string &line : lines)
+    {
+        size_t t, i;
+        ASSERT_EQ(2, sscanf(line.substr(line.find("thread=")).c_str(), "thread=%zu line=%zu",
+                &t, &i));
+        ASSERT_LT(t, numThreads);
+        EXPECT_EQ(next[t]++, i);
+    }
+}
+
+TEST_F(LogTest, AsyncCountsDroppedLines)
+{
+    const size_t numLines = 10000;
+    LogStartAsync();
+    for (size_t i = 0; i < numLines; ++i)
+    {
+        LOG(LOG_ERR, "line=%zu", i);
+    }
+    LogStopAsync();
+
+    size_t written = 0;
+    size_t dropped = 0;
+    for (std::string &line : GetLines())
+    {
+        size_t n;
+        if (sscanf(line.substr(line.find(" - ")).c_str(), " - %zu lines dropped", &n) == 1)
+        {
+            dropped += n;
+        }
+        else
+        {
+            ++written;
+        }
+    }
+    EXPECT_EQ(numLines, written + dropped);
+}
+
+TEST_F(LogTest, StopAsyncKeepsLinesOfConcurrentThreads)
+{
+    /* Stay below the ring size so that no lines are dropped */
+    const size_t numThreads = 4;
+    const size_t numLines = 200;
+    LogStartAsync();
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < numThreads; ++t)
+    {
+        threads.push_back(std::thread([t, numLines]() {
+            for (size_t i = 0; i < numLines; ++i)
+            {
+                LOG(LOG_ERR, "thread=%zu line=%zu", t, i);
+            }
+        }));
+    }
+    LogStopAsync();
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+    EXPECT_EQ(numThreads * numLines, GetLines().size());
+}
+
+/* Simulates the log lines of a request forwarded from one side of the bridge to the other */
+static void HandleRequest(size_t i)
+{
+    std::string uri = "/light/" + std::to_string(i % 16);
+    LOG(LOG_INFO, "[%p] flag=%x,request=%p", (void *) &uri, 1, (void *) &i);
+    LOG(LOG_INFO, "[%p] method=%d,uri=%s,query=%s", (void *) &uri, 2, uri.c_str(),
+            "if=oic.if.baseline");
+    LOG(LOG_INFO, "[%p] msg=%s", (void *) &uri, "{ \"value\": true, \"brightness\": 50 }");
+    LOG(LOG_INFO, "[%p] ehResult=%d", (void *) &uri, 0);
+}
+
+static double RequestsPerSecond(size_t numRequests)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < numRequests; ++i)
+    {
+        HandleRequest(i);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return numRequests / elapsed.count();
+}
+
+TEST_F(LogTest, DisabledLevelIsFasterThanLogging)
+{
+    /* Stay below the ring size so that the async case measures queueing, not dropping */
+    const size_t numRequests = 200;
+    const size_t numRounds = 50;
+    double sync = 0, async = 0, disabled = 0;
+    for (size_t round = 0; round < numRounds; ++round)
+    {
+        sync += RequestsPerSecond(numRequests);
+        LogStartAsync();
+        async += RequestsPerSecond(numRequests);
+        LogStopAsync();
+        LogSetLevel(LOG_ERR);
+        disabled += RequestsPerSecond(numRequests);
+        LogSetLevel(LOG_INFO);
+    }
+    EXPECT_GT(disabled, sync);
+    EXPECT_GT(disabled, async);
+}
@@ -0,0 +1,170 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "UnitTest.h"
+
+#include "Metrics.h"
+#include <chrono>
+#include <thread>
+
+static const Metric::Snapshot *Find(const std::vector<Metric::Snapshot> &snapshots,
+        const char *name)
+{
+    for (const Metric::Snapshot &snapshot : snapshots)
+    {
+        if (snapshot.m_name == name)
+        {
+            return &snapshot;
+        }
+    }
+    return NULL;
+}
+
+TEST(MetricsTest, BucketsAreContiguous)
+{
+    for (uint64_t value = 0; value < 4096; ++value)
+    {
+        unsigned bucket = Histogram::GetBucket(value);
+        EXPECT_LE(value, Histogram::GetBucketMax(bucket));
+        EXPECT_TRUE((bucket == 0) || (Histogram::GetBucketMax(bucket - 1) < value));
+    }
+    EXPECT_EQ(Histogram::NUM_BUCKETS - 1, Histogram::GetBucket(UINT64_MAX));
+    EXPECT_EQ(UINT64_MAX, Histogram::GetBucketMax(Histogram::NUM_BUCKETS - 1));
+}
+
+TEST(MetricsTest, PercentilesAreWithinBucketError)
+{
+    Histogram histogram("test.histogram");
+    for (uint64_t value = 1; value <= 1000; ++value)
+    {
+        histogram.Record(value * 1000);
+    }
+    EXPECT_EQ(1000u, histogram.GetCount());
+    uint64_t p50 = histogram.GetPercentile(50);
+    EXPECT_LE(500000u, p50);
+    EXPECT_GE(500000u + (500000u / Histogram::SUB_BUCKETS), p50);
+    uint64_t p99 = histogram.GetPercentile(99);
+    EXPECT_LE(990000u, p99);
+    EXPECT_GE(990000u + (990000u / Histogram::SUB_BUCKETS), p99);
+    EXPECT_EQ(1000000u, histogram.GetPercentile(100));
+}
+
+TEST(MetricsTest, SnapshotAndReset)
+{
+    Counter counter("test.counter");
+    Gauge gauge("test.gauge");
+    Histogram histogram("test.histogram");
+    counter.Increment();
+    counter.Increment(2);
+    gauge.Increment();
+    gauge.Increment();
+    gauge.Decrement();
+    histogram.Record(7);
+    histogram.Record(3);
+
+    std::vector<Metric::Snapshot> snapshots = SnapshotMetrics();
+    const Metric::Snapshot *snapshot = Find(snapshots, "test.counter");
+    ASSERT_TRUE(snapshot != NULL);
+    EXPECT_EQ(Metric::COUNTER, snapshot->m_type);
+    EXPECT_EQ(3, snapshot->m_value);
+    snapshot = Find(snapshots, "test.gauge");
+    ASSERT_TRUE(snapshot != NULL);
+    EXPECT_EQ(Metric::GAUGE, snapshot->m_type);
+    EXPECT_EQ(1, snapshot->m_value);
+    snapshot = Find(snapshots, "test.histogram");
+    ASSERT_TRUE(snapshot != NULL);
+    EXPECT_EQ(Metric::HISTOGRAM, snapshot->m_type);
+    EXPECT_EQ(2u, snapshot->m_count);
+    EXPECT_EQ(10u, snapshot->m_sum);
+    EXPECT_EQ(7u, snapshot->m_max);
+    EXPECT_EQ(3u, snapshot->m_p50);
+
+    ResetMetrics();
+    EXPECT_EQ(0u, counter.Get());
+    EXPECT_EQ(1, gauge.Get());
+    EXPECT_EQ(0u, histogram.GetCount());
+    EXPECT_EQ(0u, histogram.GetPercentile(50));
+}
+
+TEST(MetricsTest, SampledGauge)
+{
+    Gauge gauge("test.sampled");
+    gauge.Set(42);
+    gauge.Increment();
+    EXPECT_EQ(43, gauge.Get());
+    gauge.Set(-1);
+    EXPECT_EQ(-1, gauge.Get());
+    ResetMetrics();
+    EXPECT_EQ(-1, gauge.Get());
+}
+
+TEST(MetricsTest, DestroyedMetricsAreUnregistered)
+{
+    {
+        Counter counter("test.scoped");
+        EXPECT_TRUE(Find(SnapshotMetrics(), "test.scoped") != NULL);
+    }
+    EXPECT_TRUE(Find(SnapshotMetrics(), "test.scoped") == NULL);
+}
+
+TEST(MetricsTest, ConcurrentUpdates)
+{
+    Counter counter("test.concurrent.counter");
+    Histogram histogram("test.concurrent.histogram");
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i)
+    {
+        threads.push_back(std::thread([&counter, &histogram, i]() {
+            for (uint64_t j = 0; j < 10000; ++j)
+            {
+                counter.Increment();
+                histogram.Record(j + i);
+            }
+        }));
+    }
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+    EXPECT_EQ(40000u, counter.Get());
+    EXPECT_EQ(40000u, histogram.GetCount());
+    EXPECT_EQ(10002u, histogram.GetPercentile(100));
+}
+
+TEST(MetricsTest, MeteredLockRecordsContendedWaits)
+{
+    Histogram waits("test.lock_wait");
+    std::mutex mutex;
+    {
+        MeteredLock lock(mutex, waits);
+        EXPECT_TRUE(lock.owns_lock());
+    }
+    EXPECT_EQ(0u, waits.GetCount());
+
+    std::unique_lock<std::mutex> held(mutex);
+    std::thread thread([&mutex, &waits]() {
+        MeteredLock lock(mutex, waits);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    held.unlock();
+    thread.join();
+    EXPECT_EQ(1u, waits.GetCount());
+    EXPECT_LE(10000000u, waits.GetPercentile(100));
+}
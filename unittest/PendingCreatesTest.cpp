@@ -0,0 +1,105 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "UnitTest.h"
+
+#include "PendingCreates.h"
+
+static const PendingCreates::TimePoint sAnnounced = std::chrono::steady_clock::now();
+
+TEST(PendingCreatesTest, BatchCompletesWhenLastResourceCreated)
+{
+    PendingCreates pending;
+    int a, b;
+    pending.Add(":1.1", &a, sAnnounced);
+    pending.Add(":1.1", &b, sAnnounced);
+    EXPECT_EQ(2u, pending.GetNumPending());
+
+    EXPECT_FALSE(pending.Created(&a));
+    EXPECT_TRUE(pending.GetCompleted().empty());
+    EXPECT_TRUE(pending.Created(&b));
+    EXPECT_EQ(0u, pending.GetNumPending());
+
+    std::vector<PendingCreates::Batch> completed = pending.GetCompleted();
+    ASSERT_EQ(1u, completed.size());
+    EXPECT_EQ(":1.1", completed[0].m_device);
+    EXPECT_EQ(2u, completed[0].m_numPaths);
+    EXPECT_TRUE(sAnnounced == completed[0].m_announced);
+    EXPECT_TRUE(pending.GetCompleted().empty());
+}
+
+TEST(PendingCreatesTest, RemoveBeforeReply)
+{
+    PendingCreates pending;
+    int a, b;
+    pending.Add(":1.1", &a, sAnnounced);
+    pending.Add(":1.1", &b, sAnnounced);
+
+    /* The reply for b never arrives */
+    EXPECT_FALSE(pending.Created(&a));
+    EXPECT_TRUE(pending.Removed(&b));
+    EXPECT_FALSE(pending.Created(&b));
+    EXPECT_EQ(0u, pending.GetNumPending());
+    EXPECT_FALSE(pending.IsPending(":1.1"));
+
+    std::vector<PendingCreates::Batch> completed = pending.GetCompleted();
+    ASSERT_EQ(1u, completed.size());
+    EXPECT_EQ(1u, completed[0].m_numPaths);
+
+    /* A later announcement starts a new batch */
+    PendingCreates::TimePoint announced = sAnnounced + std::chrono::seconds(1);
+    pending.Add(":1.1", &a, announced);
+    EXPECT_TRUE(pending.IsPending(":1.1"));
+    EXPECT_TRUE(pending.Created(&a));
+    completed = pending.GetCompleted();
+    ASSERT_EQ(1u, completed.size());
+    EXPECT_EQ(1u, completed[0].m_numPaths);
+    EXPECT_TRUE(announced == completed[0].m_announced);
+}
+
+TEST(PendingCreatesTest, RemovingEveryResourceDropsBatch)
+{
+    PendingCreates pending;
+    int a;
+    pending.Add(":1.1", &a, sAnnounced);
+    EXPECT_FALSE(pending.Removed(&a));
+    EXPECT_EQ(0u, pending.GetNumPending());
+    EXPECT_TRUE(pending.GetCompleted().empty());
+}
+
+TEST(PendingCreatesTest, DevicesAreIndependent)
+{
+    PendingCreates pending;
+    int a, b;
+    pending.Add(":1.1", &a, sAnnounced);
+    pending.Add(":1.2", &b, sAnnounced);
+
+    /* The slow device does not hold back the other */
+    EXPECT_TRUE(pending.Created(&b));
+    EXPECT_TRUE(pending.IsPending(":1.1"));
+    std::vector<PendingCreates::Batch> completed = pending.GetCompleted();
+    ASSERT_EQ(1u, completed.size());
+    EXPECT_EQ(":1.2", completed[0].m_device);
+
+    EXPECT_TRUE(pending.Created(&a));
+    completed = pending.GetCompleted();
+    ASSERT_EQ(1u, completed.size());
+    EXPECT_EQ(":1.1", completed[0].m_device);
+}
@@ -0,0 +1,105 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "UnitTest.h"
+
+#include "PingSchedule.h"
+
+TEST(PingScheduleTest, IntervalGrowsWhileStable)
+{
+    PingSchedule schedule(2, 64, 3);
+    time_t now = 1000;
+    schedule.Add("a", now);
+    EXPECT_EQ(2, schedule.GetInterval("a"));
+    std::vector<std::string> due;
+    for (; due.empty(); ++now)
+    {
+        due = schedule.GetDue(now);
+    }
+    ASSERT_EQ(1u, due.size());
+    EXPECT_TRUE(schedule.GetDue(now).empty());
+    schedule.Pinged("a", true, now);
+    EXPECT_EQ(4, schedule.GetInterval("a"));
+    for (int i = 0; i < 8; ++i)
+    {
+        for (due.clear(); due.empty(); ++now)
+        {
+            due = schedule.GetDue(now);
+        }
+        schedule.Pinged("a", true, now);
+    }
+    EXPECT_EQ(64, schedule.GetInterval("a"));
+    EXPECT_EQ(9u, schedule.GetNumPings());
+}
+
+TEST(PingScheduleTest, AbsentAfterRetries)
+{
+    PingSchedule schedule(2, 64, 3);
+    time_t now = 1000;
+    schedule.Add("a", now);
+    for (int i = 0; i < 4; ++i)
+    {
+        std::vector<std::string> due;
+        for (; due.empty(); ++now)
+        {
+            due = schedule.GetDue(now);
+        }
+        EXPECT_TRUE(schedule.IsPresent("a"));
+        schedule.Pinged("a", false, now);
+        EXPECT_EQ(2, schedule.GetInterval("a"));
+    }
+    EXPECT_FALSE(schedule.IsPresent("a"));
+    EXPECT_TRUE(schedule.GetDue(now + 100).empty());
+}
+
+TEST(PingScheduleTest, SeenPostponesPing)
+{
+    PingSchedule schedule(2, 64, 3);
+    time_t now = 1000;
+    schedule.Add("a", now);
+    for (int i = 0; i < 100; ++i, ++now)
+    {
+        schedule.Seen("a", now);
+        EXPECT_TRUE(schedule.GetDue(now).empty());
+    }
+    EXPECT_EQ(0u, schedule.GetNumPings());
+}
+
+TEST(PingScheduleTest, PeersAddedTogetherDrift)
+{
+    PingSchedule schedule(8, 64, 3);
+    time_t now = 1000;
+    for (int i = 0; i < 100; ++i)
+    {
+        schedule.Add(std::to_string(i), now);
+    }
+    std::set<time_t> ticks;
+    for (time_t end = now + 600; now < end; ++now)
+    {
+        std::vector<std::string> due = schedule.GetDue(now);
+        for (const std::string &name : due)
+        {
+            ticks.insert(now);
+            schedule.Pinged(name, true, now);
+        }
+        EXPECT_GT(50u, due.size());
+    }
+    EXPECT_LT(20u, ticks.size());
+}
@@ -0,0 +1,97 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "UnitTest.h"
+
+#include "Presence.h"
+#include <chrono>
+#include <string.h>
+#include <thread>
+
+class TestOCPresence : public OCPresence
+{
+    public:
+        size_t m_numProbes;
+        OCCallbackData m_cbData;
+        TestOCPresence(const char *di, const SharedVector<OCDevAddr> &addrs, time_t periodSecs)
+            : OCPresence(di, addrs, periodSecs), m_numProbes(0) { }
+        void ProbeFailed() { m_cbData.cb(m_cbData.context, NULL, NULL); }
+
+    protected:
+        virtual OCStackResult SendProbe(OCCallbackData *cbData)
+        {
+            ++m_numProbes;
+            m_cbData = *cbData;
+            return OC_STACK_OK;
+        }
+};
+
+static SharedVector<OCDevAddr> GetAddrs()
+{
+    OCDevAddr addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.adapter = OC_ADAPTER_IP;
+    strcpy(addr.addr, "127.0.0.1");
+    addr.port = 5683;
+    std::vector<OCDevAddr> addrs;
+    addrs.push_back(addr);
+    return SharedVector<OCDevAddr>(addrs);
+}
+
+TEST(PresenceTest, RespondedResetsMissesAndSuppressesProbe)
+{
+    const char *di = "9c1f7d6e-52a4-4f7b-8a9e-3b2d1c0f4e5a";
+    TestOCPresence presence(di, GetAddrs(), 1);
+    std::this_thread::sleep_for(std::chrono::seconds(2));
+    for (size_t i = 0; i < 2; ++i)
+    {
+        EXPECT_TRUE(presence.IsPresent());
+        EXPECT_EQ(i + 1, presence.m_numProbes);
+        presence.ProbeFailed();
+    }
+
+    /* A response seen elsewhere counts as a sighting, so no probe is sent */
+    OCPresence::Responded(di);
+    EXPECT_TRUE(presence.IsPresent());
+    EXPECT_EQ(2u, presence.m_numProbes);
+
+    /* Without the reset, this would be the third consecutive failure */
+    std::this_thread::sleep_for(std::chrono::seconds(2));
+    EXPECT_TRUE(presence.IsPresent());
+    EXPECT_EQ(3u, presence.m_numProbes);
+    presence.ProbeFailed();
+    EXPECT_TRUE(presence.IsPresent());
+    EXPECT_EQ(4u, presence.m_numProbes);
+    presence.ProbeFailed();
+}
+
+TEST(PresenceTest, AbsentAfterConsecutiveFailedProbes)
+{
+    const char *di = "0d8b3a51-6c2e-4e19-9f47-a2c5e8b1d763";
+    TestOCPresence presence(di, GetAddrs(), 1);
+    std::this_thread::sleep_for(std::chrono::seconds(2));
+    for (size_t i = 0; i < 3; ++i)
+    {
+        EXPECT_TRUE(presence.IsPresent());
+        presence.ProbeFailed();
+    }
+    EXPECT_FALSE(presence.IsPresent());
+    presence.ProbeFailed();
+}
@@ -0,0 +1,71 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "UnitTest.h"
+
+#include "PublishedLinks.h"
+#include <algorithm>
+
+TEST(PublishedLinksTest, FirstPublicationReplaces)
+{
+    PublishedLinks published(600);
+    PublishedLinks::Links links = { { "/a", 1 }, { "/b", 2 } };
+    std::vector<std::string> added;
+    std::vector<int64_t> removed;
+    EXPECT_EQ(PublishedLinks::REPLACE, published.Update(links, 1000, added, removed));
+    EXPECT_TRUE(added.empty());
+    EXPECT_TRUE(removed.empty());
+}
+
+TEST(PublishedLinksTest, SendsOnlyChanges)
+{
+    PublishedLinks published(600);
+    PublishedLinks::Links links = { { "/a", 1 }, { "/b", 2 }, { "/c", 3 } };
+    std::vector<std::string> added;
+    std::vector<int64_t> removed;
+    published.Update(links, 1000, added, removed);
+
+    EXPECT_EQ(PublishedLinks::DELTA, published.Update(links, 1001, added, removed));
+    EXPECT_TRUE(added.empty());
+    EXPECT_TRUE(removed.empty());
+
+    links.erase("/a");
+    links["/b"] = 4;
+    links["/d"] = 5;
+    EXPECT_EQ(PublishedLinks::DELTA, published.Update(links, 1002, added, removed));
+    std::sort(added.begin(), added.end());
+    std::sort(removed.begin(), removed.end());
+    EXPECT_EQ(std::vector<std::string>({ "/b", "/d" }), added);
+    EXPECT_EQ(std::vector<int64_t>({ 1, 2 }), removed);
+}
+
+TEST(PublishedLinksTest, RefreshesAndReplacesAfterFailure)
+{
+    PublishedLinks published(600);
+    PublishedLinks::Links links = { { "/a", 1 } };
+    std::vector<std::string> added;
+    std::vector<int64_t> removed;
+    published.Update(links, 1000, added, removed);
+    EXPECT_EQ(PublishedLinks::DELTA, published.Update(links, 1599, added, removed));
+    EXPECT_EQ(PublishedLinks::REFRESH, published.Update(links, 1600, added, removed));
+    EXPECT_EQ(PublishedLinks::DELTA, published.Update(links, 1601, added, removed));
+    published.Reset();
+    EXPECT_EQ(PublishedLinks::REPLACE, published.Update(links, 1602, added, removed));
+}
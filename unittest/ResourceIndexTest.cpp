@@ -0,0 +1,95 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "UnitTest.h"
+
+#include "ResourceIndex.h"
+
+static OCResourceHandle Handle(uintptr_t i)
+{
+    return (OCResourceHandle) (i + 1);
+}
+
+TEST(ResourceIndexTest, ScalesPast255Resources)
+{
+    ResourceIndex index;
+    const size_t n = 1000;
+    for (size_t i = 0; i < n; ++i)
+    {
+        index.Add(Handle(i), (i % 2) ? "odd" : "even");
+    }
+    EXPECT_EQ(n, index.Size());
+    EXPECT_TRUE(index.Contains(Handle(0)));
+    EXPECT_TRUE(index.Contains(Handle(n - 1)));
+    EXPECT_FALSE(index.Contains(Handle(n)));
+
+    std::vector<OCResourceHandle> handles = index.GetHandles();
+    ASSERT_EQ(n, handles.size());
+    for (size_t i = 0; i < n; ++i)
+    {
+        EXPECT_EQ(Handle(i), handles[i]);
+    }
+    EXPECT_EQ(n / 2, index.GetHandles("odd").size());
+    EXPECT_EQ(n / 2, index.GetHandles("even").size());
+}
+
+TEST(ResourceIndexTest, GroupsByDevice)
+{
+    ResourceIndex index;
+    index.Add(Handle(0), "a");
+    index.Add(Handle(1), "b");
+    index.Add(Handle(2), "a");
+    index.Add(Handle(2), "b");
+    EXPECT_EQ(3u, index.Size());
+    EXPECT_EQ(std::vector<OCResourceHandle>({ Handle(0), Handle(2) }), index.GetHandles("a"));
+    EXPECT_EQ(std::vector<OCResourceHandle>({ Handle(1) }), index.GetHandles("b"));
+    EXPECT_TRUE(index.GetHandles("c").empty());
+    EXPECT_EQ("a", index.GetDevice(Handle(2)));
+    EXPECT_EQ("", index.GetDevice(Handle(3)));
+}
+
+TEST(ResourceIndexTest, RemovesHandles)
+{
+    ResourceIndex index;
+    for (size_t i = 0; i < 300; ++i)
+    {
+        index.Add(Handle(i), "a");
+    }
+    for (size_t i = 0; i < 300; i += 2)
+    {
+        index.Remove(Handle(i));
+    }
+    index.Remove(Handle(300));
+    EXPECT_EQ(150u, index.Size());
+    EXPECT_FALSE(index.Contains(Handle(0)));
+    EXPECT_TRUE(index.Contains(Handle(1)));
+    std::vector<OCResourceHandle> handles = index.GetHandles("a");
+    ASSERT_EQ(150u, handles.size());
+    EXPECT_EQ(Handle(1), handles.front());
+    EXPECT_EQ(Handle(299), handles.back());
+
+    for (size_t i = 1; i < 300; i += 2)
+    {
+        index.Remove(Handle(i));
+    }
+    EXPECT_EQ(0u, index.Size());
+    EXPECT_TRUE(index.GetHandles().empty());
+    EXPECT_TRUE(index.GetHandles("a").empty());
+}
@@ -0,0 +1,77 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "UnitTest.h"
+
+#include "SeenStates.h"
+
+TEST(SeenStatesTest, NotSeenUntilSet)
+{
+    SeenStates states(NULL);
+    EXPECT_EQ(Bridge::NOT_SEEN, states.Get("a"));
+    states.Set("a", Bridge::SEEN_NATIVE);
+    states.Set("b", Bridge::SEEN_VIRTUAL);
+    EXPECT_EQ(Bridge::SEEN_NATIVE, states.Get("a"));
+    EXPECT_EQ(Bridge::SEEN_VIRTUAL, states.Get("b"));
+    states.Set("a", Bridge::NOT_SEEN);
+    EXPECT_EQ(Bridge::NOT_SEEN, states.Get("a"));
+}
+
+TEST(SeenStatesTest, ExitOfCurrentProcessClearsState)
+{
+    SeenStates states(NULL);
+    states.Set("a", Bridge::SEEN_NATIVE);
+    states.SetPid("a", 100);
+    states.Exited("a", 101);
+    EXPECT_EQ(Bridge::SEEN_NATIVE, states.Get("a"));
+    states.Exited("a", 100);
+    EXPECT_EQ(Bridge::NOT_SEEN, states.Get("a"));
+}
+
+TEST(SeenStatesTest, ExitOfReplacedProcessIsIgnored)
+{
+    SeenStates states(NULL);
+    states.Set("a", Bridge::SEEN_VIRTUAL);
+    states.SetPid("a", 100);
+
+    /* A native device replaces the virtual one before its process has exited */
+    states.Set("a", Bridge::SEEN_NATIVE);
+    states.Exited("a", 100);
+    EXPECT_EQ(Bridge::SEEN_NATIVE, states.Get("a"));
+    states.SetPid("a", 200);
+    states.Exited("a", 100);
+    EXPECT_EQ(Bridge::SEEN_NATIVE, states.Get("a"));
+    states.Exited("a", 200);
+    EXPECT_EQ(Bridge::NOT_SEEN, states.Get("a"));
+}
+
+TEST(SeenStatesTest, FlushKeepsStates)
+{
+    SeenStates states(NULL);
+    states.Flush();
+    states.Set("a", Bridge::SEEN_NATIVE);
+    states.SetPid("a", 100);
+    states.Flush();
+    states.Flush();
+    EXPECT_EQ(Bridge::SEEN_NATIVE, states.Get("a"));
+    states.Exited("a", 100);
+    states.Flush();
+    EXPECT_EQ(Bridge::NOT_SEEN, states.Get("a"));
+}
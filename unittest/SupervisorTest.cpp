@@ -0,0 +1,110 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "UnitTest.h"
+
+#include "Supervisor.h"
+#include <signal.h>
+#include <unistd.h>
+
+/* The waitpid() statuses of a process killed by sig and of one that exited with code */
+#define SIGNALED(sig) (sig)
+#define EXITED(code) ((code) << 8)
+
+TEST(SupervisorTest, BackoffDoublesUpToMaximum)
+{
+    EXPECT_EQ(Supervisor::MIN_BACKOFF_SECS, Supervisor::GetBackoff(0));
+    EXPECT_EQ(2 * Supervisor::MIN_BACKOFF_SECS, Supervisor::GetBackoff(1));
+    EXPECT_EQ(4 * Supervisor::MIN_BACKOFF_SECS, Supervisor::GetBackoff(2));
+    EXPECT_EQ(Supervisor::MAX_BACKOFF_SECS, Supervisor::GetBackoff(100));
+}
+
+TEST(SupervisorTest, CrashedProcessIsRestartedAfterBackoff)
+{
+    Supervisor supervisor(Supervisor::Limits(), 30, 60);
+    std::vector<std::string> args = { "--uuid", "a" };
+    supervisor.Add(100, "a", args, 1000);
+
+    std::string uuid;
+    bool restart = false;
+    EXPECT_TRUE(supervisor.Exited(100, SIGNALED(SIGSEGV), 1001, &uuid, &restart));
+    EXPECT_EQ("a", uuid);
+    EXPECT_TRUE(restart);
+    EXPECT_TRUE(supervisor.GetRestarts(1001).empty());
+    std::vector<Supervisor::Restart> restarts = supervisor.GetRestarts(1002);
+    ASSERT_EQ(1u, restarts.size());
+    EXPECT_EQ(100, restarts[0].m_pid);
+    EXPECT_EQ("a", restarts[0].m_uuid);
+    EXPECT_EQ(args, restarts[0].m_args);
+    EXPECT_TRUE(supervisor.GetRestarts(1003).empty());
+
+    /* The second consecutive crash waits twice as long */
+    supervisor.Add(101, "a", args, 1002);
+    EXPECT_TRUE(supervisor.Exited(101, SIGNALED(SIGKILL), 1003, &uuid, &restart));
+    EXPECT_TRUE(restart);
+    EXPECT_TRUE(supervisor.GetRestarts(1004).empty());
+    EXPECT_EQ(1u, supervisor.GetRestarts(1005).size());
+}
+
+TEST(SupervisorTest, ExitedOrRemovedProcessIsNotRestarted)
+{
+    Supervisor supervisor(Supervisor::Limits(), 30, 60);
+    std::string uuid;
+    bool restart = true;
+    supervisor.Add(100, "a", { "--uuid", "a" }, 1000);
+    EXPECT_TRUE(supervisor.Exited(100, EXITED(1), 1001, &uuid, &restart));
+    EXPECT_FALSE(restart);
+
+    supervisor.Add(101, "b", { "--uuid", "b" }, 1000);
+    EXPECT_TRUE(supervisor.Remove("b"));
+    EXPECT_FALSE(supervisor.Remove("b"));
+    EXPECT_FALSE(supervisor.Exited(101, SIGNALED(SIGINT), 1001, &uuid, &restart));
+
+    /* A process without arguments is never restarted */
+    supervisor.Add(102, "", std::vector<std::string>(), 1000);
+    EXPECT_TRUE(supervisor.Exited(102, SIGNALED(SIGSEGV), 1001, &uuid, &restart));
+    EXPECT_FALSE(restart);
+    EXPECT_TRUE(supervisor.GetRestarts(2000).empty());
+}
+
+TEST(SupervisorTest, MissingHeartbeatsAreWedged)
+{
+    Supervisor supervisor(Supervisor::Limits(), 30, 60);
+    supervisor.Add(100, "a", { "--uuid", "a" }, 1000);
+    EXPECT_TRUE(supervisor.GetWedged(1060).empty());
+    EXPECT_EQ(std::vector<pid_t>({ 100 }), supervisor.GetWedged(1061));
+
+    EXPECT_TRUE(supervisor.Heartbeat(100, 10, 1061));
+    EXPECT_TRUE(supervisor.GetWedged(1091).empty());
+    EXPECT_EQ(std::vector<pid_t>({ 100 }), supervisor.GetWedged(1092));
+    EXPECT_FALSE(supervisor.Heartbeat(101, 10, 1061));
+
+    /* Processes that are only accounted for are never wedged */
+    supervisor.Add(102, "", std::vector<std::string>(), 1000);
+    EXPECT_EQ(std::vector<pid_t>({ 100 }), supervisor.GetWedged(2000));
+}
+
+TEST(SupervisorTest, ReadProcStats)
+{
+    uint64_t cpuMs = 0;
+    uint64_t rssBytes = 0;
+    EXPECT_TRUE(Supervisor::ReadProcStats(getpid(), &cpuMs, &rssBytes));
+    EXPECT_LT(0u, rssBytes);
+}
@@ -0,0 +1,113 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "UnitTest.h"
+
+#include "Trace.h"
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+
+static std::string ReadFile(const char *path)
+{
+    std::string contents;
+    FILE *fp = fopen(path, "r");
+    if (fp)
+    {
+        char buf[256];
+        size_t n;
+        while ((n = fread(buf, 1, sizeof(buf), fp)) > 0)
+        {
+            contents.append(buf, n);
+        }
+        fclose(fp);
+    }
+    return contents;
+}
+
+static size_t Count(const std::string &str, const std::string &substr)
+{
+    size_t n = 0;
+    for (size_t pos = str.find(substr); pos != std::string::npos; pos = str.find(substr, pos + 1))
+    {
+        ++n;
+    }
+    return n;
+}
+
+TEST(TraceTest, DisabledByDefault)
+{
+    EXPECT_TRUE(Trace::Create("test", "/a") == NULL);
+    EXPECT_TRUE(Trace::GetCurrent() == NULL);
+    TraceSpan span("test.span");
+}
+
+TEST(TraceTest, SpansAreWrittenWhenTraceIsReleased)
+{
+    const char *path = "TraceTest.json";
+    ASSERT_TRUE(Trace::Start(path, 1));
+    {
+        TraceCall call;
+        {
+            TraceScope scope(Trace::Create("test.request", "/a\"b"));
+            ASSERT_TRUE(Trace::GetCurrent() != NULL);
+            TraceSpan span("test.span");
+            call.Begin("test.call");
+        }
+        EXPECT_TRUE(Trace::GetCurrent() == NULL);
+        /* The reply to the call is handled on another thread */
+        std::thread thread([&call]() {
+            TraceScope scope(call.GetTrace());
+            call.End();
+            TraceSpan span("test.reply");
+        });
+        thread.join();
+        EXPECT_EQ(std::string("[\n"), ReadFile(path));
+    }
+    Trace::Stop();
+    std::string json = ReadFile(path);
+    EXPECT_EQ(1u, Count(json, "\"name\":\"test.request\""));
+    EXPECT_EQ(1u, Count(json, "\"name\":\"test.span\""));
+    EXPECT_EQ(1u, Count(json, "\"name\":\"test.call\""));
+    EXPECT_EQ(1u, Count(json, "\"name\":\"test.reply\""));
+    EXPECT_EQ(1u, Count(json, "\"detail\":\"/a\\\"b\""));
+    EXPECT_EQ(0u, json.find("[\n{"));
+    EXPECT_EQ(json.size() - 3, json.rfind("}\n]\n") + 1);
+    remove(path);
+}
+
+TEST(TraceTest, Sampling)
+{
+    const char *path = "TraceTest.json";
+    ASSERT_TRUE(Trace::Start(path, 4));
+    size_t sampled = 0;
+    for (int i = 0; i < 100; ++i)
+    {
+        if (Trace::Create("test.request", NULL))
+        {
+            ++sampled;
+        }
+    }
+    Trace::Stop();
+    EXPECT_EQ(25u, sampled);
+    EXPECT_EQ(25u, Count(ReadFile(path), "\"name\":\"test.request\""));
+    EXPECT_TRUE(Trace::Create("test.request", NULL) == NULL);
+    remove(path);
+}
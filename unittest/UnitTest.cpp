@@ -171,7 +171,7 @@ OCStackApplicationResult ObserveCallback::Handler(OCDoHandle handle, OCClientRes
     return OC_STACK_KEEP_TRANSACTION;
 }
 
-CreateCallback::CreateCallback() : m_called(false)
+CreateCallback::CreateCallback() : m_called(false), m_result(OC_STACK_ERROR)
 {
 }
 
@@ -189,12 +189,14 @@ OCStackResult CreateCallback::Wait(long waitMs)
         OCProcess();
         std::this_thread::sleep_for(std::chrono::milliseconds(10));
     }
-    return m_called ? OC_STACK_OK : OC_STACK_TIMEOUT;
+    return m_called ? m_result : OC_STACK_TIMEOUT;
 }
 
-void CreateCallback::cb(void *ctx)
+void CreateCallback::cb(void *ctx, VirtualResource *resource, OCStackResult result)
 {
+    (void) resource;
     CreateCallback *callback = (CreateCallback *) ctx;
+    callback->m_result = result;
     callback->m_called = true;
 }
 
@@ -206,6 +208,7 @@ void AJOCSetUp::SetUp()
 void AJOCSetUp::SetUpStack()
 {
     EXPECT_EQ(OC_STACK_OK, OCInit2(OC_SERVER, OC_DEFAULT_FLAGS, OC_DEFAULT_FLAGS, OC_ADAPTER_IP));
+    IndexStackResources();
     EXPECT_EQ(ER_OK, AllJoynInit());
     EXPECT_EQ(ER_OK, AllJoynRouterInit());
 }
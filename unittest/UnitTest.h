@@ -102,7 +102,8 @@ public:
     operator VirtualResource::CreateCB () { return cb; }
 private:
     bool m_called;
-    static void cb(void *ctx);
+    OCStackResult m_result;
+    static void cb(void *ctx, VirtualResource *resource, OCStackResult result);
 };
 
 class MethodCall : public ajn::MessageReceiver
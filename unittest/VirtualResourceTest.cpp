@@ -126,9 +126,11 @@ public:
     }
 };
 
-static void CreateCB(void *ctx)
+static void CreateCB(void *ctx, VirtualResource *resource, OCStackResult result)
 {
     (void) ctx;
+    (void) resource;
+    (void) result;
 }
 
 int main(int, char **)
@@ -0,0 +1,195 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "UnitTest.h"
+
+#include "Strand.h"
+#include "WorkerPool.h"
+#include <atomic>
+
+TEST(WorkerPoolTest, RunsQueuedWork)
+{
+    std::atomic<size_t> n(0);
+    WorkerPool pool(4, 64);
+    EXPECT_EQ(4u, pool.GetNumThreads());
+    for (size_t i = 0; i < 64; ++i)
+    {
+        while (!pool.Post([&n]() { ++n; }))
+        {
+            std::this_thread::yield();
+        }
+    }
+    pool.Stop();
+    EXPECT_EQ(64u, (size_t) n);
+    EXPECT_EQ(0u, pool.GetQueueDepth());
+}
+
+TEST(WorkerPoolTest, RejectsWhenFull)
+{
+    std::mutex mutex;
+    std::unique_lock<std::mutex> block(mutex);
+    WorkerPool pool(1, 2);
+    /* Occupy the only thread */
+    std::atomic<bool> running(false);
+    EXPECT_TRUE(pool.Post([&]() { running = true; std::lock_guard<std::mutex> lock(mutex); }));
+    while (!running)
+    {
+        std::this_thread::yield();
+    }
+    EXPECT_TRUE(pool.Post([]() { }));
+    EXPECT_TRUE(pool.Post([]() { }));
+    EXPECT_FALSE(pool.Post([]() { }));
+    EXPECT_EQ(2u, pool.GetQueueDepth());
+    EXPECT_EQ(2u, pool.GetMaxQueueDepth());
+    EXPECT_EQ(1u, pool.GetNumRejected());
+    block.unlock();
+    pool.Stop();
+    EXPECT_FALSE(pool.Post([]() { }));
+}
+
+TEST(WorkerPoolTest, HighPriorityRunsFirst)
+{
+    std::mutex mutex;
+    std::unique_lock<std::mutex> block(mutex);
+    WorkerPool pool(1, 8);
+    std::atomic<bool> running(false);
+    EXPECT_TRUE(pool.Post([&]() { running = true; std::lock_guard<std::mutex> lock(mutex); }));
+    while (!running)
+    {
+        std::this_thread::yield();
+    }
+    std::vector<int> order;
+    EXPECT_TRUE(pool.Post([&order]() { order.push_back(1); }, WorkerPool::LOW));
+    EXPECT_TRUE(pool.Post([&order]() { order.push_back(2); }, WorkerPool::HIGH));
+    block.unlock();
+    pool.Stop();
+    ASSERT_EQ(2u, order.size());
+    EXPECT_EQ(2, order[0]);
+    EXPECT_EQ(1, order[1]);
+}
+
+TEST(StrandTest, RunsWorkInOrder)
+{
+    WorkerPool pool(4, 256);
+    Strand strand(&pool, 16);
+    std::atomic<size_t> numRunning(0);
+    std::atomic<size_t> maxRunning(0);
+    std::vector<int> order;
+    for (int i = 0; i < 128; ++i)
+    {
+        while (!strand.Post([&, i]() {
+                    size_t n = ++numRunning;
+                    if (n > maxRunning)
+                    {
+                        maxRunning = n;
+                    }
+                    order.push_back(i);
+                    --numRunning;
+                }))
+        {
+            std::this_thread::yield();
+        }
+    }
+    pool.Stop();
+    EXPECT_EQ(1u, (size_t) maxRunning);
+    ASSERT_EQ(128u, order.size());
+    for (int i = 0; i < 128; ++i)
+    {
+        EXPECT_EQ(i, order[i]);
+    }
+}
+
+TEST(StrandTest, DestroyDiscardsQueuedWork)
+{
+    WorkerPool pool(2, 8);
+    std::atomic<bool> running(false);
+    std::atomic<bool> release(false);
+    std::atomic<size_t> n(0);
+    std::atomic<size_t> discarded(0);
+    Strand *strand = new Strand(&pool, 8);
+    EXPECT_TRUE(strand->Post([&]() {
+                running = true;
+                while (!release)
+                {
+                    std::this_thread::yield();
+                }
+                ++n;
+            }));
+    EXPECT_TRUE(strand->Post([&n]() { ++n; }, [&discarded]() { ++discarded; }));
+    while (!running)
+    {
+        std::this_thread::yield();
+    }
+    std::thread releaser([&release]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        release = true;
+    });
+    delete strand;
+    releaser.join();
+    EXPECT_EQ(1u, (size_t) n);
+    EXPECT_EQ(1u, (size_t) discarded);
+    pool.Stop();
+}
+
+TEST(StrandTest, RejectsWhenFull)
+{
+    std::mutex mutex;
+    std::unique_lock<std::mutex> block(mutex);
+    WorkerPool pool(1, 8);
+    Strand strand(&pool, 2);
+    std::atomic<bool> running(false);
+    EXPECT_TRUE(strand.Post([&]() { running = true; std::lock_guard<std::mutex> lock(mutex); }));
+    while (!running)
+    {
+        std::this_thread::yield();
+    }
+    EXPECT_TRUE(strand.Post([]() { }));
+    EXPECT_TRUE(strand.Post([]() { }));
+    EXPECT_FALSE(strand.Post([]() { }));
+    /* The pool itself is not full */
+    EXPECT_EQ(0u, pool.GetQueueDepth());
+    block.unlock();
+    pool.Stop();
+}
+
+TEST(StrandTest, YieldsToOtherWork)
+{
+    std::mutex mutex;
+    std::unique_lock<std::mutex> block(mutex);
+    WorkerPool pool(1, 8);
+    Strand strand(&pool, 16);
+    std::atomic<bool> running(false);
+    EXPECT_TRUE(strand.Post([&]() { running = true; std::lock_guard<std::mutex> lock(mutex); }));
+    while (!running)
+    {
+        std::this_thread::yield();
+    }
+    std::vector<int> order;
+    for (int i = 1; i <= (int) Strand::MAX_BATCH + 1; ++i)
+    {
+        EXPECT_TRUE(strand.Post([&order, i]() { order.push_back(i); }));
+    }
+    EXPECT_TRUE(pool.Post([&order]() { order.push_back(0); }));
+    block.unlock();
+    pool.Stop();
+    ASSERT_EQ(Strand::MAX_BATCH + 2, order.size());
+    /* The work posted directly to the pool runs once the strand's first batch is done */
+    EXPECT_EQ(0, order[Strand::MAX_BATCH - 1]);
+}